@@ -0,0 +1,412 @@
+// the microbenchmarks of the hot paths, the JSON report is compared between the releases:
+// ./manapihttp_bench --benchmark_format=json --benchmark_out=bench.json
+
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+
+#include "ManapiJson.hpp"
+#include "ManapiJsonMask.hpp"
+#include "ManapiJsonBuilder.hpp"
+#include "ManapiJsonTape.hpp"
+#include "ManapiBigint.hpp"
+#include "ManapiBase64.hpp"
+#include "ManapiHash.hpp"
+#include "ManapiCompress.hpp"
+#include "ManapiUtils.hpp"
+#include "ManapiSite.hpp"
+#include "ManapiHttpConfig.hpp"
+#include "ManapiTaskHttp.hpp"
+
+using namespace manapi::net;
+
+namespace manapi::net {
+    // the parser of the task without the socket
+    struct http_task_bench {
+        explicit http_task_bench (class site *site, class config *config) :
+            task (-1, sockaddr {}, sizeof (sockaddr), site, config, CONN_TCP) {}
+
+        request_data_t &parse (std::string &head)
+        {
+            task.request_data = request_data_t {};
+
+            size_t i = 0;
+
+            task.tcp_parse_request_response(head.data(), head.size(), i);
+
+            return task.request_data;
+        }
+
+        http_task task;
+    };
+}
+
+static std::string bench_document (const size_t &items)
+{
+    std::string document = R"({"status": "ok", "items": [)";
+
+    for (size_t i = 0; i < items; i++)
+    {
+        if (i > 0)
+        {
+            document += ',';
+        }
+
+        document += std::format(R"({{"id": {}, "name": "item \"{}\"", "price": {}.25, "tags": ["a", "b", "c"], "active": true, "parent": null}})", i, i, i * 3);
+    }
+
+    document += "]}";
+
+    return document;
+}
+
+static std::string bench_text (const size_t &size)
+{
+    std::string text;
+
+    text.reserve(size);
+
+    // the compressible text with the escaped chars
+    for (size_t i = 0; text.size() < size; i++)
+    {
+        text += std::format("<p class=\"line\">the line {} of the page\t\"quoted\"</p>\n", i % 97);
+    }
+
+    text.resize(size);
+
+    return text;
+}
+
+static std::string bench_head ()
+{
+    return "GET /api/v1/users/42/profile?fields=name,email&lang=en HTTP/1.1\r\n"
+           "Host: localhost:8888\r\n"
+           "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+           "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+           "Accept-Language: en-US,en;q=0.5\r\n"
+           "Accept-Encoding: gzip, deflate, br\r\n"
+           "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark\r\n"
+           "Connection: keep-alive\r\n"
+           "\r\n";
+}
+
+// =================[json                   ]================= //
+
+static void BM_json_parse (benchmark::State &state)
+{
+    const std::string document = bench_document(state.range(0));
+
+    for (auto _: state)
+    {
+        manapi::json result (document, true);
+
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * document.size()));
+}
+BENCHMARK(BM_json_parse)->Arg(1)->Arg(100)->Arg(1000);
+
+static void BM_json_tape_parse (benchmark::State &state)
+{
+    const std::string document = bench_document(state.range(0));
+    manapi::json_tape tape;
+
+    for (auto _: state)
+    {
+        // the memory of the tape is reused
+        tape.parse(document);
+
+        benchmark::DoNotOptimize(tape.root().get_index());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * document.size()));
+}
+BENCHMARK(BM_json_tape_parse)->Arg(1)->Arg(100)->Arg(1000);
+
+static void BM_json_dump (benchmark::State &state)
+{
+    const manapi::json document (bench_document(state.range(0)), true);
+    size_t size = 0;
+
+    for (auto _: state)
+    {
+        const auto result = document.dump();
+
+        size = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+BENCHMARK(BM_json_dump)->Arg(1)->Arg(100)->Arg(1000);
+
+static void BM_json_dump_to (benchmark::State &state)
+{
+    const manapi::json document (bench_document(state.range(0)), true);
+    std::string buffer;
+
+    for (auto _: state)
+    {
+        // the capacity of the buffer is reused
+        buffer.clear();
+        document.dump_to(buffer);
+
+        benchmark::DoNotOptimize(buffer.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_json_dump_to)->Arg(1)->Arg(100)->Arg(1000);
+
+static void BM_json_builder (benchmark::State &state)
+{
+    const std::string document = bench_document(100);
+    // the size of the blocks from the socket
+    const auto block = static_cast<size_t>(state.range(0));
+
+    for (auto _: state)
+    {
+        manapi::json_builder builder;
+
+        for (size_t i = 0; i < document.size(); i += block)
+        {
+            builder << std::string_view (document).substr(i, block);
+        }
+
+        benchmark::DoNotOptimize(builder.get());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * document.size()));
+}
+BENCHMARK(BM_json_builder)->Arg(64)->Arg(1350)->Arg(1 << 20);
+
+static void BM_json_mask_valid (benchmark::State &state)
+{
+    const manapi::json_mask mask = {
+        {"name", "{string(>=3 <=64)}"},
+        {"email", "{string(>=5 <=128)}"},
+        {"age", "{number(>=0 <=150)}"}
+    };
+
+    const manapi::json document (R"({"name": "manapi", "email": "manapi@example.com", "age": 21})", true);
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(mask.valid(document));
+    }
+}
+BENCHMARK(BM_json_mask_valid);
+
+static void BM_json_mask_valid_tape (benchmark::State &state)
+{
+    const manapi::json_mask mask = {
+        {"name", "{string(>=3 <=64)}"},
+        {"email", "{string(>=5 <=128)}"},
+        {"age", "{number(>=0 <=150)}"}
+    };
+
+    const manapi::json_tape tape (R"({"name": "manapi", "email": "manapi@example.com", "age": 21})");
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(mask.valid(tape.root()));
+    }
+}
+BENCHMARK(BM_json_mask_valid_tape);
+
+static void BM_json_mask_valid_form (benchmark::State &state)
+{
+    const manapi::json_mask mask = {
+        {"name", "{string(>=3 <=64)}"},
+        {"email", "{string(>=5 <=128)}"}
+    };
+
+    const std::map<std::string, std::string> form = {
+        {"name", "manapi"},
+        {"email", "manapi@example.com"}
+    };
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(mask.valid(form));
+    }
+}
+BENCHMARK(BM_json_mask_valid_form);
+
+// =================[bigint                 ]================= //
+
+static void BM_bigint_add (benchmark::State &state)
+{
+    const manapi::bigint a (std::string ("123456789012345678901234567890.123456789"));
+    const manapi::bigint b (std::string ("987654321098765432109876543210.987654321"));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(a + b);
+    }
+}
+BENCHMARK(BM_bigint_add);
+
+static void BM_bigint_multiply (benchmark::State &state)
+{
+    manapi::bigint a (std::string ("123456789012345678901234567890.123456789"));
+    const manapi::bigint b (std::string ("987654321098765432109876543210.987654321"));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(a * b);
+    }
+}
+BENCHMARK(BM_bigint_multiply);
+
+static void BM_bigint_divide (benchmark::State &state)
+{
+    const manapi::bigint a (std::string ("123456789012345678901234567890.123456789"));
+    const manapi::bigint b (std::string ("987654321.987654321"));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(a / b);
+    }
+}
+BENCHMARK(BM_bigint_divide);
+
+static void BM_bigint_stringify (benchmark::State &state)
+{
+    const manapi::bigint a (std::string ("123456789012345678901234567890.123456789"));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(a.stringify());
+    }
+}
+BENCHMARK(BM_bigint_stringify);
+
+// =================[http                   ]================= //
+
+static void BM_site_get_handler (benchmark::State &state)
+{
+    site site;
+    config config (manapi::json::object());
+    http_task_bench bench (&site, &config);
+
+    const auto routes = static_cast<size_t>(state.range(0));
+
+    for (size_t i = 0; i < routes; i++)
+    {
+        site.set_handler("GET", std::format("/api/v1/resource{}/[id]", i), [] (http_request &, http_response &) -> void {});
+        site.set_handler("POST", std::format("/api/v1/resource{}", i), [] (http_request &, http_response &) -> void {});
+    }
+
+    // the last page of the tree
+    std::string head = std::format("GET /api/v1/resource{}/42 HTTP/1.1\r\nHost: localhost\r\n\r\n", routes - 1);
+
+    auto &request_data = bench.parse(head);
+
+    for (auto _: state)
+    {
+        const auto page = site.get_handler(request_data);
+
+        benchmark::DoNotOptimize(page.handler);
+    }
+}
+BENCHMARK(BM_site_get_handler)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_tcp_parse_request_response (benchmark::State &state)
+{
+    site site;
+    config config (manapi::json::object());
+    http_task_bench bench (&site, &config);
+
+    std::string head = bench_head();
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(bench.parse(head));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * head.size()));
+}
+BENCHMARK(BM_tcp_parse_request_response);
+
+// =================[utils                  ]================= //
+
+static void BM_escape_string (benchmark::State &state)
+{
+    const std::string text = bench_text(state.range(0));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(utils::escape_string(text));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_escape_string)->Arg(64)->Arg(4096)->Arg(65536);
+
+static void BM_sha256 (benchmark::State &state)
+{
+    const std::string text = bench_text(state.range(0));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(hash::sha256(text));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_sha256)->Arg(64)->Arg(4096)->Arg(65536);
+
+static void BM_base64_encode (benchmark::State &state)
+{
+    const std::string text = bench_text(state.range(0));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(encrypt::base64::to_base64(text));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_base64_encode)->Arg(64)->Arg(4096)->Arg(65536);
+
+static void BM_base64_decode (benchmark::State &state)
+{
+    const std::string encoded = encrypt::base64::to_base64(bench_text(state.range(0)));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(encrypt::base64::from_base64(encoded));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * encoded.size()));
+}
+BENCHMARK(BM_base64_decode)->Arg(64)->Arg(4096)->Arg(65536);
+
+static void BM_deflate (benchmark::State &state)
+{
+    const std::string text = bench_text(state.range(0));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(utils::compress::deflate(text, nullptr));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_deflate)->Arg(1024)->Arg(65536)->Arg(1 << 20);
+
+static void BM_gzip (benchmark::State &state)
+{
+    const std::string text = bench_text(state.range(0));
+
+    for (auto _: state)
+    {
+        benchmark::DoNotOptimize(utils::compress::gzip(text, nullptr));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_gzip)->Arg(1024)->Arg(65536)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
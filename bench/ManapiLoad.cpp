@@ -0,0 +1,980 @@
+// the load of the server in the same process over the loopback:
+// ./manapihttp_load --scenario=all --connections=64 --duration=10 --threads=8 --keep-alive=true --json=false
+// ./manapihttp_load --http=3 --scenario=json --connections=16
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ManapiHttp.hpp"
+#include "ManapiFilesystem.hpp"
+
+using namespace manapi::net;
+
+namespace {
+    struct load_options_t {
+        std::string             scenario        = "all";
+        size_t                  connections     = 64;
+        size_t                  duration        = 10;
+        size_t                  threads         = 8;
+        size_t                  port            = 18888;
+        size_t                  upload_size     = 64 * 1024;
+        size_t                  static_size     = 16 * 1024;
+        // milliseconds, the limit of one request
+        size_t                  timeout         = 5000;
+        // 1.1 or 3
+        std::string             http            = "1.1";
+        bool                    keep_alive      = true;
+        bool                    json            = false;
+    };
+
+    struct load_result_t {
+        std::string             scenario;
+        size_t                  requests        = 0;
+        size_t                  errors          = 0;
+        size_t                  connects        = 0;
+        // the requests on the connections which were already used
+        size_t                  reused          = 0;
+        double                  seconds         = 0;
+        // microseconds, sorted
+        std::vector<uint64_t>   latencies;
+    };
+
+    struct load_request_t {
+        std::string             method;
+        std::string             path;
+        std::string             body;
+    };
+
+    void load_set_timeout (const int &fd, const size_t &timeout)
+    {
+        const timeval tv {
+            .tv_sec     = static_cast<time_t>(timeout / 1000),
+            .tv_usec    = static_cast<suseconds_t>(timeout % 1000 * 1000)
+        };
+
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof (tv));
+    }
+
+    sockaddr_in load_address (const load_options_t &options)
+    {
+        sockaddr_in addr {};
+        addr.sin_family         = AF_INET;
+        addr.sin_port           = htons(static_cast<uint16_t>(options.port));
+        addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+
+        return addr;
+    }
+
+    // one connection of the HTTP/1.1 client
+    class load_client {
+    public:
+        load_client (const load_options_t &options, const load_request_t &req) : options (options)
+        {
+            request = std::format("{} {} HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: {}\r\n", req.method, req.path, options.keep_alive ? "keep-alive" : "close");
+
+            if (!req.body.empty())
+            {
+                request += std::format("Content-Type: application/octet-stream\r\nContent-Length: {}\r\n", req.body.size());
+            }
+
+            request += "\r\n";
+            request += req.body;
+        }
+
+        ~load_client ()
+        {
+            disconnect();
+        }
+
+        // false -> the request is failed, the connection is closed
+        bool send (load_result_t &result)
+        {
+            if (fd >= 0)
+            {
+                result.reused++;
+            }
+            else if (!connect(result))
+            {
+                return false;
+            }
+
+            for (size_t offset = 0; offset < request.size();)
+            {
+                const ssize_t written = ::send(fd, request.data() + offset, request.size() - offset, MSG_NOSIGNAL);
+
+                if (written <= 0)
+                {
+                    disconnect();
+                    return false;
+                }
+
+                offset += written;
+            }
+
+            return receive();
+        }
+
+        bool connect (load_result_t &result)
+        {
+            fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            const int flag = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof (flag));
+
+            // a stuck server fails the request instead of the whole run
+            load_set_timeout(fd, options.timeout);
+
+            const sockaddr_in addr = load_address(options);
+
+            if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof (addr)) < 0)
+            {
+                disconnect();
+                return false;
+            }
+
+            result.connects++;
+
+            return true;
+        }
+    private:
+        void disconnect ()
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+
+        bool receive ()
+        {
+            buffer.clear();
+
+            size_t head_end = std::string::npos;
+
+            while (head_end == std::string::npos)
+            {
+                if (!read_more())
+                {
+                    return false;
+                }
+
+                head_end = buffer.find("\r\n\r\n");
+            }
+
+            // the names of the headers are lowercase
+            const std::string_view head (buffer.data(), head_end);
+
+            if (!head.starts_with("HTTP/1.1 2"))
+            {
+                disconnect();
+                return false;
+            }
+
+            size_t content_length = 0;
+
+            if (const auto pos = head.find("content-length:"); pos != std::string_view::npos)
+            {
+                content_length = std::strtoull(head.data() + pos + sizeof ("content-length:") - 1, nullptr, 10);
+            }
+
+            const bool close_connection = !options.keep_alive || head.find("connection: close") != std::string_view::npos;
+
+            while (buffer.size() < head_end + 4 + content_length)
+            {
+                if (!read_more())
+                {
+                    return false;
+                }
+            }
+
+            if (close_connection)
+            {
+                disconnect();
+            }
+
+            return true;
+        }
+
+        bool read_more ()
+        {
+            char block[16384];
+
+            const ssize_t read = recv(fd, block, sizeof (block), 0);
+
+            if (read <= 0)
+            {
+                disconnect();
+                return false;
+            }
+
+            buffer.append(block, read);
+
+            return true;
+        }
+
+        const load_options_t    &options;
+        std::string             request;
+        std::string             buffer;
+        int                     fd              = -1;
+    };
+
+    // one connection of the HTTP/3 client (quiche), the requests go one by one
+    class load_client_h3 {
+    public:
+        load_client_h3 (const load_options_t &options, const load_request_t &req) : options (options), body (req.body)
+        {
+            config = quiche_config_new(QUICHE_PROTOCOL_VERSION);
+
+            if (config == nullptr)
+            {
+                throw std::runtime_error ("failed to create the quiche config");
+            }
+
+            quiche_config_set_application_protos                    (config, reinterpret_cast<const uint8_t *>("\x02h3"), 3);
+            // the certificate of the harness is self-signed
+            quiche_config_verify_peer                               (config, false);
+            quiche_config_set_max_idle_timeout                      (config, options.timeout);
+            quiche_config_set_max_recv_udp_payload_size             (config, MANAPI_MAX_DATAGRAM_SIZE);
+            quiche_config_set_max_send_udp_payload_size             (config, MANAPI_MAX_DATAGRAM_SIZE);
+            quiche_config_set_initial_max_data                      (config, 16 * 1024 * 1024);
+            quiche_config_set_initial_max_stream_data_bidi_local    (config, 4 * 1024 * 1024);
+            quiche_config_set_initial_max_stream_data_bidi_remote   (config, 4 * 1024 * 1024);
+            quiche_config_set_initial_max_stream_data_uni           (config, 1024 * 1024);
+            quiche_config_set_initial_max_streams_bidi              (config, 128);
+            quiche_config_set_initial_max_streams_uni               (config, 128);
+            quiche_config_set_disable_active_migration              (config, true);
+
+            h3_config = quiche_h3_config_new();
+
+            if (h3_config == nullptr)
+            {
+                quiche_config_free(config);
+
+                throw std::runtime_error ("failed to create the HTTP/3 config");
+            }
+
+            fields = {
+                {":method",     req.method},
+                {":scheme",     "https"},
+                {":authority",  "127.0.0.1"},
+                {":path",       req.path}
+            };
+
+            if (!body.empty())
+            {
+                fields.emplace_back("content-type", "application/octet-stream");
+                fields.emplace_back("content-length", std::to_string(body.size()));
+            }
+
+            // the fields are not changed anymore
+            for (const auto &field: fields)
+            {
+                headers.push_back({
+                    .name       = reinterpret_cast<const uint8_t *>(field.first.data()),
+                    .name_len   = field.first.size(),
+                    .value      = reinterpret_cast<const uint8_t *>(field.second.data()),
+                    .value_len  = field.second.size()
+                });
+            }
+        }
+
+        load_client_h3 (const load_client_h3 &) = delete;
+        load_client_h3 &operator= (const load_client_h3 &) = delete;
+
+        ~load_client_h3 ()
+        {
+            disconnect();
+
+            quiche_h3_config_free(h3_config);
+            quiche_config_free(config);
+        }
+
+        // false -> the request is failed, the connection is closed
+        bool send (load_result_t &result)
+        {
+            if (conn != nullptr && !quiche_conn_is_closed(conn))
+            {
+                result.reused++;
+            }
+            else
+            {
+                disconnect();
+
+                if (!connect(result))
+                {
+                    return false;
+                }
+            }
+
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeout);
+
+            const int64_t stream_id = quiche_h3_send_request(h3, conn, headers.data(), headers.size(), body.empty());
+
+            if (stream_id < 0)
+            {
+                disconnect();
+                return false;
+            }
+
+            size_t  offset      = 0;
+            int     status      = 0;
+            bool    finished    = false;
+
+            while (!finished)
+            {
+                // the rest of the body waits for the flow control
+                if (offset < body.size())
+                {
+                    const ssize_t written = quiche_h3_send_body(h3, conn, stream_id, reinterpret_cast<const uint8_t *>(body.data()) + offset, body.size() - offset, true);
+
+                    if (written > 0)
+                    {
+                        offset += written;
+                    }
+                    else if (written != QUICHE_H3_ERR_DONE)
+                    {
+                        disconnect();
+                        return false;
+                    }
+                }
+
+                if (!flush() || !wait())
+                {
+                    disconnect();
+                    return false;
+                }
+
+                quiche_h3_event *event;
+
+                for (int64_t id; (id = quiche_h3_conn_poll(h3, conn, &event)) >= 0;)
+                {
+                    if (id == stream_id)
+                    {
+                        switch (quiche_h3_event_type(event))
+                        {
+                            case QUICHE_H3_EVENT_HEADERS:
+                                quiche_h3_event_for_each_header(event, [] (uint8_t *name, size_t name_len, uint8_t *value, size_t value_len, void *argp) -> int {
+                                    if (std::string_view (reinterpret_cast<const char *>(name), name_len) == ":status")
+                                    {
+                                        *static_cast<int *>(argp) = std::atoi(std::string (reinterpret_cast<const char *>(value), value_len).data());
+                                    }
+
+                                    return 0;
+                                }, &status);
+                                break;
+                            case QUICHE_H3_EVENT_DATA:
+                                while (quiche_h3_recv_body(h3, conn, stream_id, block, sizeof (block)) > 0) {}
+                                break;
+                            case QUICHE_H3_EVENT_FINISHED:
+                                finished = true;
+                                break;
+                            case QUICHE_H3_EVENT_RESET:
+                                status = 0;
+                                finished = true;
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+
+                    quiche_h3_event_free(event);
+                }
+            }
+
+            // the acknowledgments of the response
+            flush();
+
+            if (status / 100 != 2)
+            {
+                disconnect();
+                return false;
+            }
+
+            if (!options.keep_alive)
+            {
+                disconnect();
+            }
+
+            return true;
+        }
+
+        bool connect (load_result_t &result)
+        {
+            fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            peer                = load_address(options);
+            local_len           = sizeof (local);
+
+            if (::connect(fd, reinterpret_cast<const sockaddr *>(&peer), sizeof (peer)) < 0
+                || getsockname(fd, reinterpret_cast<sockaddr *>(&local), &local_len) < 0)
+            {
+                disconnect();
+                return false;
+            }
+
+            uint8_t scid[MANAPI_QUIC_CONNECTION_ID_LEN];
+            std::random_device random;
+
+            for (auto &byte: scid)
+            {
+                byte = static_cast<uint8_t>(random());
+            }
+
+            conn = quiche_connect("localhost", scid, sizeof (scid), reinterpret_cast<const sockaddr *>(&local), local_len,
+                reinterpret_cast<const sockaddr *>(&peer), sizeof (peer), config);
+
+            if (conn == nullptr)
+            {
+                disconnect();
+                return false;
+            }
+
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeout);
+
+            while (!quiche_conn_is_established(conn))
+            {
+                if (!flush() || !wait())
+                {
+                    disconnect();
+                    return false;
+                }
+            }
+
+            h3 = quiche_h3_conn_new_with_transport(conn, h3_config);
+
+            if (h3 == nullptr)
+            {
+                disconnect();
+                return false;
+            }
+
+            result.connects++;
+
+            return true;
+        }
+    private:
+        void disconnect ()
+        {
+            if (conn != nullptr && !quiche_conn_is_closed(conn))
+            {
+                quiche_conn_close(conn, true, 0, nullptr, 0);
+                flush();
+            }
+
+            if (h3 != nullptr)
+            {
+                quiche_h3_conn_free(h3);
+                h3 = nullptr;
+            }
+
+            if (conn != nullptr)
+            {
+                quiche_conn_free(conn);
+                conn = nullptr;
+            }
+
+            if (fd >= 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+
+        bool flush ()
+        {
+            quiche_send_info info;
+
+            for (;;)
+            {
+                const ssize_t written = quiche_conn_send(conn, block, MANAPI_MAX_DATAGRAM_SIZE, &info);
+
+                if (written == QUICHE_ERR_DONE)
+                {
+                    return true;
+                }
+
+                if (written < 0 || ::send(fd, block, written, 0) != written)
+                {
+                    return false;
+                }
+            }
+        }
+
+        // false -> the connection is closed or the request is out of the time
+        bool wait ()
+        {
+            const auto now = std::chrono::steady_clock::now();
+
+            if (now >= deadline)
+            {
+                return false;
+            }
+
+            const auto left = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+            const auto timeout = std::min(quiche_conn_timeout_as_millis(conn), left);
+
+            pollfd event {.fd = fd, .events = POLLIN, .revents = 0};
+
+            const int ready = poll(&event, 1, static_cast<int>(timeout));
+
+            if (ready < 0)
+            {
+                return false;
+            }
+
+            if (ready == 0)
+            {
+                quiche_conn_on_timeout(conn);
+
+                return !quiche_conn_is_closed(conn);
+            }
+
+            for (;;)
+            {
+                const ssize_t read = recv(fd, block, sizeof (block), MSG_DONTWAIT);
+
+                if (read < 0)
+                {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    {
+                        break;
+                    }
+
+                    return false;
+                }
+
+                const quiche_recv_info info {
+                    .from       = reinterpret_cast<sockaddr *>(&peer),
+                    .from_len   = sizeof (peer),
+                    .to         = reinterpret_cast<sockaddr *>(&local),
+                    .to_len     = local_len
+                };
+
+                // the broken packets are dropped by quiche
+                quiche_conn_recv(conn, block, read, &info);
+            }
+
+            return !quiche_conn_is_closed(conn);
+        }
+
+        const load_options_t    &options;
+        const std::string       body;
+
+        std::vector<std::pair<std::string, std::string>>
+                                fields;
+        std::vector<quiche_h3_header>
+                                headers;
+
+        quiche_config           *config         = nullptr;
+        quiche_h3_config        *h3_config      = nullptr;
+        quiche_conn             *conn           = nullptr;
+        quiche_h3_conn          *h3             = nullptr;
+
+        sockaddr_in             peer {};
+        sockaddr_storage        local {};
+        socklen_t               local_len       = 0;
+        int                     fd              = -1;
+
+        std::chrono::steady_clock::time_point
+                                deadline;
+
+        uint8_t                 block[65536];
+    };
+
+    load_request_t load_request (const load_options_t &options, const std::string &scenario)
+    {
+        if (scenario == "json")
+        {
+            return {"GET", "/json", {}};
+        }
+
+        if (scenario == "static")
+        {
+            return {"GET", "/static/page.html", {}};
+        }
+
+        if (scenario == "upload")
+        {
+            return {"POST", "/upload", std::string (options.upload_size, 'x')};
+        }
+
+        throw std::invalid_argument (std::format("unknown scenario: {}", scenario));
+    }
+
+    template <typename client_t>
+    load_result_t load_run (const load_options_t &options, const std::string &scenario)
+    {
+        const load_request_t request = load_request(options, scenario);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(options.duration);
+
+        std::vector<load_result_t> results (options.connections);
+        std::vector<std::thread> workers;
+
+        const auto started = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < options.connections; i++)
+        {
+            workers.emplace_back([&options, &request, &deadline, &result = results[i]] () -> void {
+                client_t client (options, request);
+
+                // the refused connections are retried with the growing delay
+                std::chrono::milliseconds backoff (0);
+
+                while (std::chrono::steady_clock::now() < deadline)
+                {
+                    const auto begin = std::chrono::steady_clock::now();
+
+                    if (!client.send(result))
+                    {
+                        result.errors++;
+
+                        backoff = std::clamp(backoff * 2, std::chrono::milliseconds(1), std::chrono::milliseconds(100));
+                        std::this_thread::sleep_for(backoff);
+
+                        continue;
+                    }
+
+                    backoff = std::chrono::milliseconds(0);
+
+                    result.requests++;
+                    result.latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+                }
+            });
+        }
+
+        for (auto &worker: workers)
+        {
+            worker.join();
+        }
+
+        load_result_t total;
+
+        total.scenario  = scenario;
+        total.seconds   = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        for (auto &result: results)
+        {
+            total.requests  += result.requests;
+            total.errors    += result.errors;
+            total.connects  += result.connects;
+            total.reused    += result.reused;
+
+            total.latencies.insert(total.latencies.end(), result.latencies.begin(), result.latencies.end());
+        }
+
+        std::ranges::sort(total.latencies);
+
+        return total;
+    }
+
+    uint64_t load_percentile (const load_result_t &result, const double &percentile)
+    {
+        if (result.latencies.empty())
+        {
+            return 0;
+        }
+
+        const auto index = static_cast<size_t>(percentile * static_cast<double>(result.latencies.size() - 1));
+
+        return result.latencies[index];
+    }
+
+    void load_print (const load_options_t &options, const load_result_t &result)
+    {
+        const double rps = result.seconds > 0 ? static_cast<double>(result.requests) / result.seconds : 0;
+
+        if (options.json)
+        {
+            std::cout << std::format(R"({{"scenario":"{}","http":"{}","connections":{},"keep_alive":{},"requests":{},"errors":{},"connects":{},"reused":{},"rps":{:.1f},"p50_us":{},"p99_us":{},"p999_us":{},"max_us":{}}})",
+                result.scenario, options.http, options.connections, options.keep_alive, result.requests, result.errors, result.connects, result.reused, rps,
+                load_percentile(result, 0.5), load_percentile(result, 0.99), load_percentile(result, 0.999),
+                result.latencies.empty() ? 0 : result.latencies.back()) << std::endl;
+
+            return;
+        }
+
+        std::cout << std::format("{:<8} {:>10} req {:>8} err {:>10} conn {:>10} reused {:>12.1f} rps   p50 {:>8} us   p99 {:>8} us   p999 {:>8} us   max {:>8} us",
+            result.scenario, result.requests, result.errors, result.connects, result.reused, rps,
+            load_percentile(result, 0.5), load_percentile(result, 0.99), load_percentile(result, 0.999),
+            result.latencies.empty() ? 0 : result.latencies.back()) << std::endl;
+    }
+
+    load_options_t load_parse_options (const int &argc, char *argv[])
+    {
+        load_options_t options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string_view arg (argv[i]);
+            const auto eq = arg.find('=');
+
+            if (!arg.starts_with("--") || eq == std::string_view::npos)
+            {
+                throw std::invalid_argument (std::format("invalid argument: {}", arg));
+            }
+
+            const auto key      = arg.substr(2, eq - 2);
+            const std::string value (arg.substr(eq + 1));
+
+            if (key == "scenario")
+            {
+                options.scenario = value;
+            }
+            else if (key == "connections")
+            {
+                options.connections = std::stoull(value);
+            }
+            else if (key == "duration")
+            {
+                options.duration = std::stoull(value);
+            }
+            else if (key == "threads")
+            {
+                options.threads = std::stoull(value);
+            }
+            else if (key == "port")
+            {
+                options.port = std::stoull(value);
+            }
+            else if (key == "upload-size")
+            {
+                options.upload_size = std::stoull(value);
+            }
+            else if (key == "static-size")
+            {
+                options.static_size = std::stoull(value);
+            }
+            else if (key == "timeout")
+            {
+                options.timeout = std::stoull(value);
+            }
+            else if (key == "http")
+            {
+                if (value != "1.1" && value != "3")
+                {
+                    throw std::invalid_argument (std::format("unknown http version: {}", value));
+                }
+
+                options.http = value;
+            }
+            else if (key == "keep-alive")
+            {
+                options.keep_alive = value == "true" || value == "1";
+            }
+            else if (key == "json")
+            {
+                options.json = value == "true" || value == "1";
+            }
+            else
+            {
+                throw std::invalid_argument (std::format("unknown argument: {}", key));
+            }
+        }
+
+        return options;
+    }
+
+    template <typename client_t>
+    bool load_wait_listening (const load_options_t &options)
+    {
+        load_result_t result;
+
+        // the pools are started by the threads of the server
+        for (size_t attempt = 0; attempt < 100; attempt++)
+        {
+            client_t client (options, load_request(options, "json"));
+
+            if (client.connect(result))
+            {
+                return true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        return false;
+    }
+
+    // the self-signed certificate of the HTTP/3 pool
+    bool load_write_certificate (const std::string &key_path, const std::string &cert_path)
+    {
+        EVP_PKEY *key = EVP_EC_gen("P-256");
+        X509 *cert = X509_new();
+
+        bool done = key != nullptr && cert != nullptr
+            && ASN1_INTEGER_set(X509_get_serialNumber(cert), 1)
+            && X509_gmtime_adj(X509_getm_notBefore(cert), 0) != nullptr
+            && X509_gmtime_adj(X509_getm_notAfter(cert), 86400) != nullptr
+            && X509_set_pubkey(cert, key)
+            && X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0)
+            && X509_set_issuer_name(cert, X509_get_subject_name(cert))
+            && X509_sign(cert, key, EVP_sha256()) > 0;
+
+        if (done)
+        {
+            BIO *key_file = BIO_new_file(key_path.data(), "w");
+            BIO *cert_file = BIO_new_file(cert_path.data(), "w");
+
+            done = key_file != nullptr && cert_file != nullptr
+                && PEM_write_bio_PrivateKey(key_file, key, nullptr, nullptr, 0, nullptr, nullptr)
+                && PEM_write_bio_X509(cert_file, cert);
+
+            BIO_free(key_file);
+            BIO_free(cert_file);
+        }
+
+        X509_free(cert);
+        EVP_PKEY_free(key);
+
+        return done;
+    }
+
+    void load_keep_alive_check (const load_options_t &options, const load_result_t &result)
+    {
+        if (options.keep_alive && result.requests > 0 && result.reused == 0)
+        {
+            std::cerr << std::format("{}: keep-alive is requested, but the server closed every connection (the numbers are without keep-alive)", result.scenario) << std::endl;
+        }
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    load_options_t options;
+
+    try {
+        options = load_parse_options(argc, argv);
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    const std::string folder = "/tmp/manapi_load/";
+
+    filesystem::mkdir(folder + "static");
+
+    {
+        std::ofstream page (folder + "static/page.html", std::ios::binary | std::ios::trunc);
+
+        page << std::string (options.static_size, 'a');
+    }
+
+    const bool h3 = options.http == "3";
+
+    manapi::json pool = {
+        {"address", "127.0.0.1"},
+        {"port", std::to_string(options.port)},
+        {"http_version", options.http},
+        {"http_implement", h3 ? "quic" : "tls"}
+    };
+
+    if (h3)
+    {
+        if (!load_write_certificate(folder + "key.pem", folder + "cert.pem"))
+        {
+            std::cerr << "failed to create the certificate" << std::endl;
+            return 1;
+        }
+
+        pool["ssl"] = {
+            {"enabled", true},
+            {"key", folder + "key.pem"},
+            {"cert", folder + "cert.pem"}
+        };
+    }
+
+    http server;
+
+    server.set_config_object({
+        {"pools", manapi::json::array({pool})},
+        {"save_config", false},
+        {"cache_dir", folder + "cache/"}
+    });
+
+    server.GET("/json", [] (http_request &, RESP(resp)) -> void {
+        resp.json({
+            {"status", "ok"},
+            {"id", 42}
+        });
+    });
+
+    server.GET("/static", folder + "static");
+
+    server.POST("/upload", [] (REQ(req), RESP(resp)) -> void {
+        auto stream = req.body_stream();
+        size_t size = 0;
+
+        for (auto part = stream.next(); !part.empty(); part = stream.next())
+        {
+            size += part.size();
+        }
+
+        resp.text(std::to_string(size));
+    });
+
+    auto running = server.pool(options.threads);
+
+    if (!(h3 ? load_wait_listening<load_client_h3>(options) : load_wait_listening<load_client>(options)))
+    {
+        std::cerr << "the server is not listening on " << options.port << std::endl;
+
+        server.stop(true);
+        return 1;
+    }
+
+    const std::vector<std::string> scenarios = options.scenario == "all" ? std::vector<std::string> {"json", "static", "upload"} : std::vector<std::string> {options.scenario};
+
+    int status = 0;
+
+    for (const auto &scenario: scenarios)
+    {
+        try {
+            const auto result = h3 ? load_run<load_client_h3>(options, scenario) : load_run<load_client>(options, scenario);
+
+            load_print(options, result);
+            load_keep_alive_check(options, result);
+        }
+        catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            status = 1;
+        }
+    }
+
+    server.stop(true);
+    running.get();
+
+    return status;
+}
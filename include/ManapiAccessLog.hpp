@@ -0,0 +1,114 @@
+#ifndef MANAPIACCESSLOG_HPP
+#define MANAPIACCESSLOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace manapi::net {
+    struct access_log_config_t {
+        bool                        enabled         = false;
+        std::string                 file            = "/tmp/manapi-access.log";
+        // common -> Common Log Format, json -> one object per line with all fields
+        std::string                 format          = "common";
+        // the file is rotated after the size (bytes), 0 -> never
+        size_t                      max_size        = 64 * 1024 * 1024;
+        // the rotated files file.1 ... file.N
+        size_t                      max_files       = 5;
+        // every N-th request of the thread is written, 1 -> all
+        size_t                      sample          = 1;
+        // ms between the batches
+        size_t                      flush           = 1000;
+        // the records of one shard between the batches (bytes), the next ones are dropped
+        size_t                      max_buffer      = 4 * 1024 * 1024;
+    };
+
+    struct access_log_record_t {
+        std::chrono::system_clock::time_point
+                                    time;
+        std::chrono::microseconds   duration;
+        std::string_view            ip;
+        uint16_t                    port;
+        std::string_view            method;
+        std::string_view            uri;
+        std::string_view            protocol;
+        // the content-encoding of the response, empty -> not compressed
+        std::string_view            compress;
+        size_t                      status;
+        size_t                      bytes;
+    };
+
+    /**
+     * the records are packed into the buffer of the shard of the thread (without the syscalls),
+     * the writer thread formats the batches and writes them to the file
+     */
+    class access_log {
+    public:
+        explicit access_log (access_log_config_t config);
+        ~access_log ();
+
+        // false -> the request is skipped by the sampling
+        [[nodiscard]] bool          sampled () const;
+        void                        append (const access_log_record_t &record);
+
+        // writes the buffers and stops the writer
+        void                        stop ();
+
+        [[nodiscard]] const access_log_config_t &get_config () const;
+        [[nodiscard]] size_t        get_dropped () const;
+    private:
+        // the fixed part of the packed record, the strings follow it
+        struct header_t {
+            int64_t                 time;
+            uint64_t                duration;
+            uint64_t                bytes;
+            uint32_t                status;
+            uint16_t                port;
+            uint16_t                ip_size;
+            uint16_t                method_size;
+            uint16_t                protocol_size;
+            uint16_t                compress_size;
+            uint32_t                uri_size;
+        };
+
+        struct buffer_t {
+            std::mutex              mutex;
+            std::string             data;
+        };
+
+        buffer_t                    &thread_buffer ();
+        void                        run ();
+        void                        write_batch ();
+        void                        format_record (std::string &out, const header_t &header, const char *strings) const;
+        void                        write_file (const std::string &data);
+        void                        open_file ();
+        void                        rotate ();
+
+        access_log_config_t         config;
+        bool                        json;
+        // the threads come and go (HTTP/2 connections), so the buffers are the fixed shards,
+        // the thread gets the shard by its number
+        std::vector<std::unique_ptr<buffer_t> >
+                                    buffers;
+
+        std::mutex                  m_writer;
+        std::condition_variable     cv_writer;
+        bool                        stopping        = false;
+        std::thread                 writer;
+
+        // used only by the writer
+        std::string                 batch;
+        int                         fd              = -1;
+        size_t                      file_size       = 0;
+
+        std::atomic<size_t>         dropped         = 0;
+    };
+}
+
+#endif //MANAPIACCESSLOG_HPP
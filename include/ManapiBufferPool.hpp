@@ -0,0 +1,47 @@
+#ifndef MANAPIBUFFERPOOL_HPP
+#define MANAPIBUFFERPOOL_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace manapi::net::utils {
+    struct buffer_pool_stats_t {
+        size_t                      capacity;
+        // the buffers from the slabs
+        size_t                      hits;
+        // the slabs are exhausted -> the heap
+        size_t                      misses;
+    };
+
+    /**
+     * the lock-free pool of the fixed-size I/O buffers of the tasks,
+     * the buffers are in one region, the free list is a tagged stack
+     */
+    class buffer_pool {
+    public:
+        buffer_pool (const size_t &block_size, const size_t &count);
+        ~buffer_pool ();
+
+        uint8_t                     *acquire ();
+        void                        release (uint8_t *buffer);
+
+        [[nodiscard]] const size_t  &get_block_size () const;
+        [[nodiscard]] buffer_pool_stats_t get_stats () const;
+    private:
+        size_t                      block_size;
+        size_t                      count;
+
+        std::unique_ptr<uint8_t[]>  region;
+        // the index of the next free slab + 1, 0 -> end
+        std::unique_ptr<std::atomic<uint32_t>[]>
+                                    next;
+        // [tag:32][index + 1:32], the tag protects from ABA
+        std::atomic<uint64_t>       head;
+
+        std::atomic<size_t>         hits        = 0;
+        std::atomic<size_t>         misses      = 0;
+    };
+}
+
+#endif //MANAPIBUFFERPOOL_HPP
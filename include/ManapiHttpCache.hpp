@@ -0,0 +1,98 @@
+#ifndef MANAPIHTTPCACHE_HPP
+#define MANAPIHTTPCACHE_HPP
+
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ManapiUtils.hpp"
+
+namespace manapi::net {
+    struct http_cache_config_t {
+        // the entry is fresh
+        std::chrono::milliseconds               ttl         = std::chrono::seconds (60);
+        // after the ttl the entry is served while one request refreshes it
+        std::chrono::milliseconds               stale       = std::chrono::milliseconds (0);
+        // the requests wait for the leader which builds the entry, after -> the handler
+        std::chrono::milliseconds               wait        = std::chrono::seconds (5);
+        // the requests which wait at once (they hold the workers), the others -> the handler
+        size_t                                  max_waiters = 4;
+        // the bodies in the cache (bytes)
+        size_t                                  max_size    = 16 * 1024 * 1024;
+        // the headers of the request in the key
+        std::vector <std::string>               vary;
+        // the query params in the key, empty -> the whole query
+        std::vector <std::string>               vary_query;
+    };
+
+    struct http_cache_entry_t {
+        size_t                                  status;
+        std::string                             message;
+        // without the date, connection and content-length
+        utils::MAP_STR_STR                      headers;
+        // compressed if the handler enabled the compression
+        std::string                             body;
+
+        std::chrono::steady_clock::time_point   expires;
+        std::chrono::steady_clock::time_point   stale_until;
+    };
+
+    enum http_cache_result_t {
+        // the entry can be sent
+        CACHE_HIT,
+        // the caller runs the handler and must store () or abandon ()
+        CACHE_LEAD,
+        // the leader is too slow, the caller runs the handler
+        CACHE_BYPASS
+    };
+
+    /**
+     * the responses of one route by the key (method + path + selected headers/query),
+     * only one request builds the expired entry (single-flight)
+     */
+    class http_response_cache {
+    public:
+        explicit http_response_cache (http_cache_config_t config);
+
+        // the encoding is the one the response is compressed with (empty -> identity)
+        [[nodiscard]] std::string               key (const request_data_t &request_data, std::string_view encoding) const;
+
+        http_cache_result_t                     acquire (const std::string &key, std::shared_ptr<const http_cache_entry_t> &entry);
+        void                                    store (const std::string &key, http_cache_entry_t entry);
+        void                                    abandon (const std::string &key);
+
+        [[nodiscard]] const http_cache_config_t &get_config () const;
+    private:
+        struct item_t {
+            std::shared_ptr<const http_cache_entry_t>
+                                                entry;
+            std::list <std::string>::iterator   lru;
+            bool                                refreshing  = false;
+        };
+
+        void                                    erase (std::unordered_map <std::string, item_t>::iterator it);
+
+        http_cache_config_t                     config;
+
+        std::mutex                              mutex;
+        std::condition_variable                 cv;
+
+        std::unordered_map <std::string, item_t> items;
+        // the front is the last used
+        std::list <std::string>                 lru;
+        // the keys without the entry which are being built
+        std::unordered_set <std::string>        building;
+
+        size_t                                  size        = 0;
+        // the requests in acquire () which wait for the leaders
+        size_t                                  waiters     = 0;
+    };
+}
+
+#endif //MANAPIHTTPCACHE_HPP
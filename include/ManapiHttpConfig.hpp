@@ -3,19 +3,57 @@
 
 #include <string>
 #include <functional>
+#include <atomic>
+#include <memory>
 
 #include <quiche.h>
 #include <openssl/ssl.h>
 
 #include "ManapiJson.hpp"
+#include "ManapiBufferPool.hpp"
+#include "ManapiRateLimit.hpp"
+#include "ManapiAccessLog.hpp"
+#include "ManapiTrace.hpp"
+
+// the socket block of the TLS pools (one TLS record)
+#define MANAPI_HTTP_TCP_BLOCK_SIZE  16384
+// the adaptive first read of the request head starts from here
+#define MANAPI_HTTP_TCP_READ_MIN    512
 
 namespace manapi::net {
     constexpr static size_t quic_token_max_len = sizeof ("quiche") - 1 + sizeof (struct sockaddr_storage) + QUICHE_MAX_CONN_ID_LEN;
 
+    struct ocsp_config_t {
+        bool            enabled         = false;
+        // the DER response prepared by an external tool, if empty -> the responder from the cert
+        std::string     file;
+        // seconds between the background refreshes
+        size_t          refresh         = 3600;
+    };
+
     struct ssl_config_t {
         bool            enabled = false;
         std::string     key;
         std::string     cert;
+        // the server-side session cache, 0 -> disabled
+        size_t          session_cache   = 20480;
+        size_t          session_timeout = 7200;
+        bool            session_tickets = true;
+        // seconds between the rotations of the ticket keys
+        size_t          ticket_rotation = 3600;
+        // max size of 0-RTT data, 0 -> disabled
+        size_t          early_data      = 0;
+        // the handshakes are offloaded to the crypto threads, 0 -> the handshakes in the loop
+        size_t          crypto_threads  = 2;
+        // the handshakes over the limit are dropped
+        size_t          crypto_queue    = 1024;
+        ocsp_config_t   ocsp;
+    };
+
+    struct quic_dgram_config_t {
+        bool            enabled         = false;
+        size_t          recv_queue_len  = 1024;
+        size_t          send_queue_len  = 1024;
     };
 
     namespace versions {
@@ -54,6 +92,35 @@ namespace manapi::net {
         void set_socket_block_size (const size_t &s);
         [[nodiscard]] const size_t& get_socket_block_size () const;
 
+        [[nodiscard]] const size_t& get_buffer_pool_size () const;
+        // the I/O buffers of the tasks of the pool
+        void set_buffer_pool (const std::shared_ptr<utils::buffer_pool> &pool);
+        [[nodiscard]] std::shared_ptr<utils::buffer_pool> get_buffer_pool () const;
+
+        // CoDel target of the sojourn time of the tasks (ms), 0 -> the admission control is disabled
+        [[nodiscard]] const size_t& get_admission_target () const;
+        [[nodiscard]] const size_t& get_admission_interval () const;
+
+        [[nodiscard]] const rate_limit_config_t &get_rate_limit_config () const;
+        // the token buckets of the clients of the pool
+        void set_rate_limiter (const std::shared_ptr<rate_limiter> &limiter);
+        [[nodiscard]] std::shared_ptr<rate_limiter> get_rate_limiter () const;
+
+        [[nodiscard]] const access_log_config_t &get_access_log_config () const;
+        // the access log of the pool, nullptr -> disabled
+        void set_access_log (const std::shared_ptr<access_log> &log);
+        [[nodiscard]] std::shared_ptr<access_log> get_access_log () const;
+
+        [[nodiscard]] const trace_config_t &get_trace_config () const;
+        // the phases of the requests (MANAPI_HTTP_TRACING), nullptr -> disabled
+        void set_tracer (const std::shared_ptr<tracer> &tracer);
+        [[nodiscard]] std::shared_ptr<tracer> get_tracer () const;
+
+        // the adaptive size of the reads of the request head (TCP)
+        [[nodiscard]] size_t get_tcp_read_size () const;
+        [[nodiscard]] const size_t& get_tcp_read_max () const;
+        void observe_tcp_head_size (const size_t &size);
+
         void set_max_header_block_size (const size_t &s);
         [[nodiscard]] const size_t& get_max_header_block_size () const;
 
@@ -87,6 +154,27 @@ namespace manapi::net {
 
         [[nodiscard]] const size_t &get_quic_cc_algo () const;
 
+        [[nodiscard]] const size_t &get_quic_max_idle_timeout () const;
+        [[nodiscard]] const size_t &get_quic_max_datagram_size () const;
+        [[nodiscard]] const size_t &get_quic_initial_max_data () const;
+        [[nodiscard]] const size_t &get_quic_initial_max_stream_data_bidi_local () const;
+        [[nodiscard]] const size_t &get_quic_initial_max_stream_data_bidi_remote () const;
+        [[nodiscard]] const size_t &get_quic_initial_max_stream_data_uni () const;
+        [[nodiscard]] const size_t &get_quic_initial_max_streams_bidi () const;
+        [[nodiscard]] const size_t &get_quic_initial_max_streams_uni () const;
+        [[nodiscard]] const size_t &get_quic_max_connection_window () const;
+        [[nodiscard]] const size_t &get_quic_max_stream_window () const;
+        [[nodiscard]] const size_t &get_quic_max_connections () const;
+        [[nodiscard]] const bool &is_quic_discover_pmtu () const;
+
+        const quic_dgram_config_t   &get_quic_dgram_config ();
+
+        [[nodiscard]] const size_t &get_http2_header_table_size () const;
+        [[nodiscard]] const size_t &get_http2_max_concurrent_streams () const;
+        [[nodiscard]] const size_t &get_http2_initial_window_size () const;
+        [[nodiscard]] const size_t &get_http2_max_frame_size () const;
+        [[nodiscard]] const size_t &get_http2_max_connections () const;
+
         const ssl_config_t          &get_ssl_config ();
 
         void set_server_address (const sockaddr &addr);
@@ -109,9 +197,50 @@ namespace manapi::net {
         // settings
         bool                        quic_debug              = false;
         size_t                      quic_cc_algo            = versions::QUIC_CC_RENO;
+        // quic transport parameters
+        size_t                      quic_max_idle_timeout                   = 50000;
+        size_t                      quic_max_datagram_size                  = 1350;
+        size_t                      quic_initial_max_data                   = 10000000;
+        size_t                      quic_initial_max_stream_data_bidi_local = 1000000;
+        size_t                      quic_initial_max_stream_data_bidi_remote= 1000000;
+        size_t                      quic_initial_max_stream_data_uni        = 1000000;
+        size_t                      quic_initial_max_streams_bidi           = 100;
+        size_t                      quic_initial_max_streams_uni            = 100;
+        // the limits of the auto-tuning flow control windows
+        size_t                      quic_max_connection_window              = 25165824;
+        size_t                      quic_max_stream_window                  = 16777216;
+        // 0 -> unlimited
+        size_t                      quic_max_connections                    = 0;
+        bool                        quic_discover_pmtu                      = false;
+        quic_dgram_config_t         quic_dgram_config;
+        // http2 settings (RFC 9113 6.5.2)
+        size_t                      http2_header_table_size                 = 4096;
+        size_t                      http2_max_concurrent_streams            = 100;
+        size_t                      http2_initial_window_size               = 65535;
+        size_t                      http2_max_frame_size                    = 16384;
+        // every http2 connection holds its own thread, the new ones over the cap are closed
+        size_t                      http2_max_connections                   = 256;
         size_t                      tls_version             = versions::TLS_v1_3;
         size_t                      max_header_block_size   = 4096;
         size_t                      socket_block_size       = 1350;
+        // count of the socket blocks in the buffer pool, 0 -> the heap
+        size_t                      buffer_pool_size        = 256;
+        size_t                      admission_target        = 0;
+        size_t                      admission_interval      = 100;
+        rate_limit_config_t         rate_limit_config;
+        // the pool replaces the shared objects while the tasks read them -> the atomic copies
+        std::atomic<std::shared_ptr<rate_limiter> >
+                                    limiter;
+        access_log_config_t         access_log_config;
+        std::atomic<std::shared_ptr<access_log> >
+                                    access_logger;
+        trace_config_t              trace_config;
+        std::atomic<std::shared_ptr<tracer> >
+                                    request_tracer;
+        size_t                      tcp_read_max            = MANAPI_HTTP_TCP_BLOCK_SIZE;
+        std::atomic<size_t>         tcp_read_size           = MANAPI_HTTP_TCP_READ_MIN;
+        std::atomic<std::shared_ptr<utils::buffer_pool> >
+                                    buffer_pool;
         size_t                      partial_data_min_size   = 4194304;
         size_t                      http_version            = versions::HTTP_v1_1;
         std::string                 http_version_str        = "1.1";
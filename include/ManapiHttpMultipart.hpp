@@ -0,0 +1,57 @@
+#ifndef MANAPIHTTPMULTIPART_HPP
+#define MANAPIHTTPMULTIPART_HPP
+
+#include <string>
+#include <span>
+#include <functional>
+#include <algorithm>
+
+namespace manapi::net {
+    struct multipart_part_t {
+        std::string                                 name;
+        std::string                                 file_name;
+        std::string                                 mime_type;
+        bool                                        is_file         = false;
+    };
+
+    /**
+     * multipart/form-data parser, it jumps between the delimiters by the Boyer-Moore-Horspool search,
+     * the data of the parts goes to the handler as spans of the body parts, only the tail which can be
+     * the beginning of the split delimiter (< the size of the delimiter) is kept between the reads
+     */
+    class multipart_reader {
+    public:
+        // source -> the next part of the body, empty -> end
+        multipart_reader (const std::string &boundary, std::function<std::span<const char>()> source, const size_t &max_header_size);
+
+        multipart_reader (const multipart_reader &) = delete;
+        multipart_reader &operator= (const multipart_reader &) = delete;
+
+        // reads the headers of the next part, false -> the closing delimiter
+        bool                                        next_part (multipart_part_t &part);
+        // the data of the current part up to the next delimiter, handler = nullptr -> skip
+        void                                        read_data (const std::function<void(const char *, const size_t &)> &handler);
+    private:
+        bool                                        fetch ();
+        std::string                                 read_line ();
+
+        std::function<std::span<const char>()>      source;
+        size_t                                      max_header_size;
+
+        // \r\n--boundary
+        std::string                                 delimiter;
+        std::boyer_moore_horspool_searcher<std::string::const_iterator>
+                                                    searcher;
+
+        // the unread bytes of the current body part
+        std::span<const char>                       buffer;
+        // the tail of the previous body part, it can be the beginning of the delimiter
+        std::string                                 pending;
+
+        // the data of the current part is not read (the preamble at the start)
+        bool                                        in_part         = true;
+        bool                                        finished        = false;
+    };
+}
+
+#endif //MANAPIHTTPMULTIPART_HPP
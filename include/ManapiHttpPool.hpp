@@ -13,8 +13,27 @@
 #include "ManapiJson.hpp"
 #include "ManapiTask.hpp"
 #include "ManapiSite.hpp"
+#include "ManapiTls.hpp"
+#include "ManapiTaskHttp.hpp"
 
 namespace manapi::net {
+    class http_pool;
+
+    // the TCP connection until the handshake and the request head are received
+    struct tcp_pending_conn {
+        explicit tcp_pending_conn (ev::loop_ref loop) : io (loop), timer (loop) {}
+
+        http_pool                   *pool;
+        int                         fd;
+        std::unique_ptr<http_task>  task;
+        ev::io                      io;
+        ev::timer                   timer;
+
+        // the handshake step is in the crypto pool
+        bool                        in_crypto   = false;
+        bool                        expired     = false;
+    };
+
     class http_pool {
     public:
         explicit http_pool(const json &config, class site *site, const size_t &id);
@@ -28,8 +47,15 @@ namespace manapi::net {
         void                        new_connection_quic    (ev::io &watcher, int revents);
         void                        new_connection_tls     (ev::io &watcher, int revents);
 
+        static void                 tcp_pending_io         (ev::io &watcher, int revents);
+        static void                 tcp_pending_timeout    (ev::timer &watcher, int revents);
+
         class site                  &get_site () const;
 
+        // nullptr if the handshakes are in the loop
+        const std::unique_ptr<tls::crypto_pool>
+                                    &get_crypto_pool () const;
+
         // quic data
         quic_map_conns_t            quic_map_conns;
 
@@ -39,8 +65,29 @@ namespace manapi::net {
         const int                   &get_fd ();
     private:
         int                         _pool ();
-        static SSL_CTX*             ssl_create_context (const size_t &version = versions::TLS_v1_3);
+        static SSL_CTX*             ssl_create_context (const size_t &version = versions::TLS_v1_3, const size_t &http_version = versions::HTTP_v1_1);
         void                        ssl_configure_context ();
+        void                        tcp_pending_step (tcp_pending_conn *conn);
+        static int                  tcp_pending_prepare (tcp_pending_conn *conn);
+        void                        tcp_pending_apply (tcp_pending_conn *conn, const int &status);
+        void                        crypto_completed (ev::async &watcher, int revents);
+        void                        tcp_pending_remove (tcp_pending_conn *conn, const bool &dispatch);
+        // the admission control of the tasks of the level
+        bool                        is_overloaded (const size_t &level) const;
+        void                        start_timers ();
+        void                        stop_timers ();
+        struct timers_t {
+            std::mutex              mutex;
+            bool                    running         = false;
+            size_t                  ticket_timer    = 0;
+            size_t                  ocsp_timer      = 0;
+            size_t                  limiter_timer   = 0;
+        };
+
+        // the timers of the timerpool are one-shot, the tasks keep the state instead of the pool
+        static void                 repeat_timer (class site *site, const std::shared_ptr<timers_t> &timers, size_t timers_t::*timer_id, const std::chrono::milliseconds &interval, const std::function<void()> &task);
+        // the gauges of the pool for the scrape of the site metrics
+        void                        collect_metrics (metrics::writer &out);
 
         size_t                      id;
 
@@ -59,6 +106,33 @@ namespace manapi::net {
         class site                  *site;
         // watchers
         std::unique_ptr<ev::io>     ev_io;
+
+        // accessed only by the loop
+        std::unordered_map<int, std::unique_ptr<tcp_pending_conn> >
+                                    tcp_pending;
+
+        // the packets without the connection (quic), used only by the loop
+        std::unique_ptr<uint8_t[]>  quic_out;
+
+        // handshakes
+        std::unique_ptr<tls::crypto_pool>
+                                    crypto;
+        // the http2 connections in their threads, the tasks release it
+        std::shared_ptr<std::atomic<size_t> >
+                                    h2_connections  = std::make_shared<std::atomic<size_t> >(0);
+        std::unique_ptr<ev::async>  crypto_async;
+        std::mutex                  m_crypto;
+        std::deque<std::pair<tcp_pending_conn *, int> >
+                                    crypto_done;
+
+        // tls
+        std::shared_ptr<tls::ocsp_stapler>
+                                    ocsp_stapler;
+
+        // the timers of the pool, stop_timers () stops the tasks which are already running
+        std::shared_ptr<timers_t>   timers          = std::make_shared<timers_t>();
+
+        size_t                      metrics_collector = 0;
     };
 }
 
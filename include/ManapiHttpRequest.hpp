@@ -5,10 +5,13 @@
 #include <map>
 #include <string>
 #include <functional>
+#include <span>
 #include "ManapiHttpConfig.hpp"
 #include "ManapiUtils.hpp"
 #include "ManapiJson.hpp"
 #include "ManapiJsonMask.hpp"
+#include "ManapiJsonTape.hpp"
+#include "ManapiHttpMultipart.hpp"
 
 namespace manapi::net {
     struct file_data_t {
@@ -18,6 +21,22 @@ namespace manapi::net {
         std::string param_name;
     };
 
+    class http_request;
+
+    /**
+     * pulls the body of the request by parts, the socket is read only when the next part is requested,
+     * so the slow consumer holds the TCP window
+     */
+    class http_body_stream {
+    public:
+        explicit http_body_stream (http_request *request);
+
+        // the span is valid until the next call, empty -> the end of the body
+        std::span<const char>                       next ();
+    private:
+        http_request                                *request;
+    };
+
     class http_request {
     public:
         http_request(const manapi::net::utils::manapi_socket_information &ip_data, manapi::net::request_data_t &request_data, void* http_task, class config *config, const void *handler);
@@ -30,8 +49,14 @@ namespace manapi::net {
         [[nodiscard]] const std::string             &get_param (const std::string &param) const;
         [[nodiscard]] std::string                   dump() const;
         std::string                                 text ();
+        http_body_stream                            body_stream ();
+        // plain TCP -> splice(2) from the socket to the file, otherwise by the body stream
+        void                                        set_body_to_local (const std::string &filepath);
         manapi::json                                json ();
+        // the whole body in the read-only tape (plain body size limit)
+        manapi::json_tape                           json_tape ();
         manapi::net::utils::MAP_STR_STR             form ();
+        // SIZE_MAX -> the size is unknown (HTTP/2 without the content-length)
         const size_t                                &get_body_size ();
         void                                        set_max_plain_body_size (const size_t &size);
         const file_data_t                           &inf_file ();
@@ -45,6 +70,9 @@ namespace manapi::net {
         bool                                        has_header      (const std::string &name);
 
         const std::string&                          get_query_param (const std::string &name);
+        bool                                        has_query_param (const std::string &name);
+        // ?tag=a&tag=b -> [a, b]
+        utils::VEC_STR                              get_query_params (const std::string &name);
 
         [[nodiscard]] const std::unique_ptr<const manapi::json_mask> &get_post_mask () const;
         [[nodiscard]] const std::unique_ptr<const manapi::json_mask> &get_get_mask () const;
@@ -52,11 +80,13 @@ namespace manapi::net {
         void                                        stop_propagation (const bool &stop_propagation = true);
         [[nodiscard]] const bool&                   get_propagation ();
     private:
+        friend class http_body_stream;
+
         void                                        _read_body (const std::function<void(const char *, const size_t &)> &handler);
+        std::span<const char>                       _next_body_part ();
         void                                        parse_map_url_param ();
-        static void                                 buff_to_extra_buff (const request_data_t *req_data, const size_t &start, const size_t &end, char *dest, size_t &size);
         static void                                 chars2string (std::string &str, const char *ptr, const size_t &size);
-        void                                        multipart_read_param (const std::function<void(const char *, const size_t &)> &send_line = nullptr, const std::function<void(const std::string &)> &send_name = nullptr);
+        void                                        set_file_data (const multipart_part_t &part);
 
         // peer ip
         const utils::manapi_socket_information      *ip_data;
@@ -73,8 +103,8 @@ namespace manapi::net {
         // server
         class config                                *config;
 
-        // boundary --XXXXXxxxXXX for form data
-        std::string                                 body_boundary;
+        // multipart/form-data, the files are read after form ()
+        std::unique_ptr<multipart_reader>           multipart;
 
         // if peer sent larger by size then max_plain_body_size -> error
         size_t                                      max_plain_body_size = 1000000;
@@ -83,11 +113,7 @@ namespace manapi::net {
         file_data_t                                 file_data;
 
         // url get params ?param1=xxx&param2=xxx
-        std::unique_ptr<std::map <std::string, std::string>> map_url_params;
-
-        bool                                        first_line = true;
-
-        char                                        *buff_extra;
+        std::unique_ptr<utils::url_params>          map_url_params;
 
         bool                                        is_propagation = true;
     };
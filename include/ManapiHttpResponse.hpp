@@ -4,6 +4,7 @@
 #include <string>
 #include <map>
 #include "ManapiJson.hpp"
+#include "ManapiJsonWriter.hpp"
 #include "ManapiUtils.hpp"
 #include "ManapiApi.hpp"
 
@@ -23,6 +24,8 @@ namespace manapi::net {
 
         void text                   (const std::string &plain_text);
         void json                   (const manapi::json &jp, const size_t &spaces = 0);
+        // the document is written by the handler while it is sent (by the socket blocks)
+        void json_stream            (const std::function<void(manapi::json_writer &writer)> &handler);
         void set_status             (const size_t &_status_code, const std::string &_status_message);
         void set_status_code        (const size_t &_status_code);
         void set_status_message     (const std::string &_status_message);
@@ -47,6 +50,7 @@ namespace manapi::net {
         [[nodiscard]] bool              is_file     () const;
         [[nodiscard]] bool              is_text     () const;
         [[nodiscard]] bool              is_proxy    () const;
+        [[nodiscard]] bool              is_stream   () const;
         [[nodiscard]] bool              is_no_data  () const;
 
         [[nodiscard]] bool              has_ranges  () const;
@@ -56,6 +60,7 @@ namespace manapi::net {
         const std::string               &get_data   ();
 
         const std::string               &get_compress   ();
+        const std::function<void(manapi::json_writer &)> &get_stream ();
 
         std::vector <std::pair <ssize_t, ssize_t> > ranges;
 
@@ -76,6 +81,7 @@ namespace manapi::net {
         class config                    *config;
 
         std::string                     data;
+        std::function<void(manapi::json_writer &)> stream;
 
         size_t                          status_code;
         std::string                     status_message;
@@ -115,6 +115,8 @@ namespace manapi::net {
         std::string KEEP_ALIVE          = "keep-alive";
         std::string ALT_SVC             = "alt-svc";
         std::string AUTHORIZATION       = "authorization";
+        std::string SERVER_TIMING       = "server-timing";
+        std::string TRANSFER_ENCODING   = "transfer-encoding";
     } HTTP_HEADER;
 
     static const struct {
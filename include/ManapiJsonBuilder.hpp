@@ -11,7 +11,6 @@ namespace manapi {
     class json_builder {
     public:
         explicit json_builder (const json_mask &mask = nullptr, const bool &use_bigint = false, const size_t &bigint_precision = 128);
-        explicit json_builder (const json &mask, const bool &use_bigint = false, const size_t &bigint_precision = 128);
         ~json_builder();
         json_builder &operator<< (const std::string_view &str);
         json_builder &operator<< (const char &c);
@@ -29,6 +28,9 @@ namespace manapi {
         static bool                        _valid_utf_char (const std::string_view &plain_text, const size_t &i, size_t &left);
         static void                        _valid_utf_string (const std::string_view &str);
     private:
+        // the nested value, checked by the compiled rule of the mask
+        json_builder (const json_mask *mask, const uint32_t &rule, const bool &use_bigint, const size_t &bigint_precision);
+
         void _reset ();
         void _parse (const std::string_view &plain_text, size_t &j, bool root = true);
         void _check_type (const std::string_view &plain_text, size_t &j);
@@ -39,20 +41,10 @@ namespace manapi {
         void _build_array (const std::string_view &plain_text, size_t &j);
         void _check_end (const std::string_view &plain_text, size_t &j);
 
-        void _reset_type ();
-        void _next_type ();
         void _check_eq_type ();
-        bool _check_max_mean (const bool &building = false);
-        bool _check_min_mean ();
-        bool _check_type_none_complex_value ();
-        bool _check_default ();
-        bool _check_meta_value ();
-        void _check_string ();
-        void _check_numeric ();
-        void _check_object ();
-        void _check_array ();
-
-        [[nodiscard]] const json &get_current_type ();
+        void _check_size (const size_t &size) const;
+        void _check_value () const;
+        [[nodiscard]] std::unique_ptr<json_builder> _make_item (const uint32_t &item_rule) const;
 
 
         json::types type = json::type_null;
@@ -61,8 +53,12 @@ namespace manapi {
         size_t i = 0;
         std::function<void(const std::string_view &, size_t &j)> action;
 
-        const json *current_types;
-        size_t current_type;
+        // the compiled rules, npos -> the value is not checked
+        const json_mask *mask = nullptr;
+        uint32_t base_rule = json_mask::npos;
+        uint32_t rule = json_mask::npos;
+        // the root checks the whole document at the end
+        bool root = false;
 
         // bigint
         bool use_bigint = false;
@@ -84,8 +80,6 @@ namespace manapi {
         size_t end_cut;
 
         std::string buffer;
-        const ssize_t *max_mean_size = nullptr;
-        const ssize_t *min_mean_size = nullptr;
 
         bool getting = false;
         bool ready = false;
@@ -1,9 +1,15 @@
 #ifndef MANAPIHTTP_MANAPIJSONMASK_H
 #define MANAPIHTTP_MANAPIJSONMASK_H
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include "ManapiJson.hpp"
 
 namespace manapi {
+    class json_view;
+
     class json_mask {
     public:
         json_mask(const std::initializer_list<json> &data);
@@ -15,16 +21,79 @@ namespace manapi {
 
         [[nodiscard]] bool valid (const json &obj) const;
         [[nodiscard]] bool valid (const std::map <std::string, std::string> &obj) const;
+        // the value in the tape, without the tree of the nodes
+        [[nodiscard]] bool valid (const json_view &obj) const;
 
         [[nodiscard]] const json &get_api_tree () const;
     private:
+        // the streamed bodies are checked by the compiled rules while building
+        friend class json_builder;
+
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        /**
+         * the compiled node of the rules, the children are the ranges of the vectors
+         */
+        struct rule_t {
+            // json::types, MANAPI_JSON_ANY, MANAPI_JSON_NONE or the alternatives
+            ssize_t     type            = 0;
+            // the alternatives, the items of the array (children) or the keys of the object (fields)
+            uint32_t    first           = 0;
+            uint32_t    count           = 0;
+            bool        has_data        = false;
+            // the rule of the all items of the array
+            uint32_t    items           = npos;
+            // the index in the values
+            uint32_t    value           = npos;
+            uint32_t    mean            = npos;
+            // by size (string, object, array)
+            bool        has_min         = false;
+            bool        has_max         = false;
+            json::NUMBER min            = 0;
+            json::NUMBER max            = 0;
+        };
+
+        struct field_t {
+            std::string key;
+            uint32_t    hash;
+            uint32_t    rule;
+            bool        none;
+        };
+
         bool enabled;
 
         json information;
+
+        // the compiled information, the first rule is the root
+        std::vector<rule_t>     rules;
+        std::vector<uint32_t>   children;
+        // in the order of the keys of the object (json::OBJECT)
+        std::vector<field_t>    fields;
+        std::vector<json>       values;
+
+        uint32_t compile (const json &item, const bool &is_complex = true);
+
+        template <typename T>
+        [[nodiscard]] bool execute (const T &obj, const uint32_t &index) const;
+        [[nodiscard]] bool execute_object (const json &obj, const rule_t &rule) const;
+        [[nodiscard]] bool execute_object (const json_view &obj, const rule_t &rule) const;
+        [[nodiscard]] bool execute_object (const std::map <std::string, std::string> &obj, const rule_t &rule) const;
+        [[nodiscard]] bool execute_array (const json &obj, const rule_t &rule) const;
+        [[nodiscard]] bool execute_array (const json_view &obj, const rule_t &rule) const;
+        [[nodiscard]] bool execute_string (const std::string_view &obj, const uint32_t &index) const;
+        [[nodiscard]] bool compare_size (const size_t &size, const rule_t &rule) const;
+
+        // json_builder: the value of the type starts, false -> no rule accepts it, npos -> any value
+        [[nodiscard]] bool resolve (uint32_t &index, const json::types &type) const;
+        // json_builder: the rule of the value of the key or the element, npos -> not described
+        [[nodiscard]] uint32_t field (const uint32_t &index, const std::string_view &key) const;
+        [[nodiscard]] uint32_t item (const uint32_t &index, const size_t &element) const;
+        // json_builder: false -> the growing string, object or array can not fit the rule anymore
+        [[nodiscard]] bool fits (const uint32_t &index, const size_t &size) const;
+        [[nodiscard]] bool check (const json &obj, const uint32_t &index) const;
+
         static void _insert_meta_row (json &information, const std::string &key, const json &value);
         static void initial_resolve_information (json &obj);
-        static bool recursive_valid (const json &obj, const json &information, const bool &is_complex = true);
-        static bool default_compare_information (const json &obj, const json &information, const bool &by_size = true);
     };
 }
 
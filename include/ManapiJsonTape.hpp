@@ -0,0 +1,161 @@
+#ifndef MANAPIJSONTAPE_HPP
+#define MANAPIJSONTAPE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ManapiJson.hpp"
+
+namespace manapi {
+    class json_tape;
+
+    /**
+     * the value in the tape, it is valid while the tape is alive and not parsed again
+     */
+    class json_view {
+    public:
+        class iterator {
+        public:
+            iterator (const json_tape *tape, const size_t &index, const bool &object);
+
+            // the value (the element of the array or the value of the key)
+            json_view               operator* () const;
+            iterator                &operator++ ();
+            bool                    operator== (const iterator &other) const;
+
+            // only for the objects
+            [[nodiscard]] std::string_view key () const;
+        private:
+            const json_tape         *tape;
+            size_t                  index;
+            bool                    object;
+        };
+
+        json_view (const json_tape *tape, const size_t &index);
+
+        [[nodiscard]] json::types   type () const;
+
+        [[nodiscard]] bool          is_object () const;
+        [[nodiscard]] bool          is_array () const;
+        [[nodiscard]] bool          is_string () const;
+        [[nodiscard]] bool          is_number () const;
+        [[nodiscard]] bool          is_null () const;
+        [[nodiscard]] bool          is_decimal () const;
+        [[nodiscard]] bool          is_bigint () const;
+        [[nodiscard]] bool          is_bool () const;
+
+        // strict retrieval, like json::as_...
+        [[nodiscard]] std::string_view
+                                    as_string () const;
+        [[nodiscard]] json::NUMBER  as_number () const;
+        [[nodiscard]] json::DECIMAL as_decimal () const;
+        [[nodiscard]] json::BIGINT  as_bigint () const;
+        [[nodiscard]] bool          as_bool () const;
+        // number, decimal or bigint -> decimal
+        [[nodiscard]] json::DECIMAL as_decimal_cast () const;
+
+        // the items of the object/array, the length of the string
+        [[nodiscard]] size_t        size () const;
+        [[nodiscard]] bool          contains (const std::string_view &key) const;
+
+        [[nodiscard]] json_view     operator[] (const std::string_view &key) const;
+        [[nodiscard]] json_view     at (const std::string_view &key) const;
+        // O(index): the tape has no offsets of the elements, the loop over the array must use the iterator
+        [[nodiscard]] json_view     operator[] (const size_t &index) const;
+        [[nodiscard]] json_view     at (const size_t &index) const;
+
+        [[nodiscard]] iterator      begin () const;
+        [[nodiscard]] iterator      end () const;
+
+        [[nodiscard]] std::string   dump () const;
+        void                        dump_to (std::string &out) const;
+        // the tree of the nodes (the compatibility with the json API)
+        [[nodiscard]] json          to_json () const;
+
+        [[nodiscard]] size_t        get_index () const;
+    private:
+        friend class json_mask;
+
+        // the index of the key or npos
+        [[nodiscard]] size_t        find (const std::string_view &key) const;
+        // the hash of the key is known (the compiled masks)
+        [[nodiscard]] size_t        find (const std::string_view &key, const uint32_t &code) const;
+        void                        throw_could_not_use_func (const char *func) const;
+
+        const json_tape             *tape;
+        size_t                      index;
+    };
+
+    /**
+     * the parsed document as the contiguous tape of 64-bit words and the arena of the strings:
+     * [type:8][payload:56], the containers keep the index of their end, the strings are unescaped
+     * into the arena with the length and the hash of the key, so the lookups do not compare the bytes
+     * of the other keys and the whole document is two allocations
+     */
+    class json_tape {
+    public:
+        json_tape () = default;
+        explicit json_tape (const std::string_view &plain_text, const bool &use_bigint = false, const size_t &bigint_precision = 128);
+
+        // the previous views are invalid, the memory is reused
+        void                        parse (const std::string_view &plain_text);
+
+        [[nodiscard]] json_view     root () const;
+        [[nodiscard]] bool          empty () const;
+
+        // tape + strings + structurals (bytes)
+        [[nodiscard]] size_t        memory () const;
+
+        static uint32_t             hash (const std::string_view &key);
+    private:
+        friend class json_view;
+        friend class json_view::iterator;
+        friend class json_tape_parser;
+
+        enum word_t : uint8_t {
+            TAPE_NULL       = 'n',
+            TAPE_TRUE       = 't',
+            TAPE_FALSE      = 'f',
+            // the next word is int64_t
+            TAPE_NUMBER     = 'l',
+            // the next decimal_words words are json::DECIMAL (long double)
+            TAPE_DECIMAL    = 'd',
+            // the text of the number in the strings (bigint or out of int64_t)
+            TAPE_BIGINT     = 'B',
+            TAPE_STRING     = '"',
+            // [count:24][the index after the end:32]
+            TAPE_OBJECT     = '{',
+            TAPE_OBJECT_END = '}',
+            TAPE_ARRAY      = '[',
+            TAPE_ARRAY_END  = ']'
+        };
+
+        static constexpr size_t     max_depth       = 1024;
+        static constexpr size_t     decimal_words   = (sizeof (json::DECIMAL) + sizeof (uint64_t) - 1) / sizeof (uint64_t);
+
+        [[nodiscard]] uint8_t       word (const size_t &index) const;
+        [[nodiscard]] uint64_t      payload (const size_t &index) const;
+        // the index of the next value
+        [[nodiscard]] size_t        skip (const size_t &index) const;
+        [[nodiscard]] std::string_view
+                                    string (const size_t &index) const;
+        [[nodiscard]] uint32_t      string_hash (const size_t &index) const;
+
+        void                        write (const word_t &type, const uint64_t &payload);
+        // [length:32][hash:32][bytes]
+        size_t                      begin_string ();
+        void                        end_string (const size_t &offset, const bool &key);
+
+        std::vector<uint64_t>       tape;
+        std::string                 strings;
+        // stage 1 of the parser (the positions of the tokens), reused by parse ()
+        std::vector<uint32_t>       structurals;
+
+        bool                        use_bigint      = false;
+        size_t                      bigint_precision = 128;
+    };
+}
+
+#endif //MANAPIJSONTAPE_HPP
@@ -0,0 +1,95 @@
+#ifndef MANAPIJSONWRITER_HPP
+#define MANAPIJSONWRITER_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "ManapiJson.hpp"
+
+namespace manapi {
+    /**
+     * the streaming serializer, the text is given to the handler by the blocks,
+     * so the memory does not depend on the size of the document:
+     * writer.begin_object().key("items").begin_array().value(1).end_array().end_object();
+     */
+    class json_writer {
+    public:
+        typedef std::function<void(const char *data, const size_t &size)> handler_t;
+
+        /**
+         * @param chunked each block is framed as the chunk of HTTP/1.1 (size CRLF data CRLF),
+         * so the handler gets one write per block
+         */
+        explicit json_writer (handler_t handler, const size_t &block_size = 16384, const bool &chunked = false);
+
+        json_writer                 &begin_object ();
+        json_writer                 &end_object ();
+        json_writer                 &begin_array ();
+        json_writer                 &end_array ();
+        json_writer                 &key (const std::string_view &key);
+
+        json_writer                 &value (const std::string_view &str);
+        json_writer                 &value (const std::string &str);
+        json_writer                 &value (const char *str);
+        // all integers (int, uint32_t, size_t, ...), not bool and not the characters
+        template <typename T>
+        requires (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>)
+        json_writer                 &value (const T &num)
+        {
+            char block[24];
+
+            before_value();
+            buffer.append(block, std::to_chars(block, block + sizeof (block), num).ptr);
+            after_value();
+
+            return *this;
+        }
+        json_writer                 &value (const double &num);
+        json_writer                 &value (const json::DECIMAL &num);
+        json_writer                 &value (const bool &b);
+        json_writer                 &value (const std::nullptr_t &);
+        // the subtree
+        json_writer                 &value (const json &obj);
+
+        // the rest of the buffer to the handler
+        void                        flush ();
+        // the rest of the buffer and the last chunk (chunked) in one write
+        void                        finish ();
+
+        // the document is closed
+        [[nodiscard]] bool          is_complete () const;
+        // the bytes given to the handler
+        [[nodiscard]] size_t        get_written () const;
+    private:
+        void                        before_value ();
+        void                        after_value ();
+        void                        close (const bool &object);
+        void                        emit (const bool &last);
+
+        // the hex size of the block and CRLF
+        static constexpr size_t     chunk_head_size = sizeof (size_t) * 2 + 2;
+
+        handler_t                   handler;
+        size_t                      block_size;
+        bool                        chunked;
+        // the place of the head of the chunk at the beginning of the buffer
+        size_t                      prefix;
+        std::string                 buffer;
+
+        // the open containers, true -> the object
+        std::vector<bool>           stack;
+        // the first item of the container
+        bool                        first       = true;
+        // the value of the key is expected
+        bool                        after_key   = false;
+        bool                        complete    = false;
+        size_t                      written     = 0;
+    };
+}
+
+#endif //MANAPIJSONWRITER_HPP
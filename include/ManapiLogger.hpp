@@ -0,0 +1,135 @@
+#ifndef MANAPILOGGER_HPP
+#define MANAPILOGGER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <sys/types.h>
+
+#include "ManapiHttpTypes.hpp"
+
+// the lower levels are removed by the preprocessor
+#define MANAPI_LOG_LEVEL_DEBUG  0
+#define MANAPI_LOG_LEVEL_ERROR  1
+#define MANAPI_LOG_LEVEL_NONE   2
+
+#ifndef MANAPI_LOG_LEVEL
+#define MANAPI_LOG_LEVEL MANAPI_LOG_LEVEL_DEBUG
+#endif
+
+namespace manapi::net::utils {
+    enum log_level_t {
+        LOG_DEBUG   = MANAPI_LOG_LEVEL_DEBUG,
+        // the exceptions
+        LOG_ERROR   = MANAPI_LOG_LEVEL_ERROR
+    };
+
+    enum log_format_t {
+        // [time][errnum]: func() (file:line): message
+        LOG_FORMAT_TEXT = 0,
+        // one object per line
+        LOG_FORMAT_JSON = 1
+    };
+
+    /**
+     * the bounded MPSC ring of the records, the threads only format the message into the slot,
+     * the background thread writes the batches to stdout/stderr.
+     * the full ring drops the records, the logging never blocks the loops and the workers
+     */
+    class logger {
+    public:
+        static logger               &shared ();
+
+        // false -> the call site is over the rate in this second, the message is not formatted
+        bool                        allow (const char *file, const size_t &line, uint32_t &suppressed);
+        void                        write (const log_level_t &level, const err_num &errnum, const size_t &line, const char *file, const char *func, const uint32_t &suppressed, const std::string_view &message);
+
+        // waits until the records before the call are written
+        void                        flush ();
+        // the records after the stop are written by the caller
+        void                        stop ();
+
+        void                        set_format (const log_format_t &format);
+        // the records per second of one call site, 0 -> unlimited
+        void                        set_rate_limit (const size_t &rate);
+
+        [[nodiscard]] size_t        get_dropped () const;
+    private:
+        logger ();
+
+        static constexpr size_t     capacity        = 4096;
+        static constexpr size_t     message_size    = 440;
+        static constexpr size_t     limits_count    = 256;
+
+        struct record_t {
+            std::chrono::system_clock::time_point
+                                    time;
+            const char              *file;
+            const char              *func;
+            size_t                  line;
+            err_num                 errnum;
+            pid_t                   thread;
+            uint32_t                suppressed;
+            uint16_t                size;
+            uint8_t                 level;
+            char                    message[message_size];
+        };
+
+        struct slot_t {
+            // == position -> free, == position + 1 -> written
+            std::atomic<size_t>     sequence;
+            record_t                record;
+        };
+
+        struct alignas (64) limit_t {
+            // [second:40][count:24]
+            std::atomic<uint64_t>   state           = 0;
+            std::atomic<uint32_t>   suppressed      = 0;
+        };
+
+        void                        run ();
+        // true -> the records were written
+        bool                        drain ();
+        // true -> the next record is written by a producer
+        bool                        pending () const;
+        void                        wake ();
+        void                        append (std::string &out, const record_t &record);
+
+        std::unique_ptr<slot_t[]>   slots;
+
+        alignas (64) std::atomic<size_t>
+                                    tail            = 0;
+        alignas (64) std::atomic<size_t>
+                                    head            = 0;
+
+        // the flusher waits on it (futex) while the ring is empty, the producers wake it
+        alignas (64) std::atomic<bool>
+                                    idle            = false;
+
+        std::array<limit_t, limits_count>
+                                    limits;
+
+        std::atomic<size_t>         dropped         = 0;
+        std::atomic<size_t>         rate            = 100;
+        std::atomic<int>            format          = LOG_FORMAT_TEXT;
+
+        std::atomic<bool>           running         = true;
+        std::mutex                  m_drain;
+        std::thread                 flusher;
+
+        // the drops which are already in the log
+        size_t                      dropped_written = 0;
+
+        // the cache of the formatted second
+        int64_t                     time_second     = -1;
+        std::string                 time_text;
+    };
+}
+
+#endif //MANAPILOGGER_HPP
@@ -0,0 +1,141 @@
+#ifndef MANAPIMETRICS_HPP
+#define MANAPIMETRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace manapi::net::metrics {
+    // the slots of one counter, the threads take them round-robin
+    static constexpr size_t             slots_count = 16;
+
+    /**
+     * the counter without the shared cache line: the thread adds to its own slot,
+     * only the scrape reads all of them
+     */
+    class counter {
+    public:
+        void                            add (const uint64_t &value = 1);
+        [[nodiscard]] uint64_t          get () const;
+    private:
+        struct alignas (64) slot_t {
+            std::atomic<uint64_t>       value       = 0;
+        };
+
+        std::array<slot_t, slots_count> slots;
+    };
+
+    /**
+     * the log-linear buckets (HDR): 16 buckets per the power of two, the error of the value is less than 6.25%
+     */
+    class histogram {
+    public:
+        void                            record (const uint64_t &value);
+
+        [[nodiscard]] uint64_t          get_count () const;
+        [[nodiscard]] uint64_t          get_sum () const;
+        // the recorded values <= value (by the lower bounds of the buckets)
+        [[nodiscard]] uint64_t          count_below (const uint64_t &value) const;
+    private:
+        static constexpr size_t         sub_bits        = 4;
+        static constexpr size_t         sub_count       = 1 << sub_bits;
+        // the larger values are in the last bucket
+        static constexpr size_t         max_bits        = 40;
+        static constexpr size_t         buckets_count   = (max_bits - sub_bits + 1) * sub_count;
+
+        static size_t                   index (const uint64_t &value);
+        static uint64_t                 lower (const size_t &index);
+
+        std::array<std::atomic<uint64_t>, buckets_count>
+                                        buckets {};
+
+        counter                         count;
+        counter                         sum;
+    };
+
+    /**
+     * the families of the Prometheus text format, the samples with the same name are grouped
+     */
+    class writer {
+    public:
+        void                            add_counter (const std::string &name, const std::string &help, const double &value, const std::string &labels = "");
+        void                            add_gauge (const std::string &name, const std::string &help, const double &value, const std::string &labels = "");
+        // the histogram of microseconds as seconds
+        void                            add_histogram (const std::string &name, const std::string &help, const histogram &value, const std::string &labels = "");
+
+        [[nodiscard]] std::string       str () const;
+    private:
+        struct family_t {
+            std::string                 help;
+            std::string                 type;
+            std::string                 samples;
+        };
+
+        family_t                        &family (const std::string &name, const std::string &help, const std::string &type);
+        static void                     sample (std::string &out, const std::string &name, const std::string &labels, const double &value);
+
+        std::vector<std::string>        order;
+        std::map<std::string, family_t> families;
+    };
+
+    typedef std::function<void(writer &out)> collector_t;
+
+    /**
+     * the metrics of the site, the hot paths only add to the counters,
+     * the gauges of the pools (queues, crypto, buffers) are read by the collectors on the scrape
+     */
+    class registry {
+    public:
+        // the connections (TCP + QUIC)
+        counter                         accepted;
+        counter                         closed;
+
+        counter                         requests;
+        counter                         bytes_in;
+        counter                         bytes_out;
+
+        // the bodies before and after the compression
+        counter                         compress_in;
+        counter                         compress_out;
+
+        // the time after the deadline of the timer until it runs (microseconds)
+        histogram                       timer_lag;
+
+        // the quiche_stats of the closed connections
+        counter                         quic_recv;
+        counter                         quic_sent;
+        counter                         quic_lost;
+        histogram                       quic_rtt;
+
+        // the static files and the pages without the handler
+        histogram                       unmatched;
+
+        // the latency of the page (microseconds), the pointer is stable
+        histogram                       *route (const std::string &method, const std::string &uri);
+
+        // the id > 0
+        size_t                          add_collector (collector_t collector);
+        void                            remove_collector (const size_t &id);
+
+        [[nodiscard]] std::string       render () const;
+    private:
+        mutable std::mutex              mutex;
+
+        std::map<std::pair<std::string, std::string>, std::unique_ptr<histogram> >
+                                        routes;
+
+        std::map<size_t, collector_t>   collectors;
+        size_t                          next_collector  = 0;
+    };
+
+    // the escaped value of the label
+    std::string                         label (const std::string &name, const std::string &value);
+}
+
+#endif //MANAPIMETRICS_HPP
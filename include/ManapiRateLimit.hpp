@@ -0,0 +1,100 @@
+#ifndef MANAPIRATELIMIT_HPP
+#define MANAPIRATELIMIT_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <sys/socket.h>
+
+namespace manapi::net {
+    struct rate_limit_config_t {
+        bool            enabled         = false;
+        // the requests per second of one address
+        size_t          rate            = 100;
+        size_t          burst           = 200;
+        // the requests per second of the /24 (IPv4) or the /64 (IPv6), 0 -> disabled
+        size_t          subnet_rate     = 1000;
+        size_t          subnet_burst    = 2000;
+        // the connections of one address, 0 -> unlimited
+        size_t          max_connections = 0;
+        // the buckets in the table, the new addresses over the limit share one bucket per shard
+        size_t          max_entries     = 65536;
+        // seconds between the sweeps of the idle buckets
+        size_t          sweep           = 10;
+    };
+
+    /**
+     * the token buckets of the clients, the table is split to the shards by the hash of the address,
+     * the full buckets without the connections are the same as the new ones, so they are removed by sweep ()
+     */
+    class rate_limiter {
+    public:
+        struct key_t {
+            uint64_t    hi      = 0;
+            uint64_t    lo      = 0;
+            // the length of the prefix: 32/128 -> the address, 24/64 -> the subnet
+            uint8_t     prefix  = 0;
+
+            bool operator== (const key_t &other) const = default;
+        };
+
+        explicit rate_limiter (const rate_limit_config_t &config);
+
+        // false -> the address is invalid
+        static bool                 make_key (const sockaddr *addr, key_t &key);
+        static bool                 make_key (const std::string &ip, key_t &key);
+
+        // takes the tokens of the address and the subnet, false -> 429
+        bool                        allow (const key_t &key, const double &cost = 1);
+        // false -> the connections of the address are over the cap,
+        // counted -> the connection must be released by disconnect ()
+        bool                        connect (const key_t &key, bool &counted);
+        void                        disconnect (const key_t &key);
+
+        // removes the idle buckets, the full shards are also swept on the insert
+        void                        sweep ();
+
+        [[nodiscard]] const rate_limit_config_t &get_config () const;
+        [[nodiscard]] size_t        get_rejected () const;
+    private:
+        struct key_hash_t {
+            size_t operator() (const key_t &key) const;
+        };
+
+        struct bucket_t {
+            double                                  tokens      = 0;
+            std::chrono::steady_clock::time_point   updated;
+            size_t                                  connections = 0;
+        };
+
+        struct shard_t {
+            std::mutex                              mutex;
+            std::unordered_map<key_t, bucket_t, key_hash_t>
+                                                    buckets;
+            // the addresses which are not in the full table
+            bucket_t                                overflow;
+            std::chrono::steady_clock::time_point   swept;
+        };
+
+        static constexpr size_t                     shards_count = 64;
+
+        static key_t                                subnet (const key_t &key);
+        static bool                                 take (bucket_t &bucket, const double &rate, const double &burst, const double &cost, const std::chrono::steady_clock::time_point &now);
+        // nullptr -> the table is full (shard.overflow)
+        bucket_t                                    *find (shard_t &shard, const key_t &key, const double &burst, const std::chrono::steady_clock::time_point &now);
+        shard_t                                     &shard (const key_t &key);
+        void                                        sweep (shard_t &shard, const std::chrono::steady_clock::time_point &now) const;
+
+        rate_limit_config_t                         config;
+        size_t                                      shard_entries;
+
+        std::array<shard_t, shards_count>           shards;
+
+        std::atomic<size_t>                         rejected    = 0;
+    };
+}
+
+#endif //MANAPIRATELIMIT_HPP
@@ -12,6 +12,9 @@
 #include "ManapiTimerPool.hpp"
 #include "ManapiCompress.hpp"
 #include "ManapiThreadSafe.hpp"
+#include "ManapiHttpCache.hpp"
+#include "ManapiRateLimit.hpp"
+#include "ManapiMetrics.hpp"
 
 #include "ManapiHttpRequest.hpp"
 #include "ManapiHttpResponse.hpp"
@@ -30,6 +33,10 @@ namespace manapi::net {
         quiche_h3_conn          *http3;
         sockaddr_storage        peer_addr;
         socklen_t               peer_addr_len;
+        size_t                  max_datagram_size;
+        // the egress packet of max_datagram_size, quiche_conn_send is serialized per connection
+        std::unique_ptr<uint8_t[]>
+                                out;
         size_t                  timer_id;
         std::string             key;
         bool                    is_deleting = false;
@@ -51,6 +58,13 @@ namespace manapi::net {
 
         std::unique_ptr<const json_mask> post_mask = nullptr;
         std::unique_ptr<const json_mask> get_mask = nullptr;
+
+        // the responses of the page, nullptr -> the handler is called every time
+        std::unique_ptr<http_response_cache> cache = nullptr;
+        // the requests of the client to the page
+        std::unique_ptr<rate_limiter> limiter = nullptr;
+        // the latency of the page, owned by the metrics of the site
+        metrics::histogram *latency = nullptr;
     };
 
     typedef std::map<std::string, std::unique_ptr<http_uri_part>>   handlers_map_t;
@@ -97,7 +111,12 @@ namespace manapi::net {
         void                                remove_timer (const size_t &id);
 
         http_uri_part                       *set_handler (const std::string &method, const std::string &uri, const handler_template_t &handler, const json_mask &get_mask = nullptr, const json_mask &post_mask = nullptr);
+        http_uri_part                       *set_handler (const std::string &method, const std::string &uri, const handler_template_t &handler, const http_cache_config_t &cache, const json_mask &get_mask = nullptr, const json_mask &post_mask = nullptr);
         http_uri_part                       *set_handler (const std::string &method, const std::string &uri, const std::string &folder);
+        // the page must be added before
+        void                                set_rate_limit (const std::string &method, const std::string &uri, const rate_limit_config_t &limit);
+        // the GET page with the metrics in the Prometheus text format
+        void                                enable_metrics (const std::string &uri = "/metrics");
 
         http_handler_page                   get_handler (request_data_t &request_data) const;
 
@@ -117,6 +136,8 @@ namespace manapi::net {
         void                                tasks_pool_stop ();
         void                                tasks_pool_init (const size_t &thread_num);
 
+        metrics::registry                   &get_metrics ();
+
         std::string                         config_cache_dir;
     protected:
         void                                setup ();
@@ -133,6 +154,8 @@ namespace manapi::net {
         http_uri_part                       *build_uri_part (const std::string &uri, size_t &type);
         std::unique_ptr<utils::timerpool>   timerpool;
 
+        metrics::registry                   metrics_registry;
+
         manapi::json                 cache_config;
 
         std::string                         config_path = "/tmp/http.json";
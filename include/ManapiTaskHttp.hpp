@@ -9,13 +9,18 @@
 #include "ManapiUtils.hpp"
 #include "ManapiHttpTypes.hpp"
 #include "ManapiSite.hpp"
+#include "ManapiTrace.hpp"
 
 #include "ManapiHttpResponse.hpp"
 #include "ManapiHttpRequest.hpp"
 
+#include "http2/ManapiHttp2.hpp"
+
 namespace manapi::net {
 #define MANAPI_HTTP_BUFF_BINARY 0
 #define MANAPI_HTTP_BUFF_FILE   1
+// max bytes in the pipe per splice(2)
+#define MANAPI_HTTP_SPLICE_SIZE 65536
 
 #define MANAPI_HTTP_READ_INTERFACE std::function<ssize_t(char *buff, const size_t &buff_size)>
 #define MANAPI_HTTP_WRITE_INTERFACE std::function<ssize_t(const char *buff, const size_t &buff_size)>
@@ -29,7 +34,18 @@ namespace manapi::net {
 
     enum conn_type {
         CONN_UDP = 0,
-        CONN_TCP = 1
+        CONN_TCP = 1,
+        // the stream of the HTTP/2 connection
+        CONN_H2  = 2
+    };
+
+    enum tcp_prepare_status {
+        TCP_PREPARE_DONE        = 0,
+        TCP_PREPARE_WANT_READ   = 1,
+        TCP_PREPARE_WANT_WRITE  = 2,
+        TCP_PREPARE_FAILED      = 3,
+        // the async job of OpenSSL is paused (SSL_MODE_ASYNC with an async engine)
+        TCP_PREPARE_WANT_ASYNC  = 4
     };
 
     class http_task : public task {
@@ -43,6 +59,26 @@ namespace manapi::net {
         void                    doit() override;
 
         void                    send_response           (http_response &res);
+
+        /**
+         * called by the event loop of the pool on the non-blocking socket,
+         * the task is dispatched to the threadpool after TCP_PREPARE_DONE
+         * @return tcp_prepare_status
+         */
+        int                     tcp_prepare             ();
+        void                    tcp_close               ();
+        // the connection of the client is counted by the limiter until the task is deleted
+        void                    set_conn_limiter        (const std::shared_ptr<rate_limiter> &limiter, const rate_limiter::key_t &key);
+        // the http2 connection is counted until the task is deleted
+        void                    set_h2_connections      (const std::shared_ptr<std::atomic<size_t> > &counter);
+        [[nodiscard]] bool      is_tcp_handshaked       () const;
+        // the HTTP/2 connection reads the socket until it is closed
+        [[nodiscard]] bool      is_tcp_h2               () const;
+
+        // plain TCP without the buffered bytes
+        [[nodiscard]] bool      can_splice              () const;
+        // moves size bytes of the socket to fd through the pipe without the user-space copies
+        void                    tcp_splice              (const int &fd, const size_t &size);
         static size_t           read_next_part          (size_t &size, size_t &i, void *_http_task, request_data_t *request_data);
 
         // TODO: resolve
@@ -53,6 +89,8 @@ namespace manapi::net {
         static std::unique_ptr<manapi::net::http_quic_conn_io> &quic_create_connection (uint8_t *s_cid, size_t s_cid_len, uint8_t *od_cid, size_t od_cid_len, const int &conn_fd, const sockaddr_storage &client, const socklen_t &client_len, class config *config, class site *site, quic_map_conns_t *quic_map_conns);
         static int              quic_get_header         (uint8_t *name, size_t name_len, uint8_t *value, size_t value_len, void *argp);
         static void             quic_flush_egress       (quic_map_conns_t *conns, manapi::net::http_quic_conn_io *conn_io, class site *site);
+        // the connection is closed, quiche_stats -> the metrics of the site
+        static void             quic_closed_metrics     (class site *site, const quiche_stats &stats, const quiche_path_stats &path_stats);
         static void             quic_delete_conn_io     (manapi::net::http_quic_conn_io *conn_io, class site *site);
 /**
          * to_delete -> true
@@ -70,10 +108,10 @@ namespace manapi::net {
         void                    tcp_stringify_http_info (std::string &response, http_response &res, char *delimiter) const;
 
         // I/O
-        ssize_t                 socket_read             (char *buff, const size_t &buff_size) const;
+        ssize_t                 socket_read             (char *buff, const size_t &buff_size);
         ssize_t                 socket_write            (const char *buff, const size_t &buff_size) const;
 
-        ssize_t                 openssl_read            (char *buff, const size_t &buff_size) const;
+        ssize_t                 openssl_read            (char *buff, const size_t &buff_size);
         ssize_t                 openssl_write           (const char *buff, const size_t &buff_size) const;
 
         static void             quic_generate_output_packages (quic_map_conns_t *quic_map_conns, class site *site);
@@ -89,16 +127,37 @@ namespace manapi::net {
         void                    *buff;
         ssize_t                 buff_size;
         size_t                  buff_type = MANAPI_HTTP_BUFF_BINARY;
+        // the owner of buff, nullptr -> the heap
+        std::shared_ptr<utils::buffer_pool>
+                                buff_pool;
+
+        // the objects of the config are loaded once per task (the atomic loads of shared_ptr take a lock)
+        std::shared_ptr<rate_limiter>
+                                limiter;
+        std::shared_ptr<access_log>
+                                access;
+#ifdef MANAPI_HTTP_TRACING
+        std::shared_ptr<tracer>
+                                request_tracer;
+#endif
 
         SSL                     *ssl = nullptr;
 
         struct http_quic_conn_io*conn_io = nullptr;
         int64_t                 stream_id = -1;
+
+        std::shared_ptr<http2::connection>  h2_conn = nullptr;
     private:
+        friend class http2::connection;
+        // the microbenchmarks of the parser (bench/)
+        friend struct http_task_bench;
+
         void                    tcp_doit ();
         void                    udp_doit ();
+        void                    h2_doit ();
 
         bool                    socket_wait_select () const;
+        bool                    socket_wait_write () const;
         // QUIC
 
 
@@ -106,14 +165,35 @@ namespace manapi::net {
         // TCP
         void                    tcp_parse_request_response (char *response, const size_t &size, size_t &i);
         ssize_t                 tcp_send_response (http_response &res);
+        int                     tcp_read_early_data ();
+        int                     tcp_ssl_status (const int &res) const;
+        bool                    tcp_head_received (const size_t &offset);
+        size_t                  tcp_read_head_data (char *part_buff, const size_t &part_buff_size);
+        // the requests in 0-RTT can be replayed
+        static bool             is_safe_early_method (const std::string &method);
 
         std::string             compress_file (const std::string &file, const std::string &folder, const std::string &compress, manapi::net::utils::compress::TEMPLATE_INTERFACE compressor) const;
 
         void                    send_text (const std::string &text, const size_t &size) const;
+        void                    send_block (const char *data, const size_t &size) const;
+        // the head of the response is already sent: the connection (TCP) or the stream is closed without the end
+        void                    abort_stream ();
         void                    send_file (http_response &res, std::ifstream &f, ssize_t size, std::vector<utils::replace_founded_item> &replacers) const;
         void                    send_file (http_response &res, std::ifstream &f, ssize_t size) const;
 
         void                    handle_request (const http_handler_page *data, const size_t &status = 200, const std::string &message = HTTP_STATUS.OK_200);
+        void                    send_cached_response (const http_cache_entry_t &entry);
+        // the pool limiter for the streams (h2, h3) and the limiter of the route
+        bool                    is_rate_limited (const http_handler_page *data) const;
+        void                    cache_response (http_response &res, const std::string &body);
+        // the record of the response in the access log of the pool
+        void                    log_access (http_response &res);
+#ifdef MANAPI_HTTP_TRACING
+        // Server-Timing, before the head of the response is sent
+        void                    trace_response_head (http_response &res);
+        // the spans of the sent response -> the trace file
+        void                    trace_finish (http_response &res);
+#endif
         static void             execute_custom_handler (const http_handler_page *handler, http_request &req, http_response &resp);
         void                    send_error_response (const size_t &status, const std::string &message, const http_handler_page *error);
 
@@ -156,6 +236,38 @@ namespace manapi::net {
 
         file_transfer_information fti;
 
+        // TLS 1.3 0-RTT data received before the handshake is finished
+        std::string             early_data;
+        // the data read by tcp_prepare, it is drained before the socket
+        std::string             head_data;
+
+        // the current size of the head reads
+        size_t                  tcp_read_size       = 0;
+        bool                    tcp_handshaked      = false;
+        bool                    tcp_early_finished  = false;
+        bool                    tcp_h2              = false;
+        bool                    early_request       = false;
+        // HTTP/3: the stream is reset, the body is not finished
+        bool                    stream_aborted      = false;
+
+        std::shared_ptr<rate_limiter>
+                                conn_limiter;
+        rate_limiter::key_t     conn_key;
+
+        std::shared_ptr<std::atomic<size_t> >
+                                h2_connections;
+
+        // the response of the request builds the entry of the cache
+        http_response_cache     *cache_lead         = nullptr;
+        std::string             cache_key;
+
+        // the first handle_request () of the task
+        std::chrono::steady_clock::time_point
+                                request_started     = {};
+
+#ifdef MANAPI_HTTP_TRACING
+        trace_spans             spans;
+#endif
     };
 }
 
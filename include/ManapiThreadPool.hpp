@@ -11,6 +11,10 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace manapi::net {
     template <class T>
@@ -23,13 +27,40 @@ namespace manapi::net {
         void stop();
         size_t get_count_stopped_task ();
         bool all_tasks_stopped ();
+        // blocks until the workers exit (after stop ())
+        void wait_stopped ();
+
+        // CoDel: the level is overloaded when the sojourn time of its tasks stays above the target for the interval, 0 -> disabled
+        void set_admission (const std::chrono::milliseconds &target, const std::chrono::milliseconds &interval);
+        [[nodiscard]] bool is_overloaded (const size_t &level) const;
+        // the time in the queue of the last task of the level
+        [[nodiscard]] std::chrono::nanoseconds get_sojourn (const size_t &level) const;
+        [[nodiscard]] size_t get_queue_size (const size_t &level) const;
+        [[nodiscard]] size_t get_queues_count () const;
     private:
+        struct queued_task_t {
+            std::unique_ptr<T> task;
+            std::chrono::steady_clock::time_point queued;
+        };
+
+        struct level_state_t {
+            // the sojourn time is above the target since this time + interval
+            std::chrono::steady_clock::time_point first_above {};
+            std::atomic<bool> overloaded = false;
+            std::atomic<int64_t> sojourn = 0;
+            std::atomic<size_t> size = 0;
+        };
+
         // this number means count of the all threads
         size_t thread_number;
         // this vector contains all threads for this thread pool
         std::vector <std::thread> all_threads;
         // this vector of queue which contains tasks
-        std::vector <std::deque<std::unique_ptr<T> > > task_queues;
+        std::vector <std::deque<queued_task_t> > task_queues;
+        // the admission state of the queues
+        std::unique_ptr<level_state_t[]> levels;
+        std::atomic<int64_t> admission_target = 0;
+        std::atomic<int64_t> admission_interval = 0;
         // queue mutex
         std::mutex queue_mutex;
         // the function that the thread runs. Execute run() function
@@ -38,11 +69,15 @@ namespace manapi::net {
         // execute the task
         void task_doit (std::unique_ptr<T> task);
         std::unique_ptr<T> getTask();
+        // under the queue mutex
+        void update_admission (level_state_t &state, const std::chrono::steady_clock::time_point &queued, const bool &empty);
         bool is_stop;
 
         sigset_t blockedSignal{};
         std::mutex m;
         std::condition_variable cv;
+        // the workers signal it as they exit
+        std::condition_variable cv_stopped;
 
         std::atomic<size_t> stopped;
     };
@@ -8,6 +8,7 @@
 
 #include "ManapiThreadPool.hpp"
 #include "ManapiTask.hpp"
+#include "ManapiMetrics.hpp"
 
 namespace manapi::net::utils {
     struct timer_task {
@@ -16,7 +17,7 @@ namespace manapi::net::utils {
     };
     class timerpool : public net::task {
     public:
-        explicit timerpool(net::threadpool<net::task> &threadpool, const size_t &delay = 50);
+        explicit timerpool(net::threadpool<net::task> &threadpool, const size_t &delay = 50, metrics::histogram *lag = nullptr);
         ~timerpool();
         size_t append_timer (const std::chrono::milliseconds &duration, const std::function<void()> &task);
         void remove_timer (const size_t &id);
@@ -30,6 +31,8 @@ namespace manapi::net::utils {
         size_t index = 1;
         bool is_stop = false;
         size_t delay{};
+        // the time from the deadline until the task is started, nullptr -> not measured
+        metrics::histogram *lag = nullptr;
     private:
     };
 }
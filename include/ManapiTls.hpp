@@ -0,0 +1,120 @@
+#ifndef MANAPITLS_HPP
+#define MANAPITLS_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <shared_mutex>
+#include <openssl/ssl.h>
+
+#include "ManapiHttpConfig.hpp"
+#include "ManapiThreadPool.hpp"
+#include "ManapiTask.hpp"
+
+#define MANAPI_TLS_TICKET_KEY_NAME_LEN 16
+
+namespace manapi::net::tls {
+    /**
+     * session ticket keys shared by all TLS pools of the process,
+     * so a ticket from one pool resumes the session in another one
+     */
+    class ticket_keys {
+    public:
+        static ticket_keys          &shared ();
+
+        /**
+         * generates the new key if the current one is older than interval
+         * @param max_keys the count of the keys which can decrypt the tickets
+         */
+        void                        rotate (const std::chrono::seconds &interval, const size_t &max_keys);
+
+        // SSL_CTX_set_tlsext_ticket_key_evp_cb
+        static int                  callback (SSL *ssl, unsigned char *key_name, unsigned char *iv, EVP_CIPHER_CTX *ctx, EVP_MAC_CTX *hctx, int enc);
+    private:
+        struct key_t {
+            unsigned char           name[MANAPI_TLS_TICKET_KEY_NAME_LEN];
+            unsigned char           aes_key[32];
+            unsigned char           hmac_key[32];
+        };
+
+        ticket_keys ();
+
+        void                        generate ();
+
+        // the front key encrypts the new tickets
+        std::deque<key_t>           keys;
+        std::chrono::steady_clock::time_point
+                                    created;
+        std::shared_mutex           mutex;
+    };
+
+    /**
+     * keeps the OCSP response for the certificate of the context
+     * and staples it to the handshakes
+     */
+    class ocsp_stapler {
+    public:
+        explicit ocsp_stapler (const ocsp_config_t &config);
+        ~ocsp_stapler ();
+
+        // loads the certificate and its issuer from the context
+        void                        attach (SSL_CTX *ctx);
+
+        // loads the new response from the file or the responder, keeps the old one on failure
+        void                        refresh ();
+
+        // SSL_CTX_set_tlsext_status_cb
+        static int                  callback (SSL *ssl, void *arg);
+    private:
+        std::string                 request_responder (const std::string &request) const;
+
+        ocsp_config_t               config;
+
+        X509                        *cert       = nullptr;
+        X509                        *issuer     = nullptr;
+        std::string                 url;
+
+        std::string                 response;
+        std::chrono::system_clock::time_point
+                                    next_update;
+        std::mutex                  mutex;
+    };
+
+    struct crypto_stats_t {
+        // the handshake steps waiting for the thread
+        size_t                      queued;
+        size_t                      max_queued;
+        size_t                      completed;
+        // dropped because the queue is full
+        size_t                      rejected;
+    };
+
+    /**
+     * the bounded threadpool for the handshakes (the private key operations),
+     * so the bursts of the handshakes do not block the loop and the request workers
+     */
+    class crypto_pool {
+    public:
+        crypto_pool (const size_t &threads, const size_t &max_queued);
+        ~crypto_pool ();
+
+        // false -> the queue is full
+        bool                        append (const std::function<void()> &job);
+        void                        stop ();
+
+        [[nodiscard]] crypto_stats_t get_stats () const;
+    private:
+        std::unique_ptr<threadpool<task> >
+                                    pool;
+        size_t                      max_queued;
+
+        std::atomic<size_t>         queued      = 0;
+        std::atomic<size_t>         max_seen    = 0;
+        std::atomic<size_t>         completed   = 0;
+        std::atomic<size_t>         rejected    = 0;
+    };
+}
+
+#endif //MANAPITLS_HPP
@@ -0,0 +1,115 @@
+#ifndef MANAPITRACE_HPP
+#define MANAPITRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// the phases are measured only in the builds with MANAPI_HTTP_TRACING (cmake ... -DMANAPI_HTTP_TRACING=ON),
+// the other builds do not have the timestamps in the tasks
+#ifdef MANAPI_HTTP_TRACING
+#define MANAPI_TRACE_BEGIN(_spans, _phase)  (_spans).begin(_phase)
+#define MANAPI_TRACE_END(_spans, _phase)    (_spans).end(_phase)
+#else
+#define MANAPI_TRACE_BEGIN(_spans, _phase)  ((void) 0)
+#define MANAPI_TRACE_END(_spans, _phase)    ((void) 0)
+#endif
+
+namespace manapi::net {
+    enum trace_phase_t {
+        TRACE_HANDSHAKE = 0,
+        // the reads of the request head
+        TRACE_HEAD,
+        // the task is waiting for the worker
+        TRACE_QUEUE,
+        TRACE_PARSE,
+        // get_handler ()
+        TRACE_ROUTE,
+        TRACE_LAYERS,
+        TRACE_HANDLER,
+        TRACE_COMPRESS,
+        // the head and the body of the response
+        TRACE_SEND,
+        TRACE_PHASES_COUNT
+    };
+
+    struct trace_config_t {
+        bool                        enabled         = false;
+        // the finished phases in the Server-Timing header of the response
+        bool                        server_timing   = true;
+        // the Chrome trace (chrome://tracing, Perfetto), empty -> not written
+        std::string                 file;
+        // every N-th request of the thread is written to the file, 1 -> all
+        size_t                      sample          = 1;
+    };
+
+    /**
+     * the steady clock timestamps (ns) of the phases of one request,
+     * the first begin () of the phase is kept (the handshake and the head are continued by the event loop)
+     */
+    class trace_spans {
+    public:
+        trace_spans ();
+
+        void                        begin (const trace_phase_t &phase);
+        void                        end (const trace_phase_t &phase);
+
+        // the time of the task creation (accept or the new stream)
+        [[nodiscard]] int64_t       get_created () const;
+        // 0 -> the phase was not finished
+        [[nodiscard]] int64_t       get_begin (const trace_phase_t &phase) const;
+        [[nodiscard]] int64_t       get_duration (const trace_phase_t &phase) const;
+
+        // handshake;dur=0.412, route;dur=0.003, ..., total;dur=1.53
+        [[nodiscard]] std::string   server_timing () const;
+
+        static int64_t              now ();
+        static const char           *name (const trace_phase_t &phase);
+    private:
+        int64_t                     created;
+
+        std::array<int64_t, TRACE_PHASES_COUNT>
+                                    begins          {};
+        std::array<int64_t, TRACE_PHASES_COUNT>
+                                    ends            {};
+    };
+
+    /**
+     * the file of the trace events (JSON array format), the request is the track with its phases
+     */
+    class tracer {
+    public:
+        explicit tracer (trace_config_t config);
+        ~tracer ();
+
+        // false -> the request is not written to the file
+        [[nodiscard]] bool          sampled () const;
+        void                        append (const trace_spans &spans, const std::string_view &method, const std::string_view &uri, const size_t &status);
+
+        // writes the buffer and closes the array
+        void                        stop ();
+
+        [[nodiscard]] const trace_config_t &get_config () const;
+    private:
+        // the events are written by the blocks
+        static constexpr size_t     block_size      = 64 * 1024;
+
+        void                        write_buffer ();
+
+        trace_config_t              config;
+
+        std::mutex                  mutex;
+        std::string                 buffer;
+        int                         fd              = -1;
+        bool                        first           = true;
+        int                         pid;
+
+        std::atomic<size_t>         next_id         = 1;
+    };
+}
+
+#endif //MANAPITRACE_HPP
@@ -11,13 +11,20 @@
 #include <fstream>
 #include <unistd.h>
 #include <atomic>
+#include <string_view>
 
 #include "ManapiHttpTypes.hpp"
 #include "ManapiBeforeDelete.hpp"
 #include "ManapiJson.hpp"
+#include "ManapiLogger.hpp"
 
+#if MANAPI_LOG_LEVEL <= MANAPI_LOG_LEVEL_DEBUG
 #define MANAPI_LOG(msg, ...)                manapi::net::utils::_log (__LINE__, __FILE_NAME__, __FUNCTION__, false, manapi::net::ERR_DEBUG, msg, __VA_ARGS__)
 #define MANAPI_LOG2(msg)                    manapi::net::utils::_log (__LINE__, __FILE_NAME__, __FUNCTION__, false, manapi::net::ERR_DEBUG, msg);
+#else
+#define MANAPI_LOG(msg, ...)                ((void) 0)
+#define MANAPI_LOG2(msg)                    ((void) 0);
+#endif
 
 //#define THROW_MANAPI_EXCEPTION(msg, ...)    manapi::net::utils::_log (__LINE__, __FILE_NAME__, __FUNCTION__, true, manapi::net::ERR_UNDEFINED, msg, __VA_ARGS__)
 //#define THROW_MANAPI_EXCEPTION2(msg, ...)    manapi::net::utils::_log (__LINE__, __FILE_NAME__, __FUNCTION__, true, manapi::net::ERR_UNDEFINED, msg)
@@ -29,6 +36,7 @@
 #define MANAPI_HTTP_RESP_FILE 1
 #define MANAPI_HTTP_RESP_PROXY 2
 #define MANAPIHTTP_RESP_NO_DATA 3
+#define MANAPI_HTTP_RESP_STREAM 4
 
 #define REQ(_x) manapi::net::http_request &_x
 #define RESP(_x) manapi::net::http_response &_x
@@ -92,7 +100,8 @@ namespace manapi::net::utils {
     std::string     generate_cache_name (const std::string &basename, const std::string &ext);
 
     std::string     encode_url          (const std::string &str);
-    std::string     decode_url          (const std::string &str);
+    // %XX and '+' -> ' ', the invalid escapes are kept as is
+    std::string     decode_url          (std::string_view str);
     std::string     json2form           (const json &obj);
 
     const std::string     &mime_by_file_path  (const std::string &path);
@@ -125,6 +134,38 @@ namespace manapi::net::utils {
         std::string message;
     };
 
+    /**
+     * application/x-www-form-urlencoded data and query strings, the pairs are views into the source,
+     * the values are decoded on the first access. The source must outlive the object
+     */
+    class url_params {
+    public:
+        explicit url_params (std::string_view data);
+
+        [[nodiscard]] bool              contains (std::string_view name) const;
+        // the first value of the param, nullptr -> no param
+        [[nodiscard]] const std::string *find (std::string_view name) const;
+        // all values of the repeated param
+        [[nodiscard]] VEC_STR           find_all (std::string_view name) const;
+        // the repeated params -> the first value
+        [[nodiscard]] MAP_STR_STR       to_map () const;
+        [[nodiscard]] size_t            size () const;
+    private:
+        struct item_t {
+            std::string_view            key;
+            std::string_view            value;
+            // the decoded key if it has escapes
+            std::string                 key_decoded;
+            mutable std::string         value_decoded;
+            mutable bool                decoded     = false;
+
+            [[nodiscard]] std::string_view name () const;
+            [[nodiscard]] const std::string &get () const;
+        };
+
+        std::vector <item_t>            items;
+    };
+
     // ====================[ Strings ]===============================
 
     std::string     str32to4    (const std::u32string &str32);
@@ -140,24 +181,35 @@ namespace manapi::net::utils {
 
     const std::string &get_msg_by_err_num (const err_num &errnum);
     template <class... Args>
-    void _log               (const size_t &line, const std::string &file_name, const std::string &func, const bool &except, const err_num &errnum, const std::string &format, Args&& ...args)
+    void _log               (const size_t &line, const char *file_name, const char *func, const bool &except, const err_num &errnum, const std::string &format, Args&& ...args)
     {
-        const auto head = std::format ("[{}][{}]: {}() ({}:{}): ", utils::time("%H:%M:%S", true), static_cast<size_t>(errnum), func, file_name, line);
-        const auto information = std::vformat(format, std::make_format_args(args...));
+        auto &log = logger::shared();
+        uint32_t suppressed;
 
         if (except)
         {
-            std::cerr << head << information << "\n";
-        }
-        else
-        {
-            std::cout << head << information << "\n";
+            auto information = std::vformat(format, std::make_format_args(args...));
+
+            if (MANAPI_LOG_LEVEL <= MANAPI_LOG_LEVEL_ERROR && log.allow(file_name, line, suppressed))
+            {
+                log.write(LOG_ERROR, errnum, line, file_name, func, suppressed, information);
+            }
+
+            throw manapi::net::utils::exception (errnum, std::move(information));
         }
 
-        if (except)
+        if (!log.allow(file_name, line, suppressed))
         {
-            throw manapi::net::utils::exception (errnum, information);
+            return;
         }
+
+        // the capacity is reused by the next messages of the thread
+        static thread_local std::string information;
+
+        information.clear();
+        std::vformat_to(std::back_inserter(information), format, std::make_format_args(args...));
+
+        log.write(LOG_DEBUG, errnum, line, file_name, func, suppressed, information);
     }
 
     inline size_t debug_print_memory (const std::string &title = "common")
@@ -194,12 +246,12 @@ struct std::hash <manapi::net::utils::manapi_socket_information>
 namespace manapi::net {
     struct request_data_t {
         // size of the part of the headers in the buffer (READ) [HHHH]BBBBBBB <- 4
-        size_t                              headers_part;
-        size_t                              headers_size;
+        size_t                              headers_part    = 0;
+        size_t                              headers_size    = 0;
         // just headers
-        std::map<std::string, std::string>  headers;
+        utils::MAP_STR_STR                  headers;
         // contains params from url .../[param1]-[param2]/...
-        std::map<std::string, std::string>  params;
+        utils::MAP_STR_STR                  params;
 
         // GET, POST, HEAD
         std::string                         method;
@@ -210,14 +262,15 @@ namespace manapi::net {
         // split by '/'
         std::vector <std::string>           path;
         // index of the element where URL get params in the path
-        ssize_t                             divided;
+        ssize_t                             divided         = -1;
 
-        char*                               body_ptr;
-        size_t                              body_index;
-        size_t                              body_left;
-        size_t                              body_size;
+        char*                               body_ptr        = nullptr;
+        size_t                              body_index      = 0;
+        size_t                              body_left       = 0;
+        // SIZE_MAX -> the body is read until the end of the stream (HTTP/2 without the content-length)
+        size_t                              body_size       = 0;
         // size of the part of the body in the buffer (READ) HHHH[BBBBB] <- 5
-        size_t                              body_part;
+        size_t                              body_part       = 0;
 
         bool                                has_body    = false;
     };
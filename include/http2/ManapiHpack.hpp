@@ -0,0 +1,75 @@
+#ifndef MANAPIHPACK_HPP
+#define MANAPIHPACK_HPP
+
+#include <string>
+#include <deque>
+#include <cstdint>
+#include <functional>
+
+namespace manapi::net::http2 {
+    typedef std::function<void(std::string &&name, std::string &&value)> hpack_header_cb_t;
+
+    struct hpack_entry {
+        std::string     name;
+        std::string     value;
+    };
+
+    /**
+     * HPACK (RFC 7541) header block decoder. One decoder per connection,
+     * header blocks must be decoded in the order they were received.
+     */
+    class hpack_decoder {
+    public:
+        explicit hpack_decoder (const size_t &max_table_size = 4096);
+
+        /**
+         * decodes the full header block (HEADERS + CONTINUATION payloads)
+         * @throws manapi::net::utils::exception ERR_HTTP_PROTOCOL_ERROR on a compression error
+         */
+        void                        decode (const uint8_t *data, const size_t &size, const hpack_header_cb_t &callback);
+
+        [[nodiscard]] const size_t  &get_max_table_size () const;
+    private:
+        const hpack_entry           &get_entry (const size_t &index) const;
+        void                        insert (std::string &&name, std::string &&value);
+        void                        evict (const size_t &capacity);
+
+        std::deque<hpack_entry>     table;
+        // the size of the dynamic table (RFC 7541 4.1)
+        size_t                      table_size      = 0;
+        // the current limit set by the peer with a dynamic table size update
+        size_t                      table_capacity;
+        // the limit announced in SETTINGS_HEADER_TABLE_SIZE
+        size_t                      max_table_size;
+    };
+
+    /**
+     * HPACK header block encoder. The encoder never inserts into the dynamic table,
+     * so the header blocks of the different streams can be sent in any order.
+     */
+    class hpack_encoder {
+    public:
+        static void                 encode_status (std::string &out, const size_t &status);
+        static void                 encode (std::string &out, const std::string &name, const std::string &value);
+    };
+
+    namespace hpack {
+        size_t                      decode_integer (const uint8_t *&ptr, const uint8_t *end, const uint8_t &prefix);
+        void                        encode_integer (std::string &out, const uint8_t &flags, const uint8_t &prefix, size_t value);
+
+        void                        decode_string (std::string &out, const uint8_t *&ptr, const uint8_t *end);
+        void                        encode_string (std::string &out, const std::string &str);
+
+        void                        huffman_decode (std::string &out, const uint8_t *data, const size_t &size);
+        void                        huffman_encode (std::string &out, const std::string &str);
+        size_t                      huffman_encoded_size (const std::string &str);
+
+        /**
+         * @param full_match true if the name and the value are matched
+         * @return the index in the static table or 0 if the name is not found
+         */
+        size_t                      static_table_find (const std::string &name, const std::string &value, bool &full_match);
+    }
+}
+
+#endif //MANAPIHPACK_HPP
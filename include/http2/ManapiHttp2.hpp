@@ -0,0 +1,216 @@
+#ifndef MANAPIHTTP2_HPP
+#define MANAPIHTTP2_HPP
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <condition_variable>
+#include <openssl/ssl.h>
+
+#include "ManapiHttpConfig.hpp"
+#include "ManapiHttpResponse.hpp"
+#include "http2/ManapiHpack.hpp"
+
+#define MANAPI_HTTP2_PREFACE            "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define MANAPI_HTTP2_PREFACE_LEN        (sizeof (MANAPI_HTTP2_PREFACE) - 1)
+#define MANAPI_HTTP2_FRAME_HEADER_LEN   9
+#define MANAPI_HTTP2_DEFAULT_WINDOW     65535
+#define MANAPI_HTTP2_MAX_WINDOW         0x7fffffff
+
+namespace manapi::net {
+    class http_task;
+    class site;
+}
+
+namespace manapi::net::http2 {
+    namespace frame {
+        enum {
+            DATA            = 0x0,
+            HEADERS         = 0x1,
+            PRIORITY        = 0x2,
+            RST_STREAM      = 0x3,
+            SETTINGS        = 0x4,
+            PUSH_PROMISE    = 0x5,
+            PING            = 0x6,
+            GOAWAY          = 0x7,
+            WINDOW_UPDATE   = 0x8,
+            CONTINUATION    = 0x9
+        };
+    }
+
+    namespace flags {
+        enum {
+            END_STREAM      = 0x1,
+            ACK             = 0x1,
+            END_HEADERS     = 0x4,
+            PADDED          = 0x8,
+            PRIORITY        = 0x20
+        };
+    }
+
+    namespace settings {
+        enum {
+            HEADER_TABLE_SIZE       = 0x1,
+            ENABLE_PUSH             = 0x2,
+            MAX_CONCURRENT_STREAMS  = 0x3,
+            INITIAL_WINDOW_SIZE     = 0x4,
+            MAX_FRAME_SIZE          = 0x5,
+            MAX_HEADER_LIST_SIZE    = 0x6
+        };
+    }
+
+    namespace errors {
+        enum {
+            NO_ERROR            = 0x0,
+            PROTOCOL_ERROR      = 0x1,
+            INTERNAL_ERROR      = 0x2,
+            FLOW_CONTROL_ERROR  = 0x3,
+            SETTINGS_TIMEOUT    = 0x4,
+            STREAM_CLOSED       = 0x5,
+            FRAME_SIZE_ERROR    = 0x6,
+            REFUSED_STREAM      = 0x7,
+            CANCEL              = 0x8,
+            COMPRESSION_ERROR   = 0x9,
+            CONNECT_ERROR       = 0xa,
+            ENHANCE_YOUR_CALM   = 0xb
+        };
+    }
+
+    struct stream {
+        uint32_t            id;
+
+        // priority (RFC 9113 5.3), the weight in the range [1, 256]
+        uint32_t            dependency      = 0;
+        uint16_t            weight          = 16;
+        bool                exclusive       = false;
+
+        // the peer side
+        std::string         recv_buffer;
+        size_t              recv_offset     = 0;
+        int64_t             recv_window;
+        size_t              recv_unacked    = 0;
+        // the declared content-length, -1 -> the body ends with END_STREAM (RFC 9113 8.1.1)
+        ssize_t             content_length  = -1;
+        size_t              recv_total      = 0;
+        bool                remote_closed   = false;
+
+        // our side
+        int64_t             send_window;
+        bool                headers_sent    = false;
+        bool                local_closed    = false;
+
+        bool                reset           = false;
+    };
+
+    /**
+     * HTTP/2 connection (RFC 9113) over the TLS pool connection.
+     * The connection thread reads the frames, each request is handled
+     * by the separate http_task (CONN_H2) in the tasks pool.
+     */
+    class connection : public std::enable_shared_from_this<connection> {
+    public:
+        connection (http_task *task, const int &fd, SSL *ssl, class site *site, class config *config);
+        ~connection ();
+
+        /**
+         * reads the frames until the connection is closed
+         * @param data the bytes already read from the connection (they must start with the preface)
+         */
+        void                        run (const char *data, const size_t &size);
+
+        static bool                 is_preface (const char *data, const size_t &size);
+
+        // stream I/O (the task threads)
+
+        ssize_t                     stream_read     (const uint32_t &id, char *buff, const size_t &size);
+        ssize_t                     stream_write    (const uint32_t &id, const char *buff, const size_t &size);
+        ssize_t                     stream_response (const uint32_t &id, http_response &res);
+        void                        stream_finish   (const uint32_t &id);
+        // RST_STREAM after the headers, stream_finish () does not send END_STREAM
+        void                        stream_reset    (const uint32_t &id, const uint32_t &code);
+    private:
+        // transport
+        bool                        wait_fd (const short &events, const size_t &timeout) const;
+        bool                        fill (const size_t &size);
+        void                        write_raw (const std::string &data);
+        void                        write_frame (const uint8_t &type, const uint8_t &flags, const uint32_t &id, const char *payload, const size_t &size);
+        static void                 append_frame_header (std::string &out, const size_t &size, const uint8_t &type, const uint8_t &flags, const uint32_t &id);
+
+        // frames
+        void                        on_frame (const uint8_t &type, const uint8_t &flags, const uint32_t &id, const uint8_t *payload, const size_t &size);
+        void                        on_data (const uint8_t &flags, const uint32_t &id, const uint8_t *payload, size_t size);
+        void                        on_headers (const uint8_t &flags, const uint32_t &id, const uint8_t *payload, size_t size);
+        void                        on_priority (const uint32_t &id, const uint8_t *payload);
+        void                        on_rst_stream (const uint32_t &id, const uint8_t *payload, const size_t &size);
+        void                        on_settings (const uint8_t &flags, const uint32_t &id, const uint8_t *payload, const size_t &size);
+        void                        on_ping (const uint8_t &flags, const uint32_t &id, const uint8_t *payload, const size_t &size);
+        void                        on_goaway (const uint32_t &id, const uint8_t *payload, const size_t &size);
+        void                        on_window_update (const uint32_t &id, const uint8_t *payload, const size_t &size);
+
+        void                        on_header_block (const uint32_t &id, const bool &end_stream);
+        // the HPACK errors are the connection errors (COMPRESSION_ERROR)
+        void                        decode_header_block (const std::string &block, const hpack_header_cb_t &callback);
+        void                        send_settings ();
+        void                        send_rst_stream (const uint32_t &id, const uint32_t &code);
+        void                        send_window_update (const uint32_t &id, const uint32_t &increment);
+        void                        send_goaway (const uint32_t &code);
+
+        // sends GOAWAY and throws the exception
+        void                        connection_error (const uint32_t &code, const std::string &message);
+
+        std::shared_ptr<stream>     get_stream (const uint32_t &id);
+        void                        close_stream (const uint32_t &id);
+        // under the mutex: the bytes left the connection window, returns the increment of WINDOW_UPDATE or 0
+        uint32_t                    consume (const size_t &size);
+
+        http_task                   *task;
+        class site                  *site;
+        class config                *config;
+
+        int                         fd;
+        SSL                         *ssl;
+
+        // the connection thread buffer
+        std::string                 in_buffer;
+        size_t                      in_offset           = 0;
+
+        // the header block (HEADERS + CONTINUATION)
+        std::string                 header_block;
+        uint32_t                    header_block_stream = 0;
+        bool                        header_block_end_stream = false;
+        // the priority from the HEADERS frame (RFC 9113 6.2)
+        std::string                 header_block_priority;
+        // the HEADERS frame came in 0-RTT, it can be replayed
+        bool                        header_block_early  = false;
+
+        // the bytes of 0-RTT which are not read yet
+        size_t                      early_left          = 0;
+        // the current frame starts in 0-RTT
+        bool                        frame_early         = false;
+
+        hpack_decoder               decoder;
+
+        // mutex for the streams and the windows
+        std::mutex                  mutex;
+        std::condition_variable     cv;
+        // mutex for the SSL object and the order of the frames
+        std::mutex                  io_mutex;
+
+        std::map<uint32_t, std::shared_ptr<stream>> streams;
+        uint32_t                    last_stream_id      = 0;
+
+        // peer settings
+        size_t                      peer_initial_window = MANAPI_HTTP2_DEFAULT_WINDOW;
+        size_t                      peer_max_frame_size = 16384;
+
+        int64_t                     send_window         = MANAPI_HTTP2_DEFAULT_WINDOW;
+        // the connection window is given back when the tasks consume the data
+        int64_t                     recv_window         = MANAPI_HTTP2_DEFAULT_WINDOW;
+        size_t                      recv_unacked        = 0;
+
+        bool                        goaway              = false;
+        bool                        closed              = false;
+    };
+}
+
+#endif //MANAPIHTTP2_HPP
@@ -307,6 +307,14 @@ namespace manapi {
 
 
         [[nodiscard]] std::string dump (const size_t &spaces = 0, const size_t &first_spaces = 0) const;
+        // the same text, appended to the buffer without the temporary strings of the nodes
+        void dump_to (std::string &out, const size_t &spaces = 0, const size_t &first_spaces = 0) const;
+
+        // "escaped"
+        static void                 dump_string (std::string &out, const STRING_VIEW &str);
+        static void                 dump_number (std::string &out, const NUMBER &num);
+        // 6 digits after the point (std::to_string)
+        static void                 dump_decimal (std::string &out, const DECIMAL &num);
 
         [[nodiscard]] size_t size () const;
 
@@ -0,0 +1,314 @@
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "ManapiAccessLog.hpp"
+#include "ManapiUtils.hpp"
+
+namespace manapi::net {
+    // the numbers of the threads spread them over the shards
+    static std::atomic<size_t>  access_log_next_thread  = 0;
+
+    static void access_log_escape (std::string &out, const std::string_view &value) {
+        for (const auto &c: value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20 || c == 0x7F)
+            {
+                out += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+}
+
+manapi::net::access_log::access_log(access_log_config_t config) : config (std::move(config)) {
+    json    = this->config.format == "json";
+
+    if (!json && this->config.format != "common")
+    {
+        THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid access_log.format: {}", this->config.format);
+    }
+
+    open_file();
+
+    buffers.resize(std::max<size_t>(std::thread::hardware_concurrency(), 1));
+
+    for (auto &buffer: buffers)
+    {
+        buffer = std::make_unique<buffer_t>();
+    }
+
+    writer = std::thread ([this] () -> void { run(); });
+}
+
+manapi::net::access_log::~access_log() {
+    stop();
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+bool manapi::net::access_log::sampled() const {
+    if (config.sample <= 1)
+    {
+        return true;
+    }
+
+    static thread_local size_t requests = 0;
+
+    return requests++ % config.sample == 0;
+}
+
+void manapi::net::access_log::append(const access_log_record_t &record) {
+    header_t header {
+        .time           = std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch()).count(),
+        .duration       = static_cast<uint64_t>(record.duration.count()),
+        .bytes          = record.bytes,
+        .status         = static_cast<uint32_t>(record.status),
+        .port           = record.port,
+        .ip_size        = static_cast<uint16_t>(std::min<size_t>(record.ip.size(), UINT16_MAX)),
+        .method_size    = static_cast<uint16_t>(std::min<size_t>(record.method.size(), UINT16_MAX)),
+        .protocol_size  = static_cast<uint16_t>(std::min<size_t>(record.protocol.size(), UINT16_MAX)),
+        .compress_size  = static_cast<uint16_t>(std::min<size_t>(record.compress.size(), UINT16_MAX)),
+        .uri_size       = static_cast<uint32_t>(std::min<size_t>(record.uri.size(), UINT32_MAX))
+    };
+
+    const size_t size = sizeof (header) + header.ip_size + header.method_size + header.protocol_size + header.compress_size + header.uri_size;
+
+    auto &buffer = thread_buffer();
+
+    std::lock_guard<std::mutex> lk (buffer.mutex);
+
+    if (buffer.data.size() + size > config.max_buffer)
+    {
+        // the writer is behind
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.data.append(reinterpret_cast<const char *>(&header), sizeof (header));
+    buffer.data.append(record.ip.data(), header.ip_size);
+    buffer.data.append(record.method.data(), header.method_size);
+    buffer.data.append(record.protocol.data(), header.protocol_size);
+    buffer.data.append(record.compress.data(), header.compress_size);
+    buffer.data.append(record.uri.data(), header.uri_size);
+}
+
+void manapi::net::access_log::stop() {
+    {
+        std::lock_guard<std::mutex> lk (m_writer);
+
+        if (stopping)
+        {
+            return;
+        }
+
+        stopping = true;
+    }
+
+    cv_writer.notify_all();
+
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+}
+
+const manapi::net::access_log_config_t &manapi::net::access_log::get_config() const {
+    return config;
+}
+
+size_t manapi::net::access_log::get_dropped() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+manapi::net::access_log::buffer_t &manapi::net::access_log::thread_buffer() {
+    static thread_local const size_t number = access_log_next_thread.fetch_add(1, std::memory_order_relaxed);
+
+    return *buffers[number % buffers.size()];
+}
+
+void manapi::net::access_log::run() {
+    std::unique_lock<std::mutex> lk (m_writer);
+
+    while (!stopping)
+    {
+        cv_writer.wait_for(lk, std::chrono::milliseconds(config.flush), [this] () -> bool { return stopping; });
+
+        lk.unlock();
+        write_batch();
+        lk.lock();
+    }
+
+    lk.unlock();
+    // the records after the last batch
+    write_batch();
+}
+
+void manapi::net::access_log::write_batch() {
+    std::string packed;
+
+    for (const auto &buffer: buffers)
+    {
+        std::lock_guard<std::mutex> lk (buffer->mutex);
+
+        packed.append(buffer->data);
+        // the capacity is kept for the shard
+        buffer->data.clear();
+    }
+
+    batch.clear();
+
+    for (size_t offset = 0; offset < packed.size();)
+    {
+        header_t header;
+
+        memcpy(&header, packed.data() + offset, sizeof (header));
+        offset += sizeof (header);
+
+        format_record(batch, header, packed.data() + offset);
+        offset += header.ip_size + header.method_size + header.protocol_size + header.compress_size + header.uri_size;
+    }
+
+    if (const size_t count = dropped.exchange(0, std::memory_order_relaxed); count > 0)
+    {
+        MANAPI_LOG("access log: {} records are dropped", count);
+    }
+
+    if (!batch.empty())
+    {
+        write_file(batch);
+    }
+}
+
+void manapi::net::access_log::format_record(std::string &out, const header_t &header, const char *strings) const {
+    const std::string_view ip       (strings, header.ip_size);
+    strings += header.ip_size;
+    const std::string_view method   (strings, header.method_size);
+    strings += header.method_size;
+    const std::string_view protocol (strings, header.protocol_size);
+    strings += header.protocol_size;
+    const std::string_view compress (strings, header.compress_size);
+    strings += header.compress_size;
+    const std::string_view uri      (strings, header.uri_size);
+
+    const std::time_t seconds = header.time / 1000000;
+    std::tm tm {};
+
+    gmtime_r(&seconds, &tm);
+
+    char time[64];
+
+    if (json)
+    {
+        std::strftime(time, sizeof (time), "%Y-%m-%dT%H:%M:%S", &tm);
+
+        out += std::format(R"({{"time":"{}.{:06}Z","ip":")", time, header.time % 1000000);
+        access_log_escape(out, ip);
+        out += std::format(R"(","port":{},"method":")", header.port);
+        access_log_escape(out, method);
+        out += R"(","uri":")";
+        access_log_escape(out, uri);
+        out += R"(","protocol":")";
+        access_log_escape(out, protocol);
+        out += std::format(R"(","status":{},"bytes":{},"duration":{},"compress":")", header.status, header.bytes, static_cast<double>(header.duration) / 1e6);
+        access_log_escape(out, compress);
+        out += "\"}\n";
+
+        return;
+    }
+
+    std::strftime(time, sizeof (time), "%d/%b/%Y:%H:%M:%S +0000", &tm);
+
+    // host ident authuser [date] "request" status bytes
+    out += ip;
+    out += std::format(" - - [{}] \"", time);
+    access_log_escape(out, method);
+    out += ' ';
+    access_log_escape(out, uri);
+    out += ' ';
+    access_log_escape(out, protocol);
+    out += std::format("\" {} {}\n", header.status, header.bytes);
+}
+
+void manapi::net::access_log::write_file(const std::string &data) {
+    if (config.max_size > 0 && file_size > 0 && file_size + data.size() > config.max_size)
+    {
+        rotate();
+    }
+
+    if (fd < 0)
+    {
+        try {
+            open_file();
+        }
+        catch (const std::exception &e) {
+            // the batch is lost, the file is opened again by the next one
+            return;
+        }
+    }
+
+    // one syscall per batch
+    for (size_t offset = 0; offset < data.size();)
+    {
+        const ssize_t written = ::write(fd, data.data() + offset, data.size() - offset);
+
+        if (written <= 0)
+        {
+            MANAPI_LOG("access log: could not write to {}: {}", config.file, errno);
+            return;
+        }
+
+        offset      += written;
+        file_size   += written;
+    }
+}
+
+void manapi::net::access_log::open_file() {
+    fd = open(config.file.data(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    if (fd < 0)
+    {
+        THROW_MANAPI_EXCEPTION(ERR_FILE_IO, "could not open the access log: {}", config.file);
+    }
+
+    struct stat st {};
+
+    file_size = fstat(fd, &st) == 0 ? st.st_size : 0;
+}
+
+void manapi::net::access_log::rotate() {
+    // the file is opened again by write_file ()
+    close(fd);
+    fd = -1;
+
+    if (config.max_files == 0)
+    {
+        unlink(config.file.data());
+    }
+    else
+    {
+        // file.N-1 -> file.N, ..., file -> file.1
+        for (size_t i = config.max_files; i > 1; i--)
+        {
+            rename(std::format("{}.{}", config.file, i - 1).data(), std::format("{}.{}", config.file, i).data());
+        }
+
+        rename(config.file.data(), std::format("{}.1", config.file).data());
+    }
+
+    file_size = 0;
+}
@@ -0,0 +1,80 @@
+#include "ManapiBufferPool.hpp"
+#include "ManapiUtils.hpp"
+
+manapi::net::utils::buffer_pool::buffer_pool(const size_t &block_size, const size_t &count) {
+    if (count >= UINT32_MAX) {
+        THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "buffer pool is too large: {}", count);
+    }
+
+    this->block_size = block_size;
+    this->count = count;
+
+    region = std::make_unique<uint8_t[]>(block_size * count);
+    next = std::make_unique<std::atomic<uint32_t>[]>(count);
+
+    // all slabs are free: 0 -> 1 -> ... -> count - 1
+    for (size_t i = 0; i < count; i++) {
+        next[i].store(i + 1 < count ? i + 2 : 0, std::memory_order_relaxed);
+    }
+
+    head.store(count > 0 ? 1 : 0, std::memory_order_release);
+}
+
+manapi::net::utils::buffer_pool::~buffer_pool() = default;
+
+uint8_t *manapi::net::utils::buffer_pool::acquire() {
+    uint64_t current = head.load(std::memory_order_acquire);
+
+    while (true) {
+        const auto index = static_cast<uint32_t>(current);
+
+        if (index == 0) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+
+            return new uint8_t[block_size];
+        }
+
+        const uint64_t replace = ((current >> 32) + 1) << 32 | next[index - 1].load(std::memory_order_relaxed);
+
+        if (head.compare_exchange_weak(current, replace, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+
+            return region.get() + (index - 1) * block_size;
+        }
+    }
+}
+
+void manapi::net::utils::buffer_pool::release(uint8_t *buffer) {
+    if (buffer == nullptr) {
+        return;
+    }
+
+    if (buffer < region.get() || buffer >= region.get() + block_size * count) {
+        // the miss
+        delete []buffer;
+        return;
+    }
+
+    const auto index = static_cast<uint32_t>((buffer - region.get()) / block_size);
+
+    uint64_t current = head.load(std::memory_order_relaxed);
+    uint64_t replace;
+
+    do {
+        next[index].store(static_cast<uint32_t>(current), std::memory_order_relaxed);
+        replace = ((current >> 32) + 1) << 32 | (index + 1);
+    }
+    while (!head.compare_exchange_weak(current, replace, std::memory_order_release, std::memory_order_relaxed));
+}
+
+const size_t &manapi::net::utils::buffer_pool::get_block_size() const {
+    return block_size;
+}
+
+manapi::net::utils::buffer_pool_stats_t manapi::net::utils::buffer_pool::get_stats() const {
+    return {
+        .capacity   = count,
+        .hits       = hits.load(std::memory_order_relaxed),
+        .misses     = misses.load(std::memory_order_relaxed)
+    };
+}
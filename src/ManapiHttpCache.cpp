@@ -0,0 +1,187 @@
+#include "ManapiHttpCache.hpp"
+#include "ManapiHttpTypes.hpp"
+
+manapi::net::http_response_cache::http_response_cache(http_cache_config_t config) : config (std::move(config)) {}
+
+std::string manapi::net::http_response_cache::key(const request_data_t &request_data, const std::string_view encoding) const {
+    std::string_view path   = request_data.uri;
+    std::string_view query;
+
+    if (const size_t pos = path.find('?'); pos != std::string_view::npos)
+    {
+        query   = path.substr(pos + 1);
+        path    = path.substr(0, pos);
+    }
+
+    std::string key;
+
+    key.reserve(request_data.method.size() + request_data.uri.size() + 32);
+
+    key += request_data.method;
+    key += ' ';
+    key += path;
+    key += '?';
+
+    if (config.vary_query.empty())
+    {
+        key += query;
+    }
+    else
+    {
+        const utils::url_params params (query);
+
+        for (const auto &name: config.vary_query)
+        {
+            if (const auto value = params.find(name); value != nullptr)
+            {
+                key += name;
+                key += '=';
+                key += *value;
+            }
+
+            key += '&';
+        }
+    }
+
+    // the body can be compressed, the clients with the same encoding share the entry
+    key += '\n';
+    key += encoding;
+
+    for (const auto &name: config.vary)
+    {
+        key += '\n';
+
+        if (const auto it = request_data.headers.find(name); it != request_data.headers.end())
+        {
+            key += it->second;
+        }
+    }
+
+    return key;
+}
+
+manapi::net::http_cache_result_t manapi::net::http_response_cache::acquire(const std::string &key, std::shared_ptr<const http_cache_entry_t> &entry) {
+    std::unique_lock <std::mutex> lock (mutex);
+
+    const auto deadline = std::chrono::steady_clock::now() + config.wait;
+
+    while (true)
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        if (const auto it = items.find(key); it != items.end())
+        {
+            if (now < it->second.entry->expires)
+            {
+                lru.splice(lru.begin(), lru, it->second.lru);
+                entry = it->second.entry;
+
+                return CACHE_HIT;
+            }
+
+            if (now < it->second.entry->stale_until)
+            {
+                if (!it->second.refreshing)
+                {
+                    // this request refreshes the entry, the others get the stale one
+                    it->second.refreshing = true;
+
+                    return CACHE_LEAD;
+                }
+
+                entry = it->second.entry;
+
+                return CACHE_HIT;
+            }
+
+            erase(it);
+        }
+
+        if (!building.contains(key))
+        {
+            building.insert(key);
+
+            return CACHE_LEAD;
+        }
+
+        // the waiting request holds the worker of the pool
+        if (waiters >= config.max_waiters)
+        {
+            return CACHE_BYPASS;
+        }
+
+        waiters++;
+
+        const auto status = cv.wait_until(lock, deadline);
+
+        waiters--;
+
+        if (status == std::cv_status::timeout)
+        {
+            return CACHE_BYPASS;
+        }
+    }
+}
+
+void manapi::net::http_response_cache::store(const std::string &key, http_cache_entry_t entry) {
+    const auto now = std::chrono::steady_clock::now();
+
+    entry.expires       = now + config.ttl;
+    entry.stale_until   = entry.expires + config.stale;
+
+    const size_t entry_size = entry.body.size();
+
+    {
+        std::lock_guard <std::mutex> lock (mutex);
+
+        building.erase(key);
+
+        if (const auto it = items.find(key); it != items.end())
+        {
+            erase(it);
+        }
+
+        if (entry_size <= config.max_size)
+        {
+            // the least recently used entries are removed
+            while (size + entry_size > config.max_size && !lru.empty())
+            {
+                erase(items.find(lru.back()));
+            }
+
+            lru.push_front(key);
+
+            items.insert({key, item_t {std::make_shared<const http_cache_entry_t>(std::move(entry)), lru.begin()}});
+
+            size += entry_size;
+        }
+    }
+
+    cv.notify_all();
+}
+
+void manapi::net::http_response_cache::abandon(const std::string &key) {
+    {
+        std::lock_guard <std::mutex> lock (mutex);
+
+        building.erase(key);
+
+        if (const auto it = items.find(key); it != items.end())
+        {
+            it->second.refreshing = false;
+        }
+    }
+
+    cv.notify_all();
+}
+
+const manapi::net::http_cache_config_t &manapi::net::http_response_cache::get_config() const {
+    return config;
+}
+
+void manapi::net::http_response_cache::erase(std::unordered_map<std::string, item_t>::iterator it) {
+    size -= it->second.entry->body.size();
+
+    lru.erase(it->second.lru);
+    items.erase(it);
+}
@@ -1,6 +1,36 @@
+#include <algorithm>
+
 #include "ManapiHttpConfig.hpp"
 #include "ManapiUtils.hpp"
 
+// QUIC varints are limited by 2^62 - 1
+#define MANAPI_QUIC_VARINT_MAX 4611686018427387903ULL
+
+/**
+ * reads the numeric param and checks that it is in the range [min, max]
+ * @param config    the config of the pool
+ * @param key       the name of the param
+ * @param value     the default value (if the param does not exist)
+ * @param min       the min value
+ * @param max       the max value
+ * @return the value of the param
+ */
+static size_t config_get_size_in_range (const manapi::json &config, const std::string &key, const size_t &value, const size_t &min, const size_t &max) {
+    if (!config.contains(key))
+    {
+        return value;
+    }
+
+    const auto &param = config[key];
+
+    if (!param.is_number() || param.as_number() < 0 || static_cast<size_t>(param.as_number()) < min || static_cast<size_t>(param.as_number()) > max)
+    {
+        THROW_MANAPI_EXCEPTION(manapi::net::ERR_CONFIG_ERROR, "invalid {} in config: the value must be a number in the range [{}, {}]", key, min, max);
+    }
+
+    return param.as_number();
+}
+
 manapi::net::config::config(const json &config) {
     // =================[partial data min size  ]================= //
     if (config.contains("partial_data_min_size"))
@@ -45,9 +75,128 @@ manapi::net::config::config(const json &config) {
 
     // =================[ssl                    ]================= //
     if (config.contains("ssl")) {
-        ssl_config.enabled  = config["ssl"]["enabled"].get<bool>();
-        ssl_config.key      = config["ssl"]["key"].get<std::string>();
-        ssl_config.cert     = config["ssl"]["cert"].get<std::string>();
+        const auto &ssl = config["ssl"];
+
+        ssl_config.enabled  = ssl["enabled"].get<bool>();
+        ssl_config.key      = ssl["key"].get<std::string>();
+        ssl_config.cert     = ssl["cert"].get<std::string>();
+
+        ssl_config.session_cache    = config_get_size_in_range(ssl, "session_cache", ssl_config.session_cache, 0, LONG_MAX);
+        ssl_config.session_timeout  = config_get_size_in_range(ssl, "session_timeout", ssl_config.session_timeout, 1, LONG_MAX);
+        ssl_config.ticket_rotation  = config_get_size_in_range(ssl, "ticket_rotation", ssl_config.ticket_rotation, 1, LONG_MAX);
+        ssl_config.early_data       = config_get_size_in_range(ssl, "early_data", ssl_config.early_data, 0, UINT32_MAX);
+        ssl_config.crypto_threads   = config_get_size_in_range(ssl, "crypto_threads", ssl_config.crypto_threads, 0, 1024);
+        ssl_config.crypto_queue     = config_get_size_in_range(ssl, "crypto_queue", ssl_config.crypto_queue, 1, LONG_MAX);
+
+        if (ssl.contains("session_tickets"))
+        {
+            ssl_config.session_tickets = ssl["session_tickets"].get<bool>();
+        }
+
+        // the anti-replay protection of OpenSSL works only with the session cache
+        if (ssl_config.early_data > 0 && ssl_config.session_cache == 0)
+        {
+            THROW_MANAPI_EXCEPTION2(ERR_CONFIG_ERROR, "ssl early_data requires the session_cache");
+        }
+
+        if (ssl.contains("ocsp"))
+        {
+            const auto &ocsp = ssl["ocsp"];
+
+            if (ocsp.contains("enabled"))
+            {
+                ssl_config.ocsp.enabled = ocsp["enabled"].get<bool>();
+            }
+
+            if (ocsp.contains("file"))
+            {
+                ssl_config.ocsp.file = ocsp["file"].get<std::string>();
+            }
+
+            ssl_config.ocsp.refresh = config_get_size_in_range(ocsp, "refresh", ssl_config.ocsp.refresh, 1, LONG_MAX);
+        }
+    }
+
+    // =================[buffer_pool_size       ]================= //
+    buffer_pool_size = config_get_size_in_range(config, "buffer_pool_size", buffer_pool_size, 0, UINT32_MAX - 1);
+
+    // =================[admission              ]================= //
+    admission_target    = config_get_size_in_range(config, "admission_target", admission_target, 0, UINT32_MAX);
+    admission_interval  = config_get_size_in_range(config, "admission_interval", admission_interval, 1, UINT32_MAX);
+
+    // =================[rate_limit             ]================= //
+    if (config.contains("rate_limit"))
+    {
+        const auto &limit = config["rate_limit"];
+
+        if (!limit.is_object())
+        {
+            THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid rate_limit in config: {}", "the value must be an object");
+        }
+
+        rate_limit_config.enabled = !limit.contains("enabled") || limit["enabled"].get<bool>();
+
+        rate_limit_config.rate              = config_get_size_in_range(limit, "rate", rate_limit_config.rate, 1, UINT32_MAX);
+        rate_limit_config.burst             = config_get_size_in_range(limit, "burst", rate_limit_config.burst, 1, UINT32_MAX);
+        rate_limit_config.subnet_rate       = config_get_size_in_range(limit, "subnet_rate", rate_limit_config.subnet_rate, 0, UINT32_MAX);
+        rate_limit_config.subnet_burst      = config_get_size_in_range(limit, "subnet_burst", rate_limit_config.subnet_burst, 1, UINT32_MAX);
+        rate_limit_config.max_connections   = config_get_size_in_range(limit, "max_connections", rate_limit_config.max_connections, 0, UINT32_MAX);
+        rate_limit_config.max_entries       = config_get_size_in_range(limit, "max_entries", rate_limit_config.max_entries, 1, UINT32_MAX);
+        rate_limit_config.sweep             = config_get_size_in_range(limit, "sweep", rate_limit_config.sweep, 1, LONG_MAX);
+    }
+
+    // =================[access_log             ]================= //
+    if (config.contains("access_log"))
+    {
+        const auto &log = config["access_log"];
+
+        if (!log.is_object())
+        {
+            THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid access_log in config: {}", "the value must be an object");
+        }
+
+        access_log_config.enabled = !log.contains("enabled") || log["enabled"].get<bool>();
+
+        if (log.contains("file"))
+        {
+            access_log_config.file  = log["file"].get<std::string>();
+        }
+
+        if (log.contains("format"))
+        {
+            access_log_config.format = log["format"].get<std::string>();
+        }
+
+        access_log_config.max_size          = config_get_size_in_range(log, "max_size", access_log_config.max_size, 0, LONG_MAX);
+        access_log_config.max_files         = config_get_size_in_range(log, "max_files", access_log_config.max_files, 0, 1000);
+        access_log_config.sample            = config_get_size_in_range(log, "sample", access_log_config.sample, 1, UINT32_MAX);
+        access_log_config.flush             = config_get_size_in_range(log, "flush", access_log_config.flush, 1, UINT32_MAX);
+        access_log_config.max_buffer        = config_get_size_in_range(log, "max_buffer", access_log_config.max_buffer, 1024, LONG_MAX);
+    }
+
+    // =================[tracing                ]================= //
+    if (config.contains("tracing"))
+    {
+        const auto &tracing = config["tracing"];
+
+        if (!tracing.is_object())
+        {
+            THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid tracing in config: {}", "the value must be an object");
+        }
+
+        trace_config.enabled = !tracing.contains("enabled") || tracing["enabled"].get<bool>();
+
+        if (tracing.contains("server_timing"))
+        {
+            trace_config.server_timing = tracing["server_timing"].get<bool>();
+        }
+
+        if (tracing.contains("file"))
+        {
+            trace_config.file = tracing["file"].get<std::string>();
+        }
+
+        trace_config.sample = config_get_size_in_range(tracing, "sample", trace_config.sample, 1, UINT32_MAX);
     }
 
     // =================[max_header_block_size  ]================= //
@@ -80,6 +229,16 @@ manapi::net::config::config(const json &config) {
         http_implement = config["http_implement"].get<std::string>();
     }
 
+    // the default block is the QUIC datagram, the TCP reads use the TLS record size
+    if (http_implement == "tls" && !config.contains("socket_block_size"))
+    {
+        socket_block_size = MANAPI_HTTP_TCP_BLOCK_SIZE;
+    }
+
+    // =================[tcp_read_max           ]================= //
+    tcp_read_max = config_get_size_in_range(config, "tcp_read_max", std::max(max_header_block_size, socket_block_size), MANAPI_HTTP_TCP_READ_MIN, LONG_MAX);
+    tcp_read_size = std::min<size_t>(MANAPI_HTTP_TCP_READ_MIN * 2, tcp_read_max);
+
     // =================[tls_version            ]================= //
     if (config.contains("tls_version"))
     {
@@ -134,7 +293,7 @@ manapi::net::config::config(const json &config) {
         }
     }
 
-    // =================[quic_cc_algo           ]================= //
+    // =================[quic_debug             ]================= //
     if (config.contains("quic_debug"))
     {
         quic_debug = config["quic_debug"].get<bool>();
@@ -145,6 +304,76 @@ manapi::net::config::config(const json &config) {
     {
         quic_implement = config["quic_implement"].get<std::string>();
     }
+
+    // =================[quic transport params  ]================= //
+    quic_max_idle_timeout                   = config_get_size_in_range(config, "quic_max_idle_timeout", quic_max_idle_timeout, 0, MANAPI_QUIC_VARINT_MAX);
+    // RFC 9000: the UDP payload must be at least 1200 bytes and not more than 65527
+    quic_max_datagram_size                  = config_get_size_in_range(config, "quic_max_datagram_size", quic_max_datagram_size, 1200, 65527);
+    quic_initial_max_data                   = config_get_size_in_range(config, "quic_initial_max_data", quic_initial_max_data, 0, MANAPI_QUIC_VARINT_MAX);
+    quic_initial_max_stream_data_bidi_local = config_get_size_in_range(config, "quic_initial_max_stream_data_bidi_local", quic_initial_max_stream_data_bidi_local, 0, MANAPI_QUIC_VARINT_MAX);
+    quic_initial_max_stream_data_bidi_remote= config_get_size_in_range(config, "quic_initial_max_stream_data_bidi_remote", quic_initial_max_stream_data_bidi_remote, 0, MANAPI_QUIC_VARINT_MAX);
+    quic_initial_max_stream_data_uni        = config_get_size_in_range(config, "quic_initial_max_stream_data_uni", quic_initial_max_stream_data_uni, 0, MANAPI_QUIC_VARINT_MAX);
+    // RFC 9000: the count of the streams can not be greater than 2^60
+    quic_initial_max_streams_bidi           = config_get_size_in_range(config, "quic_initial_max_streams_bidi", quic_initial_max_streams_bidi, 0, 1ULL << 60);
+    quic_initial_max_streams_uni            = config_get_size_in_range(config, "quic_initial_max_streams_uni", quic_initial_max_streams_uni, 0, 1ULL << 60);
+    quic_max_connection_window              = config_get_size_in_range(config, "quic_max_connection_window", quic_max_connection_window, 0, MANAPI_QUIC_VARINT_MAX);
+    quic_max_stream_window                  = config_get_size_in_range(config, "quic_max_stream_window", quic_max_stream_window, 0, MANAPI_QUIC_VARINT_MAX);
+    quic_max_connections                    = config_get_size_in_range(config, "quic_max_connections", quic_max_connections, 0, SIZE_MAX);
+
+    // the window can only grow from the initial value
+    if (quic_max_connection_window < quic_initial_max_data)
+    {
+        THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "quic_max_connection_window ({}) can not be less than quic_initial_max_data ({})", quic_max_connection_window, quic_initial_max_data);
+    }
+
+    if (quic_max_stream_window < std::max({quic_initial_max_stream_data_bidi_local, quic_initial_max_stream_data_bidi_remote, quic_initial_max_stream_data_uni}))
+    {
+        THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "quic_max_stream_window ({}) can not be less than the initial max stream data", quic_max_stream_window);
+    }
+
+    // =================[quic_discover_pmtu     ]================= //
+    if (config.contains("quic_discover_pmtu"))
+    {
+        if (!config["quic_discover_pmtu"].is_bool())
+        {
+            THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid quic_discover_pmtu in config: {}", "the value must be a boolean");
+        }
+
+        quic_discover_pmtu = config["quic_discover_pmtu"].get<bool>();
+    }
+
+    // =================[quic_dgram             ]================= //
+    if (config.contains("quic_dgram"))
+    {
+        const auto &dgram = config["quic_dgram"];
+
+        if (!dgram.is_object())
+        {
+            THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid quic_dgram in config: {}", "the value must be an object");
+        }
+
+        if (dgram.contains("enabled"))
+        {
+            if (!dgram["enabled"].is_bool())
+            {
+                THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid quic_dgram.enabled in config: {}", "the value must be a boolean");
+            }
+
+            quic_dgram_config.enabled = dgram["enabled"].get<bool>();
+        }
+
+        quic_dgram_config.recv_queue_len = config_get_size_in_range(dgram, "recv_queue_len", quic_dgram_config.recv_queue_len, 1, SIZE_MAX);
+        quic_dgram_config.send_queue_len = config_get_size_in_range(dgram, "send_queue_len", quic_dgram_config.send_queue_len, 1, SIZE_MAX);
+    }
+
+    // =================[http2 settings         ]================= //
+    http2_header_table_size                 = config_get_size_in_range(config, "http2_header_table_size", http2_header_table_size, 0, UINT32_MAX);
+    http2_max_concurrent_streams            = config_get_size_in_range(config, "http2_max_concurrent_streams", http2_max_concurrent_streams, 1, UINT32_MAX);
+    // RFC 9113: the window can not be greater than 2^31-1
+    http2_initial_window_size               = config_get_size_in_range(config, "http2_initial_window_size", http2_initial_window_size, 0, INT32_MAX);
+    // RFC 9113: the frame size must be in the range [2^14, 2^24-1]
+    http2_max_frame_size                    = config_get_size_in_range(config, "http2_max_frame_size", http2_max_frame_size, 16384, 16777215);
+    http2_max_connections                   = config_get_size_in_range(config, "http2_max_connections", http2_max_connections, 1, SIZE_MAX);
 }
 
 manapi::net::config::~config() = default;
@@ -159,6 +388,78 @@ const size_t &manapi::net::config::get_socket_block_size() const {
     return socket_block_size;
 }
 
+const size_t &manapi::net::config::get_admission_target() const {
+    return admission_target;
+}
+
+const size_t &manapi::net::config::get_admission_interval() const {
+    return admission_interval;
+}
+
+const manapi::net::rate_limit_config_t &manapi::net::config::get_rate_limit_config() const {
+    return rate_limit_config;
+}
+
+void manapi::net::config::set_rate_limiter(const std::shared_ptr<rate_limiter> &limiter) {
+    this->limiter.store(limiter);
+}
+
+std::shared_ptr<manapi::net::rate_limiter> manapi::net::config::get_rate_limiter() const {
+    return limiter.load();
+}
+
+const manapi::net::access_log_config_t &manapi::net::config::get_access_log_config() const {
+    return access_log_config;
+}
+
+void manapi::net::config::set_access_log(const std::shared_ptr<access_log> &log) {
+    access_logger.store(log);
+}
+
+std::shared_ptr<manapi::net::access_log> manapi::net::config::get_access_log() const {
+    return access_logger.load();
+}
+
+const manapi::net::trace_config_t &manapi::net::config::get_trace_config() const {
+    return trace_config;
+}
+
+void manapi::net::config::set_tracer(const std::shared_ptr<tracer> &tracer) {
+    request_tracer.store(tracer);
+}
+
+std::shared_ptr<manapi::net::tracer> manapi::net::config::get_tracer() const {
+    return request_tracer.load();
+}
+
+const size_t &manapi::net::config::get_buffer_pool_size() const {
+    return buffer_pool_size;
+}
+
+void manapi::net::config::set_buffer_pool(const std::shared_ptr<utils::buffer_pool> &pool) {
+    buffer_pool.store(pool);
+}
+
+std::shared_ptr<manapi::net::utils::buffer_pool> manapi::net::config::get_buffer_pool() const {
+    return buffer_pool.load();
+}
+
+size_t manapi::net::config::get_tcp_read_size() const {
+    return tcp_read_size.load(std::memory_order_relaxed);
+}
+
+const size_t &manapi::net::config::get_tcp_read_max() const {
+    return tcp_read_max;
+}
+
+void manapi::net::config::observe_tcp_head_size(const size_t &size) {
+    // moving average: the size of the head of the most requests + the small part of the body
+    const size_t current = tcp_read_size.load(std::memory_order_relaxed);
+    const size_t average = (current * 7 + size + size / 4) / 8;
+
+    tcp_read_size.store(std::clamp<size_t>(average, MANAPI_HTTP_TCP_READ_MIN, tcp_read_max), std::memory_order_relaxed);
+}
+
 void manapi::net::config::set_max_header_block_size(const size_t &s) {
     max_header_block_size = s;
 }
@@ -247,6 +548,82 @@ const size_t & manapi::net::config::get_quic_cc_algo() const {
     return quic_cc_algo;
 }
 
+const size_t & manapi::net::config::get_quic_max_idle_timeout() const {
+    return quic_max_idle_timeout;
+}
+
+const size_t & manapi::net::config::get_quic_max_datagram_size() const {
+    return quic_max_datagram_size;
+}
+
+const size_t & manapi::net::config::get_quic_initial_max_data() const {
+    return quic_initial_max_data;
+}
+
+const size_t & manapi::net::config::get_quic_initial_max_stream_data_bidi_local() const {
+    return quic_initial_max_stream_data_bidi_local;
+}
+
+const size_t & manapi::net::config::get_quic_initial_max_stream_data_bidi_remote() const {
+    return quic_initial_max_stream_data_bidi_remote;
+}
+
+const size_t & manapi::net::config::get_quic_initial_max_stream_data_uni() const {
+    return quic_initial_max_stream_data_uni;
+}
+
+const size_t & manapi::net::config::get_quic_initial_max_streams_bidi() const {
+    return quic_initial_max_streams_bidi;
+}
+
+const size_t & manapi::net::config::get_quic_initial_max_streams_uni() const {
+    return quic_initial_max_streams_uni;
+}
+
+const size_t & manapi::net::config::get_quic_max_connection_window() const {
+    return quic_max_connection_window;
+}
+
+const size_t & manapi::net::config::get_quic_max_stream_window() const {
+    return quic_max_stream_window;
+}
+
+/**
+ * max count of the QUIC connections per pool
+ * @return 0 if unlimited
+ */
+const size_t & manapi::net::config::get_quic_max_connections() const {
+    return quic_max_connections;
+}
+
+const bool & manapi::net::config::is_quic_discover_pmtu() const {
+    return quic_discover_pmtu;
+}
+
+const manapi::net::quic_dgram_config_t &manapi::net::config::get_quic_dgram_config() {
+    return quic_dgram_config;
+}
+
+const size_t & manapi::net::config::get_http2_header_table_size() const {
+    return http2_header_table_size;
+}
+
+const size_t & manapi::net::config::get_http2_max_concurrent_streams() const {
+    return http2_max_concurrent_streams;
+}
+
+const size_t & manapi::net::config::get_http2_initial_window_size() const {
+    return http2_initial_window_size;
+}
+
+const size_t & manapi::net::config::get_http2_max_frame_size() const {
+    return http2_max_frame_size;
+}
+
+const size_t & manapi::net::config::get_http2_max_connections() const {
+    return http2_max_connections;
+}
+
 const manapi::net::ssl_config_t &manapi::net::config::get_ssl_config() {
     return ssl_config;
 }
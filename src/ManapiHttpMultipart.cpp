@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cstring>
+#include "ManapiHttpMultipart.hpp"
+#include "ManapiHttpTypes.hpp"
+#include "ManapiUtils.hpp"
+
+manapi::net::multipart_reader::multipart_reader(const std::string &boundary, std::function<std::span<const char>()> source, const size_t &max_header_size)
+    : source (std::move(source)),
+      max_header_size (max_header_size),
+      delimiter ("\r\n--" + boundary),
+      searcher (delimiter.cbegin(), delimiter.cend())
+{
+    // the body starts from --boundary without \r\n, the preamble is the data of the zero part
+    pending = "\r\n";
+}
+
+bool manapi::net::multipart_reader::next_part(multipart_part_t &part) {
+    if (finished)
+    {
+        return false;
+    }
+
+    if (in_part)
+    {
+        // the handler did not read the data of the part
+        read_data(nullptr);
+    }
+
+    // \r\n -> the next part, -- -> the closing delimiter
+    if (read_line().starts_with("--"))
+    {
+        finished = true;
+
+        return false;
+    }
+
+    part = {};
+
+    size_t headers_size = 0;
+
+    for (std::string line = read_line(); !line.empty(); line = read_line())
+    {
+        headers_size += line.size();
+
+        if (headers_size > max_header_size)
+        {
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_SO_LONG, "the headers of the part are larger than {} bytes", max_header_size);
+        }
+
+        const auto parsed_header = utils::parse_header(line);
+
+        if (parsed_header.first == HTTP_HEADER.CONTENT_DISPOSITION)
+        {
+            const auto header_value = utils::parse_header_value(parsed_header.second);
+
+            if (header_value.empty())
+            {
+                THROW_MANAPI_EXCEPTION(ERR_HTTP_IMPORTANT_HEADER_MISSING, "header value is empty: {}", HTTP_HEADER.CONTENT_DISPOSITION);
+            }
+
+            if (const auto name = header_value[0].params.find("name"); name != header_value[0].params.end())
+            {
+                part.name       = name->second;
+            }
+
+            if (const auto file_name = header_value[0].params.find("filename"); file_name != header_value[0].params.end())
+            {
+                part.file_name  = file_name->second;
+                part.is_file    = true;
+            }
+        }
+        else if (parsed_header.first == HTTP_HEADER.CONTENT_TYPE)
+        {
+            const auto header_value = utils::parse_header_value(parsed_header.second);
+
+            if (header_value.empty())
+            {
+                THROW_MANAPI_EXCEPTION(ERR_HTTP_IMPORTANT_HEADER_MISSING, "{} can not be empty", HTTP_HEADER.CONTENT_TYPE);
+            }
+
+            part.mime_type      = header_value[0].value;
+        }
+    }
+
+    in_part = true;
+
+    return true;
+}
+
+void manapi::net::multipart_reader::read_data(const std::function<void(const char *, const size_t &)> &handler) {
+    if (!in_part)
+    {
+        return;
+    }
+
+    in_part = false;
+
+    // the bytes which can be the beginning of the delimiter
+    const size_t keep = delimiter.size() - 1;
+
+    while (true)
+    {
+        if (!pending.empty())
+        {
+            bool last = false;
+
+            if (buffer.size() < keep)
+            {
+                // the window (pending + keep bytes) is not full
+                pending.append(buffer.data(), buffer.size());
+                buffer = {};
+
+                if (fetch())
+                {
+                    continue;
+                }
+
+                // the end of the body, the delimiter can be only in the pending bytes
+                last = true;
+            }
+
+            // the delimiter can start in the pending bytes and end in the buffer, check only this window
+            const size_t pending_size = pending.size();
+
+            if (!last)
+            {
+                pending.append(buffer.data(), keep);
+            }
+
+            const auto it = std::search(pending.cbegin(), pending.cend(), searcher);
+
+            if (it == pending.cend())
+            {
+                if (last)
+                {
+                    THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "{}", "the multipart body is not closed");
+                }
+
+                if (handler != nullptr)
+                {
+                    handler (pending.data(), pending_size);
+                }
+
+                pending.clear();
+
+                continue;
+            }
+
+            const size_t pos = it - pending.cbegin();
+            const size_t end = pos + delimiter.size();
+
+            if (handler != nullptr && pos > 0)
+            {
+                handler (pending.data(), pos);
+            }
+
+            if (end <= pending_size)
+            {
+                // the rest of the pending bytes is unread
+                pending.resize(pending_size);
+                pending.erase(0, end);
+            }
+            else
+            {
+                buffer = buffer.subspan(end - pending_size);
+                pending.clear();
+            }
+
+            return;
+        }
+
+        if (buffer.empty() && !fetch())
+        {
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "{}", "the multipart body is not closed");
+        }
+
+        const auto [first, last] = searcher(buffer.begin(), buffer.end());
+
+        if (first != buffer.end())
+        {
+            const size_t pos = first - buffer.begin();
+
+            if (handler != nullptr && pos > 0)
+            {
+                handler (buffer.data(), pos);
+            }
+
+            buffer = buffer.subspan(pos + delimiter.size());
+
+            return;
+        }
+
+        const size_t tail = std::min(keep, buffer.size());
+
+        if (handler != nullptr && buffer.size() > tail)
+        {
+            handler (buffer.data(), buffer.size() - tail);
+        }
+
+        // the only copy: less than the size of the delimiter
+        pending.assign(buffer.data() + buffer.size() - tail, tail);
+        buffer = {};
+    }
+}
+
+bool manapi::net::multipart_reader::fetch() {
+    buffer = source();
+
+    return !buffer.empty();
+}
+
+std::string manapi::net::multipart_reader::read_line() {
+    std::string line;
+
+    if (!pending.empty())
+    {
+        const auto pos = pending.find('\n');
+
+        if (pos != std::string::npos)
+        {
+            line.append(pending, 0, pos);
+            pending.erase(0, pos + 1);
+
+            goto finish;
+        }
+
+        line    = std::move(pending);
+        pending.clear();
+    }
+
+    while (true)
+    {
+        if (buffer.empty() && !fetch())
+        {
+            if (line.empty())
+            {
+                THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "{}", "the multipart body is not closed");
+            }
+
+            // the closing delimiter without \r\n
+            break;
+        }
+
+        const auto ptr = static_cast<const char *>(memchr(buffer.data(), '\n', buffer.size()));
+
+        if (ptr != nullptr)
+        {
+            const size_t size = ptr - buffer.data();
+
+            line.append(buffer.data(), size);
+            buffer = buffer.subspan(size + 1);
+
+            break;
+        }
+
+        line.append(buffer.data(), buffer.size());
+        buffer = {};
+
+        if (line.size() > max_header_size)
+        {
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_SO_LONG, "the header of the part is larger than {} bytes", max_header_size);
+        }
+    }
+
+    finish:
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.pop_back();
+    }
+
+    return line;
+}
@@ -23,7 +23,23 @@ manapi::net::http_pool::http_pool(const json &config, class site *site, const si
 
 manapi::net::http_pool::~http_pool() = default;
 
-SSL_CTX *manapi::net::http_pool::ssl_create_context(const size_t &version) {
+// ALPN protocols in order of preference
+static const std::string alpn_protocols_h2 ("\x02h2\x08http/1.1");
+static const std::string alpn_protocols_http1 ("\x08http/1.1");
+
+static int ssl_alpn_select (SSL *ssl, const unsigned char **out, unsigned char *outlen, const unsigned char *in, unsigned int inlen, void *arg) {
+    const auto protocols = static_cast<const std::string *>(arg);
+
+    if (SSL_select_next_proto(const_cast<unsigned char **>(out), outlen, reinterpret_cast<const unsigned char *>(protocols->data()), protocols->size(), in, inlen) != OPENSSL_NPN_NEGOTIATED)
+    {
+        // the client will use HTTP/1.1
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+
+    return SSL_TLSEXT_ERR_OK;
+}
+
+SSL_CTX *manapi::net::http_pool::ssl_create_context(const size_t &version, const size_t &http_version) {
     const SSL_METHOD *method;
     SSL_CTX *ctx;
 
@@ -50,6 +66,11 @@ SSL_CTX *manapi::net::http_pool::ssl_create_context(const size_t &version) {
     SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE);
     SSL_CTX_set_mode(ctx, SSL_MODE_ASYNC);
 
+    // RFC 9113 9.2: h2 requires TLS 1.2 or higher
+    const bool h2 = http_version == versions::HTTP_v2 && (version == versions::TLS_v1_2 || version == versions::TLS_v1_3);
+
+    SSL_CTX_set_alpn_select_cb(ctx, ssl_alpn_select, const_cast<std::string *>(h2 ? &alpn_protocols_h2 : &alpn_protocols_http1));
+
     return ctx;
 }
 
@@ -80,10 +101,8 @@ void manapi::net::http_pool::stop() {
 
         quic_map_conns.unlock();
     }
-    else if (config.get_http_implement() == "tls")
-    {
-        // nothing
-    }
+
+    stop_timers();
 
     MANAPI_LOG("{}", "shutdown socket");
 
@@ -144,6 +163,11 @@ int manapi::net::http_pool::_pool() {
     ev_io  = std::make_unique<ev::io> (loop);
 
     utils::before_delete bd_clean_up ([this] () -> void {
+        stop_timers();
+
+        site->get_metrics().remove_collector(metrics_collector);
+        metrics_collector = 0;
+
         if (config.get_http_implement() == "quic")
         {
             if (config.get_quic_implement() == "quiche")
@@ -157,18 +181,89 @@ int manapi::net::http_pool::_pool() {
         }
         else if (config.get_http_implement() == "tls")
         {
+            if (crypto != nullptr)
+            {
+                // waits for the jobs, they use the pending connections
+                crypto->stop();
+                crypto_async->stop();
+
+                crypto = nullptr;
+                crypto_async = nullptr;
+                crypto_done.clear();
+            }
+
+            // the connections which are not dispatched yet
+            for (auto &conn: tcp_pending)
+            {
+                conn.second->io.stop();
+                conn.second->timer.stop();
+                conn.second->task->tcp_close();
+            }
+
+            tcp_pending.clear();
+
             if (config.get_ssl_config().enabled)
             {
                 SSL_CTX_free(config.get_openssl_ctx());
+
+                ocsp_stapler = nullptr;
             }
         }
 
+        // the tasks can still run: the getters return the copies,
+        // so the objects are alive until the last task releases them
+        config.set_buffer_pool(nullptr);
+        config.set_rate_limiter(nullptr);
+
+        if (const auto log = config.get_access_log(); log != nullptr)
+        {
+            // the last batch is written, the later records are dropped
+            log->stop();
+            config.set_access_log(nullptr);
+        }
+
+        if (const auto tracer = config.get_tracer(); tracer != nullptr)
+        {
+            tracer->stop();
+            config.set_tracer(nullptr);
+        }
+
         freeaddrinfo(local);
         local = nullptr;
 
         close(config.get_socket_fd());
     });
 
+    if (config.get_buffer_pool_size() > 0)
+    {
+        config.set_buffer_pool(std::make_shared<utils::buffer_pool>(config.get_socket_block_size(), config.get_buffer_pool_size()));
+    }
+
+    if (config.get_rate_limit_config().enabled)
+    {
+        config.set_rate_limiter(std::make_shared<rate_limiter>(config.get_rate_limit_config()));
+    }
+
+    if (config.get_access_log_config().enabled)
+    {
+        config.set_access_log(std::make_shared<access_log>(config.get_access_log_config()));
+    }
+
+    if (config.get_trace_config().enabled)
+    {
+#ifdef MANAPI_HTTP_TRACING
+        config.set_tracer(std::make_shared<tracer>(config.get_trace_config()));
+#else
+        MANAPI_LOG("{}", "tracing is enabled in the config, but the library is built without MANAPI_HTTP_TRACING");
+#endif
+    }
+
+    if (config.get_admission_target() > 0)
+    {
+        // the threadpool is shared by the pools of the site
+        site->get_tasks_pool()->set_admission(std::chrono::milliseconds(config.get_admission_target()), std::chrono::milliseconds(config.get_admission_interval()));
+    }
+
     if (config.get_http_implement() == "tls")
     {
         hints = {
@@ -224,9 +319,18 @@ int manapi::net::http_pool::_pool() {
             // setup ssl certs
 
             // init
-            config.set_openssl_ctx(ssl_create_context(config.get_tls_version()));
+            config.set_openssl_ctx(ssl_create_context(config.get_tls_version(), config.get_http_version()));
             // setup ctx (load certs)
             ssl_configure_context();
+
+            if (config.get_ssl_config().crypto_threads > 0)
+            {
+                crypto = std::make_unique<tls::crypto_pool>(config.get_ssl_config().crypto_threads, config.get_ssl_config().crypto_queue);
+
+                crypto_async = std::make_unique<ev::async> (loop);
+                crypto_async->set <http_pool, &http_pool::crypto_completed> (this);
+                crypto_async->start();
+            }
         }
 
         ev_io->set <http_pool, &http_pool::new_connection_tls> (this);
@@ -298,16 +402,24 @@ int manapi::net::http_pool::_pool() {
                 quiche_config_set_application_protos(config.get_quic_config(), reinterpret_cast <const uint8_t *> (http_application_protocol.data()), http_application_protocol.size());
             }
 
-            quiche_config_set_max_idle_timeout                      (config.get_quic_config(), 50000);
-            quiche_config_set_max_recv_udp_payload_size             (config.get_quic_config(), MANAPI_MAX_DATAGRAM_SIZE);
-            quiche_config_set_max_send_udp_payload_size             (config.get_quic_config(),  MANAPI_MAX_DATAGRAM_SIZE);
-            quiche_config_set_initial_max_data                      (config.get_quic_config(), 10000000);
-            quiche_config_set_initial_max_stream_data_bidi_local    (config.get_quic_config(), 1000000);
-            quiche_config_set_initial_max_stream_data_bidi_remote   (config.get_quic_config(), 1000000);
-            quiche_config_set_initial_max_stream_data_uni           (config.get_quic_config(), 1000000);
-            quiche_config_set_initial_max_streams_bidi              (config.get_quic_config(), 100);
-            quiche_config_set_initial_max_streams_uni               (config.get_quic_config(), 100);
+            quiche_config_set_max_idle_timeout                      (config.get_quic_config(), config.get_quic_max_idle_timeout());
+            quiche_config_set_max_recv_udp_payload_size             (config.get_quic_config(), config.get_quic_max_datagram_size());
+            quiche_config_set_max_send_udp_payload_size             (config.get_quic_config(), config.get_quic_max_datagram_size());
+            quiche_config_set_initial_max_data                      (config.get_quic_config(), config.get_quic_initial_max_data());
+            quiche_config_set_initial_max_stream_data_bidi_local    (config.get_quic_config(), config.get_quic_initial_max_stream_data_bidi_local());
+            quiche_config_set_initial_max_stream_data_bidi_remote   (config.get_quic_config(), config.get_quic_initial_max_stream_data_bidi_remote());
+            quiche_config_set_initial_max_stream_data_uni           (config.get_quic_config(), config.get_quic_initial_max_stream_data_uni());
+            quiche_config_set_initial_max_streams_bidi              (config.get_quic_config(), config.get_quic_initial_max_streams_bidi());
+            quiche_config_set_initial_max_streams_uni               (config.get_quic_config(), config.get_quic_initial_max_streams_uni());
+            quiche_config_set_max_connection_window                 (config.get_quic_config(), config.get_quic_max_connection_window());
+            quiche_config_set_max_stream_window                     (config.get_quic_config(), config.get_quic_max_stream_window());
             quiche_config_set_disable_active_migration              (config.get_quic_config(), true);
+            quiche_config_discover_pmtu                             (config.get_quic_config(), config.is_quic_discover_pmtu());
+
+            if (config.get_quic_dgram_config().enabled)
+            {
+                quiche_config_enable_dgram                          (config.get_quic_config(), true, config.get_quic_dgram_config().recv_queue_len, config.get_quic_dgram_config().send_queue_len);
+            }
             quiche_config_enable_early_data                         (config.get_quic_config());
 
             if (config.get_quic_cc_algo() != versions::QUIC_CC_NONE) {
@@ -345,6 +457,9 @@ int manapi::net::http_pool::_pool() {
             THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid quic_implement: {}", config.get_quic_implement());
         }
 
+        // the retry and the version negotiation packets
+        quic_out = std::make_unique<uint8_t[]>(config.get_quic_max_datagram_size());
+
         ev_io->set <http_pool, &http_pool::new_connection_quic> (this);
     }
     else
@@ -352,6 +467,11 @@ int manapi::net::http_pool::_pool() {
         THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid http_implement: {}", config.get_http_implement());
     }
 
+    metrics_collector = site->get_metrics().add_collector([this] (metrics::writer &out) -> void { collect_metrics(out); });
+
+    // ticket rotation, OCSP refresh, the sweeps of the rate limiter
+    start_timers();
+
     // create watcher
     ev_io->start(config.get_socket_fd(), ev::READ);
 
@@ -364,7 +484,8 @@ int manapi::net::http_pool::_pool() {
 
 void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
     uint8_t buff[65535];
-    uint8_t out[MANAPI_MAX_DATAGRAM_SIZE];
+    uint8_t *out = quic_out.get();
+    const size_t out_size = config.get_quic_max_datagram_size();
 
     while (true) {
         ssize_t buff_size = sizeof (buff);
@@ -388,6 +509,8 @@ void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
             MANAPI_LOG("failed to read: recvfrom(...) = {}", buff_size);
             return;
         }
+
+        site->get_metrics().bytes_in.add(buff_size);
         {
             uint8_t     type;
             uint32_t    version;
@@ -421,17 +544,31 @@ void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
             manapi::net::http_quic_conn_io *conn_io = nullptr;
             if (!quic_map_conns.contains(dcid_str))
             {
-                MANAPI_LOG("connections: {} ({})", quic_map_conns.size() + 1, dcid_str);
+                const size_t connections_count = quic_map_conns.size();
                 // UNLOCK UNORDERED MAP
                 unlock_quic_map_conns.call();
 
+                // the pool is full, drop the packet without any response (the client will retry or give up)
+                if (config.get_quic_max_connections() != 0 && connections_count >= config.get_quic_max_connections())
+                {
+                    continue;
+                }
+
+                // the streams wait too long in the queue, the new connections are dropped
+                if (is_overloaded(2))
+                {
+                    continue;
+                }
+
+                MANAPI_LOG("connections: {} ({})", connections_count + 1, dcid_str);
+
                 // no connections in the history
                 if (!quiche_version_is_supported(version)) {
                     MANAPI_LOG("version negotiation: {}", version);
 
                     const ssize_t written = quiche_negotiate_version(s_cid, s_cid_len,
                                                                d_cid, d_cid_len,
-                                                               out, sizeof(out));
+                                                               out, out_size);
 
                     if (written < 0)
                     {
@@ -451,6 +588,8 @@ void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
                         continue;
                     }
 
+                    site->get_metrics().bytes_out.add(sent);
+
                     // fprintf(stderr, "sent %zd bytes\n", sent);
                     continue;
                 }
@@ -473,7 +612,7 @@ void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
                                                    d_cid, d_cid_len,
                                                    new_cid, MANAPI_QUIC_CONNECTION_ID_LEN,
                                                    token, token_len,
-                                                   version, out, sizeof(out));
+                                                   version, out, out_size);
 
                     if (written < 0)
                     {
@@ -491,6 +630,8 @@ void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
                         continue;
                     }
 
+                    site->get_metrics().bytes_out.add(sent);
+
                     // -printf(" -> sent %zd bytes\n", sent);
                     continue;
                 }
@@ -501,12 +642,26 @@ void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
                     continue;
                 }
 
+                // the new connections of the client are over the rate, drop the packet,
+                // the address is validated, so the retry round-trip is not charged
+                if (const auto &limiter = config.get_rate_limiter(); limiter != nullptr)
+                {
+                    rate_limiter::key_t client_key;
+
+                    if (rate_limiter::make_key(reinterpret_cast<const sockaddr *>(&client), client_key) && !limiter->allow(client_key))
+                    {
+                        continue;
+                    }
+                }
+
                 conn_io = http_task::quic_create_connection(d_cid, d_cid_len, od_cid, od_cid_len, config.get_socket_fd(), client, client_len, &config, site, &quic_map_conns).get();
 
                 if (conn_io == nullptr)
                 {
                     continue;
                 }
+
+                site->get_metrics().accepted.add();
                 if (!conn_io->is_responsing) { new_connection_pool = true; conn_io->is_responsing = true; }
                 MANAPI_LOG("new connection: {}", dcid_str);
             }
@@ -537,21 +692,271 @@ void manapi::net::http_pool::new_connection_quic(ev::io &watcher, int revents) {
 void manapi::net::http_pool::new_connection_tls(ev::io &watcher, int revents) {
     struct sockaddr_storage client{};
     socklen_t len = sizeof(client);
-    int conn_fd = accept(config.get_socket_fd(), reinterpret_cast<struct sockaddr *>(&client), &len);
+    // the handshake and the request head are read by the loop
+    int conn_fd = accept4(config.get_socket_fd(), reinterpret_cast<struct sockaddr *>(&client), &len, SOCK_NONBLOCK);
 
     if (conn_fd < 0)
     {
         return;
     }
 
-    auto ta = std::make_unique<http_task>(conn_fd, reinterpret_cast<const sockaddr &>(client), len, site, &config, CONN_TCP);
+    const auto &limiter = config.get_rate_limiter();
+    rate_limiter::key_t client_key;
+
+    const bool limited = limiter != nullptr && rate_limiter::make_key(reinterpret_cast<const sockaddr *>(&client), client_key);
+    // the connection is not counted if the table of the limiter is full
+    bool counted = false;
+
+    if (limited)
+    {
+        if (!limiter->connect(client_key, counted))
+        {
+            close(conn_fd);
+            return;
+        }
+
+        if (!limiter->allow(client_key))
+        {
+            if (counted)
+            {
+                limiter->disconnect(client_key);
+            }
+
+            if (!config.get_ssl_config().enabled)
+            {
+                // before any parsing, the answer fits the socket buffer
+                static constexpr char too_many_requests[] = "HTTP/1.1 429 Too Many Requests\r\nconnection: close\r\ncontent-length: 0\r\nretry-after: 1\r\n\r\n";
+
+                send(conn_fd, too_many_requests, sizeof (too_many_requests) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            }
+
+            close(conn_fd);
+            return;
+        }
+    }
+
+    if (is_overloaded(1))
+    {
+        // the queued connections wait too long, the new ones get the fast answer
+        if (!config.get_ssl_config().enabled)
+        {
+            static constexpr char service_unavailable[] = "HTTP/1.1 503 Service Unavailable\r\nconnection: close\r\ncontent-length: 0\r\nretry-after: 1\r\n\r\n";
+
+            send(conn_fd, service_unavailable, sizeof (service_unavailable) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+        }
+
+        if (counted)
+        {
+            limiter->disconnect(client_key);
+        }
+
+        close(conn_fd);
+        return;
+    }
+
+    auto conn = std::make_unique<tcp_pending_conn>(loop);
+
+    conn->pool = this;
+    conn->fd = conn_fd;
+    conn->task = std::make_unique<http_task>(conn_fd, reinterpret_cast<const sockaddr &>(client), len, site, &config, CONN_TCP);
+
+    if (counted)
+    {
+        // the connection is counted until the task is deleted
+        conn->task->set_conn_limiter(limiter, client_key);
+    }
 
     if (config.get_ssl_config().enabled)
     {
-        ta->ssl = SSL_new(config.get_openssl_ctx());
+        conn->task->ssl = SSL_new(config.get_openssl_ctx());
+
+        SSL_set_fd(conn->task->ssl, conn_fd);
+    }
+
+    conn->io.set <&http_pool::tcp_pending_io> (conn.get());
+    conn->timer.set <&http_pool::tcp_pending_timeout> (conn.get());
+
+    // slow clients can not keep the connection longer than recv_timeout
+    conn->timer.start(static_cast<ev_tstamp>(config.get_recv_timeout()));
+
+    const auto ptr = conn.get();
+
+    tcp_pending[conn_fd] = std::move(conn);
+
+    // the data can be already in the socket
+    tcp_pending_step(ptr);
+}
+
+void manapi::net::http_pool::tcp_pending_io(ev::io &watcher, int revents) {
+    const auto conn = static_cast<tcp_pending_conn *>(watcher.data);
+
+    conn->pool->tcp_pending_step(conn);
+}
+
+void manapi::net::http_pool::tcp_pending_timeout(ev::timer &watcher, int revents) {
+    const auto conn = static_cast<tcp_pending_conn *>(watcher.data);
+
+    MANAPI_LOG("the handshake or the request head timeout: {}", conn->fd);
+
+    if (conn->in_crypto)
+    {
+        // the crypto thread uses the connection, it is removed after the job
+        conn->expired = true;
+        return;
+    }
+
+    conn->pool->tcp_pending_remove(conn, false);
+}
+
+void manapi::net::http_pool::tcp_pending_step(tcp_pending_conn *conn) {
+    // the private key operations of the handshake are offloaded
+    if (crypto != nullptr && !conn->task->is_tcp_handshaked())
+    {
+        conn->io.stop();
+        conn->in_crypto = true;
+
+        const bool appended = crypto->append([this, conn] () -> void {
+            const int status = tcp_pending_prepare(conn);
+
+            {
+                std::lock_guard<std::mutex> lk (m_crypto);
+
+                crypto_done.emplace_back(conn, status);
+            }
+
+            crypto_async->send();
+        });
+
+        if (!appended)
+        {
+            MANAPI_LOG("the crypto queue is full, the handshake is dropped: {}", conn->fd);
+
+            conn->in_crypto = false;
+            tcp_pending_remove(conn, false);
+        }
+
+        return;
+    }
+
+    tcp_pending_apply(conn, tcp_pending_prepare(conn));
+}
+
+int manapi::net::http_pool::tcp_pending_prepare(tcp_pending_conn *conn) {
+    try
+    {
+        return conn->task->tcp_prepare();
+    }
+    catch (const std::exception &e)
+    {
+        MANAPI_LOG("tcp prepare failed: {}", e.what());
+
+        return TCP_PREPARE_FAILED;
+    }
+}
+
+void manapi::net::http_pool::tcp_pending_apply(tcp_pending_conn *conn, const int &status) {
+    switch (status)
+    {
+        case TCP_PREPARE_WANT_READ:
+        case TCP_PREPARE_WANT_WRITE:
+        {
+            const int events = status == TCP_PREPARE_WANT_READ ? ev::READ : ev::WRITE;
+
+            if (!conn->io.is_active() || conn->io.fd != conn->fd || conn->io.events != events)
+            {
+                conn->io.stop();
+                conn->io.start(conn->fd, events);
+            }
+
+            break;
+        }
+        case TCP_PREPARE_WANT_ASYNC:
+        {
+            // the engine signals the async fd when the job can be resumed
+            OSSL_ASYNC_FD fds[1];
+            size_t count = 0;
+
+            if (!SSL_get_all_async_fds(conn->task->ssl, nullptr, &count) || count != 1 || !SSL_get_all_async_fds(conn->task->ssl, fds, &count))
+            {
+                tcp_pending_remove(conn, false);
+                break;
+            }
+
+            conn->io.stop();
+            conn->io.start(fds[0], ev::READ);
+
+            break;
+        }
+        case TCP_PREPARE_DONE:
+            tcp_pending_remove(conn, true);
+            break;
+        default:
+            tcp_pending_remove(conn, false);
+    }
+}
+
+void manapi::net::http_pool::crypto_completed(ev::async &watcher, int revents) {
+    std::deque<std::pair<tcp_pending_conn *, int> > done;
+
+    {
+        std::lock_guard<std::mutex> lk (m_crypto);
+
+        done.swap(crypto_done);
+    }
+
+    for (const auto &[conn, status]: done)
+    {
+        conn->in_crypto = false;
+
+        if (conn->expired)
+        {
+            tcp_pending_remove(conn, false);
+            continue;
+        }
+
+        tcp_pending_apply(conn, status);
     }
+}
+
+const std::unique_ptr<manapi::net::tls::crypto_pool> &manapi::net::http_pool::get_crypto_pool() const {
+    return crypto;
+}
+
+void manapi::net::http_pool::tcp_pending_remove(tcp_pending_conn *conn, const bool &dispatch) {
+    conn->io.stop();
+    conn->timer.stop();
+
+    auto task = std::move(conn->task);
+
+    // conn is deleted here
+    tcp_pending.erase(conn->fd);
+
+    if (dispatch)
+    {
+        if (!task->is_tcp_h2())
+        {
+            get_site().append_task(std::move(task), 1);
+            return;
+        }
+
+        // the http2 connection blocks its thread for the whole life of the socket
+        // and its streams are the tasks of the pool, so it gets the own thread
+        if (h2_connections->fetch_add(1, std::memory_order_relaxed) >= config.get_http2_max_connections())
+        {
+            h2_connections->fetch_sub(1, std::memory_order_relaxed);
+
+            task->tcp_close();
+            return;
+        }
+
+        task->set_h2_connections(h2_connections);
 
-    get_site().append_task(std::move(ta), 1);
+        get_site().append_task(std::move(task), static_cast<int>(get_site().get_tasks_pool()->get_queues_count()));
+    }
+    else
+    {
+        task->tcp_close();
+    }
 }
 
 manapi::net::site & manapi::net::http_pool::get_site() const {
@@ -559,13 +964,174 @@ manapi::net::site & manapi::net::http_pool::get_site() const {
 }
 
 void manapi::net::http_pool::ssl_configure_context() {
-    if (SSL_CTX_use_certificate_file(config.get_openssl_ctx(), config.get_ssl_config().cert.data(), SSL_FILETYPE_PEM) <= 0)
+    SSL_CTX *ctx = config.get_openssl_ctx();
+    const auto &ssl_config = config.get_ssl_config();
+
+    // the chain contains the issuer for the OCSP stapling
+    if (SSL_CTX_use_certificate_chain_file(ctx, ssl_config.cert.data()) <= 0)
     {
         THROW_MANAPI_EXCEPTION(ERR_EXTERNAL_LIB_CRASH, "{}", "cannot use cert file openssl");
     }
 
-    if (SSL_CTX_use_PrivateKey_file(config.get_openssl_ctx(), config.get_ssl_config().key.data(), SSL_FILETYPE_PEM) <= 0)
+    if (SSL_CTX_use_PrivateKey_file(ctx, ssl_config.key.data(), SSL_FILETYPE_PEM) <= 0)
     {
         THROW_MANAPI_EXCEPTION(ERR_EXTERNAL_LIB_CRASH, "{}", "cannot use private key file openssl");
     }
+
+    // session cache
+    static const unsigned char session_id_context[] = "manapi-http";
+
+    SSL_CTX_set_session_id_context(ctx, session_id_context, sizeof (session_id_context) - 1);
+    SSL_CTX_set_timeout(ctx, static_cast<long>(ssl_config.session_timeout));
+
+    if (ssl_config.session_cache > 0)
+    {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(ctx, static_cast<long>(ssl_config.session_cache));
+    }
+    else
+    {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    }
+
+    // session tickets
+    if (ssl_config.session_tickets)
+    {
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, tls::ticket_keys::callback);
+    }
+    else
+    {
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    }
+
+    // 0-RTT
+    SSL_CTX_set_max_early_data(ctx, ssl_config.early_data);
+    SSL_CTX_set_recv_max_early_data(ctx, ssl_config.early_data);
+
+    // OCSP
+    if (ssl_config.ocsp.enabled)
+    {
+        ocsp_stapler = std::make_shared<tls::ocsp_stapler>(ssl_config.ocsp);
+        ocsp_stapler->attach(ctx);
+    }
+}
+
+bool manapi::net::http_pool::is_overloaded(const size_t &level) const {
+    return config.get_admission_target() > 0 && site->get_tasks_pool()->is_overloaded(level);
+}
+
+void manapi::net::http_pool::start_timers() {
+    {
+        std::lock_guard<std::mutex> lk (timers->mutex);
+
+        timers->running = true;
+    }
+
+    if (const auto &limiter = config.get_rate_limiter(); limiter != nullptr)
+    {
+        // the timer tasks can outlive the pool
+        const auto sweeping = limiter;
+
+        repeat_timer(site, timers, &timers_t::limiter_timer, std::chrono::seconds(limiter->get_config().sweep), [sweeping] () -> void { sweeping->sweep(); });
+    }
+
+    if (config.get_http_implement() != "tls" || !config.get_ssl_config().enabled)
+    {
+        return;
+    }
+
+    const auto &ssl_config = config.get_ssl_config();
+
+    if (ssl_config.session_tickets)
+    {
+        // the old keys decrypt the tickets until the session timeout
+        const size_t max_keys = ssl_config.session_timeout / ssl_config.ticket_rotation + 2;
+
+        repeat_timer(site, timers, &timers_t::ticket_timer, std::chrono::seconds(ssl_config.ticket_rotation), [max_keys, interval = std::chrono::seconds(ssl_config.ticket_rotation)] () -> void {
+            tls::ticket_keys::shared().rotate(interval, max_keys);
+        });
+    }
+
+    if (ocsp_stapler != nullptr)
+    {
+        // the timer tasks can outlive the context
+        const auto stapler = ocsp_stapler;
+
+        const std::chrono::seconds refresh (ssl_config.ocsp.refresh);
+
+        // the task can not re-arm the timer before the id is stored
+        std::lock_guard<std::mutex> lk (timers->mutex);
+
+        // the first response is loaded in the background, the handshakes go without it until then
+        timers->ocsp_timer = site->append_timer(std::chrono::milliseconds(0), [site = site, timers = timers, stapler, refresh] () -> void {
+            stapler->refresh();
+
+            repeat_timer(site, timers, &timers_t::ocsp_timer, refresh, [stapler] () -> void { stapler->refresh(); });
+        });
+    }
+}
+
+void manapi::net::http_pool::repeat_timer(class site *site, const std::shared_ptr<timers_t> &timers, size_t timers_t::*timer_id, const std::chrono::milliseconds &interval, const std::function<void()> &task) {
+    std::lock_guard<std::mutex> lk (timers->mutex);
+
+    if (!timers->running)
+    {
+        return;
+    }
+
+    (*timers).*timer_id = site->append_timer(interval, [site, timers, timer_id, interval, task] () -> void {
+        task();
+
+        repeat_timer(site, timers, timer_id, interval, task);
+    });
+}
+
+void manapi::net::http_pool::collect_metrics(metrics::writer &out) {
+    const std::string labels = metrics::label("pool", std::to_string(id));
+
+    if (crypto != nullptr)
+    {
+        const auto stats = crypto->get_stats();
+
+        out.add_gauge("manapi_crypto_queued", "The handshake steps waiting for the thread.", static_cast<double>(stats.queued), labels);
+        out.add_counter("manapi_crypto_completed_total", "The handshake steps in the crypto pool.", static_cast<double>(stats.completed), labels);
+        out.add_counter("manapi_crypto_rejected_total", "The handshake steps over the queue.", static_cast<double>(stats.rejected), labels);
+    }
+
+    if (const auto &buffers = config.get_buffer_pool(); buffers != nullptr)
+    {
+        const auto stats = buffers->get_stats();
+
+        out.add_gauge("manapi_buffer_pool_capacity", "The buffers of the pool.", static_cast<double>(stats.capacity), labels);
+        out.add_counter("manapi_buffer_pool_hits_total", "The buffers from the pool.", static_cast<double>(stats.hits), labels);
+        out.add_counter("manapi_buffer_pool_misses_total", "The buffers from the heap.", static_cast<double>(stats.misses), labels);
+    }
+
+    if (const auto &limiter = config.get_rate_limiter(); limiter != nullptr)
+    {
+        out.add_counter("manapi_rate_limit_rejected_total", "The requests and the connections over the limits.", static_cast<double>(limiter->get_rejected()), labels);
+    }
+
+    if (config.get_http_implement() == "quic")
+    {
+        auto unwrap = quic_map_conns.lock_guard();
+
+        out.add_gauge("manapi_quic_connections", "The open QUIC connections.", static_cast<double>(quic_map_conns.size()), labels);
+    }
+}
+
+void manapi::net::http_pool::stop_timers() {
+    std::lock_guard<std::mutex> lk (timers->mutex);
+
+    if (!timers->running)
+    {
+        return;
+    }
+
+    // the tasks in flight see it and do not re-arm
+    timers->running = false;
+
+    site->remove_timer(timers->ticket_timer);
+    site->remove_timer(timers->ocsp_timer);
+    site->remove_timer(timers->limiter_timer);
 }
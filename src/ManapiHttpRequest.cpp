@@ -1,13 +1,13 @@
 #include <format>
 #include <fstream>
 #include <memory.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "ManapiTaskHttp.hpp"
 #include "ManapiHttpRequest.hpp"
 
 #include "ManapiJsonBuilder.hpp"
 
-const std::string SPECIAL_SYMBOLS_BOUNDARY = "\r\n--";
-
 manapi::net::http_request::http_request(const manapi::net::utils::manapi_socket_information &_ip_data, manapi::net::request_data_t &_request_data, void* _http_task, class config *config, const void *_handler)
 {
     this->config = config;
@@ -16,16 +16,9 @@ manapi::net::http_request::http_request(const manapi::net::utils::manapi_socket_
     request_data    = &_request_data;
     http_task       = _http_task;
     page_handler    = _handler;
-
-    buff_extra      = nullptr;
 }
 
-manapi::net::http_request::~http_request() {
-    if (buff_extra != nullptr)
-    {
-        delete[] buff_extra;
-    }
-}
+manapi::net::http_request::~http_request() = default;
 
 const manapi::net::utils::manapi_socket_information &manapi::net::http_request::get_ip_data() const {
     return *ip_data;
@@ -78,19 +71,21 @@ std::string manapi::net::http_request::text() {
 
     std::string body;
 
-    if (request_data->body_size > max_plain_body_size)
+    if (request_data->body_size != SIZE_MAX && request_data->body_size > max_plain_body_size)
     {
         THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_SO_LONG, "plain body can have only {} length", max_plain_body_size);
     }
 
-    body.resize(request_data->body_size);
+    // the size is unknown until the end of the stream
+    body.reserve(request_data->body_size != SIZE_MAX ? request_data->body_size : 0);
 
-    size_t j                    = 0;
-    //size_t socket_block_size    = http_server->get_socket_block_size();
+    _read_body([this, &body] (const char *data, const size_t &size) -> void {
+        if (body.size() + size > max_plain_body_size)
+        {
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_SO_LONG, "plain body can have only {} length", max_plain_body_size);
+        }
 
-    _read_body([&body, &j] (const char *data, const size_t &size) -> void {
-        memcpy (body.data() + j, data, size);
-        j += size;
+        body.append(data, size);
     });
 
     return body;
@@ -98,9 +93,18 @@ std::string manapi::net::http_request::text() {
 
 manapi::json manapi::net::http_request::json()
 {
-    // TODO: check with json_mask during processing read_mask()
     const auto &post_mask = get_post_mask();
-    json_builder builder (*post_mask);
+
+    if (request_data->has_body && request_data->body_size <= max_plain_body_size)
+    {
+        // the whole body fits -> the indexed parser, the mask is checked on the tape,
+        // so the invalid payloads do not build the tree of the nodes
+        return json_tape().root().to_json();
+    }
+
+    // the compiled rules check the stream while it is read
+    const json_mask no_mask = nullptr;
+    json_builder builder (post_mask != nullptr ? *post_mask : no_mask);
     _read_body([&builder] (const char *data, const size_t &size) -> void {
         builder << std::string_view (data, size);
     });
@@ -108,6 +112,20 @@ manapi::json manapi::net::http_request::json()
     return std::move(builder.get());
 }
 
+manapi::json_tape manapi::net::http_request::json_tape()
+{
+    manapi::json_tape tape (text());
+
+    const auto &post_mask = get_post_mask();
+
+    if (post_mask != nullptr && post_mask->is_enabled() && !post_mask->valid(tape.root()))
+    {
+        throw json_parse_exception(ERR_JSON_MASK_VERIFY_FAILED, "json_mask error");
+    }
+
+    return tape;
+}
+
 manapi::net::utils::MAP_STR_STR manapi::net::http_request::form ()
 {
     if (!request_data->has_body)
@@ -133,113 +151,32 @@ manapi::net::utils::MAP_STR_STR manapi::net::http_request::form ()
             THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_BOUNDARY_MISSING, "{}", "boundary not found");
         }
 
-        body_boundary = SPECIAL_SYMBOLS_BOUNDARY + header[0].params.at("boundary");
-
-        // the pointer to value of the param in a map params
-        std::string *value_ptr;
-        bool        next = true;
+        multipart = std::make_unique<multipart_reader>(header[0].params.at("boundary"), [this] () { return _next_body_part(); }, config->get_max_header_block_size());
 
-        buff_extra = new char[std::max(4096UL,  config->get_socket_block_size() * 4)];
+        multipart_part_t part;
 
-        while (next)
+        while (multipart->next_part(part))
         {
-            next = false;
+            if (part.is_file)
+            {
+                // the data of the file is read by set_file
+                set_file_data (part);
+
+                break;
+            }
 
-            this->multipart_read_param([&](const char *buff, const size_t &si) {
-                chars2string (*value_ptr, buff, si);
-            },[&params, &value_ptr, &next](const std::string &name) {
-                params.insert({name, ""});
+            std::string &value = params[part.name];
 
-                value_ptr   = &params[name];
-                next        = true;
+            multipart->read_data([&value] (const char *buff, const size_t &si) {
+                chars2string (value, buff, si);
             });
         }
     }
     else if (*content_type == HTTP_MIME.APPLICATION_X_WWW_FORM_URLENCODED)
     {
-        request_data->body_part = std::min (request_data->body_part, request_data->body_left);
-
-        std::string key, value;
-
-        std::string *current = &key;
-
-        buff_extra = new char[2];
-
-        size_t  size_extra  = 0;
-        bool    used_extra  = false;
-
-        for (; request_data->body_index < request_data->body_left; request_data->body_index++) {
-            if (request_data->body_index >= request_data->body_part) {
-                // get the next data
-                request_data->body_part = manapi::net::http_task::read_next_part (request_data->body_left, request_data->body_index, http_task, request_data);
-                if (request_data->body_part == 0)
-                {
-                    break;
-                }
-
-                request_data->body_part       = std::min (request_data->body_part, request_data->body_left);
-            }
-
-            if (used_extra) {
-                buff_extra[size_extra] = request_data->body_ptr[request_data->body_index];
-                size_extra++;
-
-                if (size_extra == 2) {
-                    const char c = (char) (manapi::net::utils::hex2dec(buff_extra[0]) << 4 | manapi::net::utils::hex2dec(buff_extra[1]));
-
-                    if (manapi::net::utils::valid_special_symbol(c))
-                    {
-                        (*current)  += c;
-                    }
-                    else {
-                        current->push_back('%');
-
-                        *current += buff_extra[0];
-                        *current += buff_extra[1];
-                    }
-
-                    size_extra  = 0;
-                    used_extra  = false;
-                }
-
-                continue;
-            }
-
-            if (request_data->body_ptr[request_data->body_index] == '%') {
-                used_extra = true;
-
-                continue;
-            }
-
-            else if (request_data->body_ptr[request_data->body_index] == '=') {
-                current = &value;
-
-                continue;
-            }
-
-            else if (request_data->body_ptr[request_data->body_index] == '&') {
-                params.insert({key, value});
-                key     = "";
-                value   = "";
-
-                current = &key;
+        const std::string body = text();
 
-                continue;
-            }
-
-            else if (request_data->body_ptr[request_data->body_index] == '+') {
-                *current += ' ';
-
-                continue;
-            }
-
-            *current += request_data->body_ptr[request_data->body_index];
-        }
-
-        if (!value.empty() || !key.empty())
-        {
-            params.insert({key, value});
-        }
+        params = utils::url_params (body).to_map();
     }
     else
     {
@@ -280,263 +217,6 @@ bool manapi::net::http_request::has_file() const {
     return file_data.exists;
 }
 
-void manapi::net::http_request::buff_to_extra_buff(const request_data_t *req_data, const size_t &start, const size_t &end, char *dest, size_t &size) {
-    const size_t size2copy = end - start;
-    memcpy (dest + size, req_data->body_ptr + start, size2copy);
-    size += size2copy;
-}
-
-void manapi::net::http_request::multipart_read_param (const std::function<void(const char *, const size_t &)> &send_line, const std::function<void(const std::string &)> &send_name) {
-    size_t  size_extra      = 0;
-
-    request_data->body_part = std::min(request_data->body_part, request_data->body_left);
-
-    bool        value       = false;
-    bool        new_line    = false;
-    bool        is_boundary = false;
-
-    std::string name;
-
-    if (file_data.exists)
-    {
-        value               = true;
-    }
-
-    // the start of the string
-    size_t checkpoint       = request_data->body_index;
-
-    // boundary size which equal
-    size_t boundary_index   = first_line ? 2 : 0;
-
-    // if it is a first line in the body
-    if (first_line)
-    {
-        first_line = false;
-    }
-
-    for (;request_data->body_index < request_data->body_left; request_data->body_index++)
-    {
-        if (request_data->body_index >= request_data->body_part)
-        {
-            // bcz the file can be massive, and not to must contains any delimiter (\r\n), we break it by block size
-            if (file_data.exists && name.empty())
-            {
-                if (boundary_index > 0)
-                {
-                    buff_to_extra_buff(request_data, checkpoint, request_data->body_index, buff_extra, size_extra);
-                }
-
-                else
-                {
-
-                    if (size_extra > 0)
-                    {
-                        send_line(buff_extra, size_extra);
-
-                        size_extra = 0;
-                    }
-
-                    send_line(request_data->body_ptr + sizeof(char) * checkpoint,
-                              request_data->body_index - checkpoint);
-                }
-            }
-
-            else
-            {
-                // dont +1 bcz body_index == socket block size
-                buff_to_extra_buff (request_data, checkpoint, request_data->body_index, buff_extra, size_extra);
-            }
-
-            request_data->body_part = manapi::net::http_task::read_next_part (request_data->body_left, request_data->body_index, http_task, request_data);
-            request_data->body_part = std::min(request_data->body_part, request_data->body_left);
-
-            // read next block
-            if (request_data->body_part == 0)
-            {
-                break;
-            }
-
-            checkpoint = 0;
-        }
-
-        if (is_boundary)
-        {
-            // calc --{BOUNDARY}--
-
-            // calc --{BOUNDARY}
-
-
-
-            if (boundary_index == 0)
-            {
-                is_boundary = false;
-
-                if (value)
-                {
-                    if (size_extra > 0)
-                    {
-                        buff_to_extra_buff (request_data, checkpoint, request_data->body_index, buff_extra, size_extra);
-                        const size_t result_size = size_extra - body_boundary.size() - 2;
-
-                        send_line (buff_extra, result_size);
-                    }
-                    else
-                    {
-                        size_t size_str = request_data->body_index - checkpoint - body_boundary.size() - 2;
-
-                        send_line (request_data->body_ptr + sizeof (char) * checkpoint, size_str);
-                    }
-
-                    break;
-                }
-
-                checkpoint  = request_data->body_index;
-                size_extra  = 0;
-                if (request_data->body_size - 2 == request_data->body_index) { request_data->body_index+=2; }
-            }
-            else
-            {
-                boundary_index--;
-            }
-
-            continue;
-        }
-
-        repeat:
-
-        if (new_line)
-        {
-            new_line = false;
-
-
-            size_t size_str = request_data->body_index + size_extra;
-            if (size_str < checkpoint + 2) {
-                THROW_MANAPI_EXCEPTION(ERR_FATAL, "BUG: size_str < {}.", 0);
-            }
-            size_str = size_str - checkpoint - 2;
-
-            if (!name.empty() && size_str == 0 && !value)
-            {
-                if (file_data.exists)
-                {
-                    break;
-                }
-
-
-                value = true;
-
-                checkpoint = request_data->body_index;
-                size_extra = 0;
-
-                goto repeat;
-            }
-
-            std::string line;
-
-            // which buff contains \r or \n symbols ?
-            const bool  first   = request_data->body_index < 2,
-                        second  = request_data->body_index < 1;
-
-            if (size_extra < first + second)
-            {
-                THROW_MANAPI_EXCEPTION(ERR_FATAL, "{}", "Size of the extra buffer eq -1. Maybe the recv data was not provided?");
-            }
-
-            chars2string(line, buff_extra, size_extra - (first + second));
-
-            chars2string(line, request_data->body_ptr + sizeof (char) * checkpoint, request_data->body_index - checkpoint + first + second - 2);
-
-            const auto parsed_header = utils::parse_header(line);
-            const auto header_value = utils::parse_header_value(parsed_header.second);
-
-            if (parsed_header.first == HTTP_HEADER.CONTENT_DISPOSITION)
-            {
-                if (header_value.empty())
-                {
-                    THROW_MANAPI_EXCEPTION(ERR_HTTP_IMPORTANT_HEADER_MISSING, "header value is empty: {}", HTTP_HEADER.CONTENT_DISPOSITION);
-                }
-
-                if (header_value[0].params.contains("name"))
-                {
-                    name        = header_value[0].params.at("name");
-                }
-
-
-                if (header_value[0].params.contains("filename"))
-                {
-                    file_data.exists        = true;
-
-                    file_data.file_name     = header_value[0].params.at("filename");
-                    file_data.param_name    = name;
-                }
-
-                else {
-                    if (send_name != nullptr)
-                    {
-                        send_name (name);
-                    }
-                    else
-                    {
-                        THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "{}", "the simple param can not be after the files in the body of the request");
-                    }
-                }
-            }
-
-            else if (parsed_header.first == HTTP_HEADER.CONTENT_TYPE)
-            {
-                if (header_value.empty())
-                {
-                    THROW_MANAPI_EXCEPTION(ERR_HTTP_IMPORTANT_HEADER_MISSING, "{} can not be empty", HTTP_HEADER.CONTENT_TYPE);
-                }
-
-                if (file_data.exists)
-                {
-                    file_data.mime_type     = header_value[0].value;
-                }
-            }
-
-            checkpoint  = request_data->body_index;
-            size_extra  = 0;
-        }
-
-        if (request_data->body_ptr[request_data->body_index] == body_boundary[boundary_index])
-        {
-            boundary_index ++;
-
-            if (body_boundary.size() == boundary_index)
-            {
-                boundary_index  = 2;
-                is_boundary     = true;
-
-                if (file_data.exists)
-                { file_data.exists    = false; }
-            }
-
-            continue;
-        }
-        if (boundary_index != 0)
-        {
-            // first \r\n is equal, but other is not equ -> cut
-            if (!value && boundary_index >= 2)
-            {
-                boundary_index -= 2;
-                // can back in buf
-                const size_t can_back = std::min (request_data->body_index, boundary_index);
-                const size_t to_buff = boundary_index - can_back;
-                memcpy(buff_extra + size_extra, body_boundary.data() + 2, to_buff);
-                size_extra += to_buff;
-                request_data->body_index -= can_back;
-                new_line            = true;
-            }
-
-            boundary_index = 0;
-
-            goto repeat;
-
-        }
-    }
-}
-
 std::string manapi::net::http_request::set_file_to_str() {
     std::string content;
 
@@ -553,17 +233,30 @@ void manapi::net::http_request::set_file(const std::function<void(const char *,
         THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_NOT_CONTAINS_FILE, "{}", "no file in the body of the request");
     }
 
-    for (char i = 0; i < 2; i++)
+    multipart->read_data(handler);
+
+    file_data.exists = false;
+
+    multipart_part_t part;
+
+    if (multipart->next_part(part))
     {
-        if (i == 1)
+        if (!part.is_file)
         {
-            file_data.exists = false;
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "{}", "the simple param can not be after the files in the body of the request");
         }
 
-        multipart_read_param(handler);
+        set_file_data (part);
     }
 }
 
+void manapi::net::http_request::set_file_data(const multipart_part_t &part) {
+    file_data.exists        = true;
+    file_data.file_name     = part.file_name;
+    file_data.mime_type     = part.mime_type;
+    file_data.param_name    = part.name;
+}
+
 void manapi::net::http_request::set_file_to_local (const std::string &filepath) {
     std::ofstream out (filepath);
 
@@ -605,18 +298,20 @@ bool manapi::net::http_request::has_header(const std::string &name) {
 }
 
 void manapi::net::http_request::parse_map_url_param() {
-    if (map_url_params == nullptr)
+    // the raw uri, the path segments are already decoded
+    std::string_view query = request_data->uri;
+
+    if (const size_t pos = query.find('?'); pos != std::string_view::npos)
     {
-        map_url_params = std::make_unique<std::map <std::string, std::string> >();
+        query.remove_prefix(pos + 1);
+        query = query.substr(0, query.find('#'));
     }
-
-    if (request_data->divided != -1)
+    else
     {
-        for (size_t i = request_data->divided; i < request_data->path.size(); i++)
-        {
-            std::cerr << request_data->path[i] << "\n";
-        }
+        query = {};
     }
+
+    map_url_params = std::make_unique<utils::url_params>(query);
 }
 
 const std::string &manapi::net::http_request::get_query_param(const std::string &name) {
@@ -625,14 +320,32 @@ const std::string &manapi::net::http_request::get_query_param(const std::string
         parse_map_url_param();
     }
 
-    if (map_url_params->contains(name))
+    if (const auto value = map_url_params->find(name); value != nullptr)
     {
-        return map_url_params->at(name);
+        return *value;
     }
 
     THROW_MANAPI_EXCEPTION(ERR_HTTP_QUERY_PARAM_MISSING, "Can not find query param by name: {}", name);
 }
 
+bool manapi::net::http_request::has_query_param(const std::string &name) {
+    if (map_url_params == nullptr)
+    {
+        parse_map_url_param();
+    }
+
+    return map_url_params->contains(name);
+}
+
+manapi::net::utils::VEC_STR manapi::net::http_request::get_query_params(const std::string &name) {
+    if (map_url_params == nullptr)
+    {
+        parse_map_url_param();
+    }
+
+    return map_url_params->find_all(name);
+}
+
 const std::unique_ptr<const manapi::json_mask> &manapi::net::http_request::get_post_mask() const {
     return static_cast<const http_handler_page *> (page_handler)->handler->post_mask;
 }
@@ -650,23 +363,107 @@ const bool & manapi::net::http_request::get_propagation() {
 }
 
 void manapi::net::http_request::_read_body(const std::function<void(const char *, const size_t &)> &handler) {
+    for (auto part = _next_body_part(); !part.empty(); part = _next_body_part())
+    {
+        handler (part.data(), part.size());
+    }
+}
+
+std::span<const char> manapi::net::http_request::_next_body_part() {
     request_data->body_part = std::min (request_data->body_part, request_data->body_left);
 
-    // TODO: speed up
-    while (request_data->body_index < request_data->body_left) {
-        if (request_data->body_index >= request_data->body_part) {
-            request_data->body_part = manapi::net::http_task::read_next_part (request_data->body_left, request_data->body_index, http_task, request_data);
-            if (request_data->body_part == 0)
+    if (request_data->body_index >= request_data->body_left)
+    {
+        return {};
+    }
+
+    if (request_data->body_index >= request_data->body_part)
+    {
+        request_data->body_part = manapi::net::http_task::read_next_part (request_data->body_left, request_data->body_index, http_task, request_data);
+
+        if (request_data->body_part == 0)
+        {
+            return {};
+        }
+
+        request_data->body_part       = std::min (request_data->body_part, request_data->body_left);
+    }
+
+    const std::span<const char> part (request_data->body_ptr + request_data->body_index, request_data->body_part - request_data->body_index);
+
+    request_data->body_index = request_data->body_part;
+
+    return part;
+}
+
+manapi::net::http_body_stream manapi::net::http_request::body_stream() {
+    if (!request_data->has_body)
+    {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_MISSING, "{}", "this method cannot have a body");
+    }
+
+    return http_body_stream (this);
+}
+
+void manapi::net::http_request::set_body_to_local(const std::string &filepath) {
+    if (!request_data->has_body)
+    {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_BODY_MISSING, "{}", "this method cannot have a body");
+    }
+
+    const int fd = open(filepath.data(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0)
+    {
+        THROW_MANAPI_EXCEPTION(ERR_FILE_IO, "Could not open the file by the following path: {}", filepath);
+    }
+
+    utils::before_delete bd_fd ([&fd] () -> void { close(fd); });
+
+    auto task = static_cast<class http_task *>(http_task);
+
+    while (request_data->body_index < request_data->body_left)
+    {
+        // the buffered bytes are written first
+        if (request_data->body_index < request_data->body_part || !task->can_splice())
+        {
+            const auto part = _next_body_part();
+
+            if (part.empty())
             {
                 break;
             }
 
-            request_data->body_part       = std::min (request_data->body_part, request_data->body_left);
+            for (size_t written = 0; written < part.size();)
+            {
+                const ssize_t res = write(fd, part.data() + written, part.size() - written);
+
+                if (res < 0)
+                {
+                    THROW_MANAPI_EXCEPTION(ERR_FILE_IO, "Could not write the body to the file: {}", filepath);
+                }
+
+                written += res;
+            }
+
+            continue;
         }
 
+        // the rest of the body is in the socket
+        const size_t left = request_data->body_left - request_data->body_part;
 
-        ///body[j] = request_data->body_ptr[request_data->body_index];
-        handler (request_data->body_ptr, request_data->body_part - request_data->body_index);
-        request_data->body_index = request_data->body_part;
+        task->tcp_splice(fd, left);
+
+        request_data->body_left = request_data->body_part;
     }
 }
+
+// ======================[ body stream ]==========================
+
+manapi::net::http_body_stream::http_body_stream(http_request *request) {
+    this->request = request;
+}
+
+std::span<const char> manapi::net::http_body_stream::next() {
+    return request->_next_body_part();
+}
@@ -56,7 +56,19 @@ void manapi::net::http_response::text(const std::string &plain_text) {
 
 void manapi::net::http_response::json(const class json &jp, const size_t &spaces) {
     set_header(HTTP_HEADER.CONTENT_TYPE, HTTP_MIME.APPLICATION_JSON);
-    text(jp.dump (spaces));
+
+    // straight into the body
+    data.clear();
+    jp.dump_to(data, spaces);
+
+    type            = MANAPI_HTTP_RESP_TEXT;
+}
+
+void manapi::net::http_response::json_stream(const std::function<void(manapi::json_writer &)> &handler) {
+    set_header(HTTP_HEADER.CONTENT_TYPE, HTTP_MIME.APPLICATION_JSON);
+
+    stream          = handler;
+    type            = MANAPI_HTTP_RESP_STREAM;
 }
 
 void manapi::net::http_response::set_status_code(const size_t &_status_code) {
@@ -89,6 +101,10 @@ bool manapi::net::http_response::is_proxy() const {
     return type == MANAPI_HTTP_RESP_PROXY;
 }
 
+bool manapi::net::http_response::is_stream() const {
+    return type == MANAPI_HTTP_RESP_STREAM;
+}
+
 bool manapi::net::http_response::is_no_data() const {
     return type == MANAPIHTTP_RESP_NO_DATA;
 }
@@ -228,3 +244,7 @@ void manapi::net::http_response::proxy(const std::string &url) {
 const std::string &manapi::net::http_response::get_data() {
     return data;
 }
+
+const std::function<void(manapi::json_writer &)> &manapi::net::http_response::get_stream() {
+    return stream;
+}
@@ -1,4 +1,5 @@
 #include <memory.h>
+#include <charconv>
 #include <format>
 
 #include "ManapiJson.hpp"
@@ -6,6 +7,11 @@
 #include "ManapiUnicode.hpp"
 #include "ManapiUtils.hpp"
 #include "ManapiJsonBuilder.hpp"
+#include "ManapiJsonTape.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 const static std::string JSON_TRUE   = "true";
 const static std::string JSON_FALSE  = "false";
@@ -14,6 +20,45 @@ const static std::string JSON_NULL   = "null";
 #define THROW_MANAPI_JSON_MISSING_FUNCTION this->throw_could_not_use_func(__FUNCTION__)
 #define THROW_MANAPI_JSON_ERROR(errnum, msg, ...) throw manapi::json_parse_exception (errnum, std::format(msg, __VA_ARGS__));
 
+// the index of the first char to escape (", \\, /, control) or size
+static size_t json_dump_special (const char *data, const size_t &size) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i slash     = _mm_set1_epi8('/');
+    const __m128i control   = _mm_set1_epi8(0x20);
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+
+        // signed: the bytes >= 0x80 are not the control chars
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, slash), _mm_andnot_si128(_mm_cmplt_epi8(v, _mm_setzero_si128()), _mm_cmplt_epi8(v, control))));
+
+        if (const int mask = _mm_movemask_epi8(special))
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < size; i++)
+    {
+        const auto c = static_cast<unsigned char>(data[i]);
+
+        if (c == '"' || c == '\\' || c == '/' || c < 0x20)
+        {
+            return i;
+        }
+    }
+
+    return size;
+}
+
 manapi::json::json() = default;
 
 manapi::json::json(const STRING_VIEW &str, const bool &to_parse) {
@@ -221,9 +266,8 @@ void manapi::json::parse(const NULLPTR &n) {
 }
 
 void manapi::json::parse(const STRING_VIEW &plain_text, const bool &use_bigint, const size_t &bigint_precision) {
-    json_builder builder (json_mask(nullptr), use_bigint, bigint_precision);
-    builder << plain_text;
-    *this = builder.get();
+    // the whole text is here -> the indexed parser (json_builder is for the streams)
+    *this = json_tape (plain_text, use_bigint, bigint_precision).root().to_json();
 }
 
 void manapi::json::parse(const size_t &num) {
@@ -231,126 +275,199 @@ void manapi::json::parse(const size_t &num) {
 }
 
 std::string manapi::json::dump(const size_t &spaces, const size_t &first_spaces) const {
-#define JSON_DUMP_NEED_NEW_LINE if (spaces_enabled) str += '\n';
-#define JSON_DUMP_NEED_NEW_LINE_OR_SPACE    JSON_DUMP_NEED_NEW_LINE \
-                                            else str += ' ';
-#define JSON_DUMP_NEED_SPACES   for (size_t z = 0; z < total_spaces; z++) str += ' ';
-#define JSON_DUMP_LAST_SPACES   for (size_t z = 0; z < first_spaces; z++) str += ' ';
     std::string str;
 
-    if (type == type_string)
-    {
-        str = '"' + net::utils::escape_string(as_string()) + '"';
-    }
-
-    else if (type == type_decimal)
-    {
-        str = std::to_string(as_decimal());
-    }
+    dump_to(str, spaces, first_spaces);
 
-    else if (type == type_number)
-    {
-        str = std::to_string(as_number());
-    }
+    return str;
+}
 
-    else if (type == type_bigint)
+void manapi::json::dump_to(std::string &out, const size_t &spaces, const size_t &first_spaces) const {
+    switch (type)
     {
-        str = '"' + as_bigint().stringify() + '"';
-    }
+        case type_string:
+            dump_string(out, as_string());
+            break;
+        case type_decimal:
+            dump_decimal(out, as_decimal());
+            break;
+        case type_number:
+            dump_number(out, as_number());
+            break;
+        case type_bigint:
+            out += '"';
+            out += as_bigint().stringify();
+            out += '"';
+            break;
+        case type_boolean:
+            out += as_bool() ? JSON_TRUE : JSON_FALSE;
+            break;
+        case type_null:
+            out += JSON_NULL;
+            break;
+        case type_object:
+        {
+            const bool      spaces_enabled  = spaces > 0;
+            const size_t    total_spaces    = first_spaces + spaces;
+            bool            first           = true;
 
-    else if (type == type_boolean)
-    {
-        str = as_bool() ? JSON_TRUE : JSON_FALSE;
-    }
+            out += '{';
 
-    else if (type == type_null)
-    {
-        str = JSON_NULL;
-    }
+            if (spaces_enabled)
+            {
+                out += '\n';
+            }
 
-    else if (type == type_object) {
-        const bool      spaces_enabled  = spaces > 0;
-        const size_t    total_spaces    = first_spaces + spaces;
+            // by the reference, the map is not copied
+            for (const auto &[key, value]: as_object())
+            {
+                if (!first)
+                {
+                    out += ',';
+                    out += spaces_enabled ? '\n' : ' ';
+                }
 
-        auto map = as_object();
-        str += '{';
+                first = false;
 
-        JSON_DUMP_NEED_NEW_LINE
+                out.append(total_spaces, ' ');
 
-        if (!map.empty()) {
-            auto it = map.begin();
+                dump_string(out, key);
+                out += ": ";
 
-            // first
-            if (it != map.end()) {
-                JSON_DUMP_NEED_SPACES
+                value.dump_to(out, spaces, total_spaces);
+            }
 
-                str += '"';
-                str += net::utils::escape_string(it->first) + "\": " + it->second.dump(spaces, total_spaces);
-                ++it;
+            if (spaces_enabled)
+            {
+                out += '\n';
             }
 
-            // others
-            for (; it != map.end(); ++it) {
-                str += ',';
+            out.append(first_spaces, ' ');
+            out += '}';
 
-                JSON_DUMP_NEED_NEW_LINE_OR_SPACE
-                JSON_DUMP_NEED_SPACES
+            break;
+        }
+        case type_array:
+        {
+            const bool      spaces_enabled  = spaces > 0;
+            const size_t    total_spaces    = first_spaces + spaces;
+            bool            first           = true;
+
+            out += '[';
 
-                str += '"';
-                str += net::utils::escape_string(it->first) + "\": " + it->second.dump(spaces, total_spaces);
+            if (spaces_enabled)
+            {
+                out += '\n';
             }
-        }
 
-        JSON_DUMP_NEED_NEW_LINE
+            for (const auto &item: as_array())
+            {
+                if (!first)
+                {
+                    out += ',';
+                    out += spaces_enabled ? '\n' : ' ';
+                }
 
-        JSON_DUMP_LAST_SPACES
+                first = false;
 
-        str += '}';
-    }
+                out.append(total_spaces, ' ');
 
-    else if (type == type_array) {
-        const bool      spaces_enabled  = spaces > 0;
-        const size_t    total_spaces    = first_spaces + spaces;
+                item.dump_to(out, spaces, total_spaces);
+            }
 
-        auto arr = as_array();
-        str += '[';
+            if (spaces_enabled)
+            {
+                out += '\n';
+            }
 
-        JSON_DUMP_NEED_NEW_LINE
+            out.append(first_spaces, ' ');
+            out += ']';
 
+            break;
+        }
+        case type_pair:
+            THROW_MANAPI_JSON_ERROR (ERR_JSON_BUG, "Bug has been deteceted: {}", "type = type_pair");
+        default:
+            break;
+    }
+}
 
-        if (!arr.empty()) {
-            // dump items
-            size_t i = 0;
+void manapi::json::dump_string(std::string &out, const STRING_VIEW &str) {
+    out += '"';
 
-            // first
-            JSON_DUMP_NEED_SPACES
-            str += arr.at(i).dump(spaces, total_spaces);
+    for (size_t i = 0; i < str.size();)
+    {
+        // the plain part is appended at once
+        const size_t j = i + json_dump_special(str.data() + i, str.size() - i);
 
-            i++;
+        out.append(str.data() + i, j - i);
 
-            // others
-            for (; i < arr.size(); i++) {
-                str += ',';
+        if (j == str.size())
+        {
+            break;
+        }
 
-                JSON_DUMP_NEED_NEW_LINE_OR_SPACE
-                JSON_DUMP_NEED_SPACES
+        switch (str[j])
+        {
+            case '\n':
+                out += "\\n";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '"':
+            case '\\':
+            case '/':
+                out += '\\';
+                out += str[j];
+                break;
+            default:
+            {
+                // the other control chars
+                char code[7];
 
-                str += arr.at(i).dump(spaces, total_spaces);
+                snprintf(code, sizeof (code), "\\u%04x", static_cast<unsigned char>(str[j]));
+                out.append(code, 6);
             }
         }
 
-        JSON_DUMP_NEED_NEW_LINE
-        JSON_DUMP_LAST_SPACES
-
-        str += ']';
+        i = j + 1;
     }
 
-    else if (type == type_pair)
+    out += '"';
+}
+
+void manapi::json::dump_number(std::string &out, const NUMBER &num) {
+    char buffer[24];
+
+    const auto result = std::to_chars(buffer, buffer + sizeof (buffer), num);
+
+    out.append(buffer, result.ptr);
+}
+
+void manapi::json::dump_decimal(std::string &out, const DECIMAL &num) {
+    char buffer[64];
+
+    // without the locale of std::to_string
+    const auto result = std::to_chars(buffer, buffer + sizeof (buffer), num, std::chars_format::fixed, 6);
+
+    if (result.ec != std::errc {})
     {
-        THROW_MANAPI_JSON_ERROR (ERR_JSON_BUG, "Bug has been deteceted: {}", "type = type_pair");
+        // too long for the buffer
+        out += std::to_string(num);
+        return;
     }
 
-    return str;
+    out.append(buffer, result.ptr);
 }
 
 size_t manapi::json::get_start_cut() const {
@@ -9,20 +9,28 @@ manapi::json_builder::json_builder(const json_mask &mask, const bool &use_bigint
     this->end_cut = 0;
     this->use_bigint = use_bigint;
     this->bigint_precision = bigint_precision;
-    this->current_types = mask.get_api_tree().is_null() ? nullptr : &mask.get_api_tree()["obj"];
-    this->current_type = 0;
+
+    if (mask.is_enabled())
+    {
+        // the first compiled rule is the root
+        this->mask = &mask;
+        this->base_rule = 0;
+        this->root = true;
+    }
+
+    this->rule = base_rule;
 
     action = std::bind(&json_builder::_check_type, this, std::placeholders::_1, std::placeholders::_2);
 }
 
-manapi::json_builder::
-json_builder(const json &mask, const bool &use_bigint, const size_t &bigint_precision) {
+manapi::json_builder::json_builder(const json_mask *mask, const uint32_t &rule, const bool &use_bigint, const size_t &bigint_precision) {
     this->start_cut = 0;
     this->end_cut = 0;
     this->use_bigint = use_bigint;
     this->bigint_precision = bigint_precision;
-    this->current_types = mask == nullptr ? nullptr : &mask;
-    this->current_type = 0;
+    this->mask = rule == json_mask::npos ? nullptr : mask;
+    this->base_rule = rule;
+    this->rule = rule;
 
     action = std::bind(&json_builder::_check_type, this, std::placeholders::_1, std::placeholders::_2);
 }
@@ -136,7 +144,8 @@ void manapi::json_builder::_check_type(const std::string_view &plain_text, size_
 void manapi::json_builder::_build_string(const std::string_view &plain_text, size_t &j) {
     for (; j < plain_text.size(); j++, i++)
     {
-        _check_max_mean(true);
+        // the long strings are rejected before the end
+        _check_size(buffer.size());
 
         unsigned char c = plain_text.at(j);
         if (_valid_utf_char(plain_text, j, wchar_left))
@@ -281,7 +290,7 @@ void manapi::json_builder::_build_string(const std::string_view &plain_text, siz
 
         end_cut = i;
         object = buffer;
-        _check_string();
+        _check_value();
 
         // clean up only after passing the checks
         buffer.clear();
@@ -403,7 +412,7 @@ void manapi::json_builder::_build_numeric(const std::string_view &plain_text, si
             }
         }
 
-        _check_numeric();
+        _check_value();
 
         // clean up only after passing the checks
         buffer.clear();
@@ -440,7 +449,7 @@ void manapi::json_builder::_build_numeric_string(const std::string_view &plain_t
         if (value == "true") {
             type = json::type_boolean;
             object.parse (true);
-            _check_numeric();
+            _check_value();
             return;
         }
 
@@ -448,7 +457,7 @@ void manapi::json_builder::_build_numeric_string(const std::string_view &plain_t
         if (value == "false") {
             type = json::type_boolean;
             object.parse (false);
-            _check_numeric();
+            _check_value();
             return;
         }
 
@@ -456,7 +465,7 @@ void manapi::json_builder::_build_numeric_string(const std::string_view &plain_t
         if (value == "null") {
             type = json::type_null;
             object.parse (nullptr);
-            _check_numeric();
+            _check_value();
             return;
         }
 
@@ -487,6 +496,8 @@ void manapi::json_builder::_build_object(const std::string_view &plain_text, siz
             else
             {
                 object.insert(key, std::move(it));
+
+                _check_size(object.size());
             }
 
             go_to_delimiter = true;
@@ -534,13 +545,13 @@ void manapi::json_builder::_build_object(const std::string_view &plain_text, siz
                 goto finish;
             }
 
-            if (is_key || current_types == nullptr)
+            if (is_key || rule == json_mask::npos)
             {
-                item = std::make_unique<json_builder> (json(nullptr), use_bigint, bigint_precision);
+                item = _make_item(json_mask::npos);
             }
             else
             {
-                item = std::make_unique<json_builder>(get_current_type()["data"][key]["obj"], use_bigint, bigint_precision);
+                item = _make_item(mask->field(rule, key));
             }
             goto doit;
         }
@@ -570,7 +581,7 @@ void manapi::json_builder::_build_object(const std::string_view &plain_text, siz
         is_key = true;
         key.clear();
 
-        _check_object();
+        _check_value();
 
         ready = true;
     }
@@ -591,6 +602,8 @@ void manapi::json_builder::_build_array(const std::string_view &plain_text, size
 
             object.push_back(std::move(it));
 
+            _check_size(object.size());
+
             go_to_delimiter = true;
         }
     }
@@ -637,22 +650,13 @@ void manapi::json_builder::_build_array(const std::string_view &plain_text, size
 
             // if exists default (TYPE(...)[...]) or exists ({..., ..., ...})
 
-            if (current_types == nullptr)
+            if (rule == json_mask::npos)
             {
-                item = std::make_unique<json_builder>(json(nullptr), use_bigint, bigint_precision);
+                item = _make_item(json_mask::npos);
             }
             else
             {
-                const auto &current = get_current_type();
-
-                if (current.contains("default"))
-                {
-                    item = std::make_unique<json_builder>(get_current_type()["default"], use_bigint, bigint_precision);
-                }
-                else
-                {
-                    item = std::make_unique<json_builder>(get_current_type()["data"][element_index]["obj"], use_bigint, bigint_precision);
-                }
+                item = _make_item(mask->item(rule, element_index));
             }
             element_index++;
             goto doit;
@@ -679,7 +683,7 @@ void manapi::json_builder::_build_array(const std::string_view &plain_text, size
         j++;
 
         end_cut = i;
-        _check_array();
+        _check_value();
 
         ready = true;
     }
@@ -695,208 +699,53 @@ void manapi::json_builder::_check_end(const std::string_view &plain_text, size_t
     }
 }
 
-void manapi::json_builder::_reset_type() {
-    max_mean_size = nullptr;
-    min_mean_size = nullptr;
-}
-
-void manapi::json_builder::_next_type() {
-    current_type++;
-
-    if (current_types != nullptr && current_types->is_array() && current_type < current_types->size())
-    {
-        _check_eq_type();
-        return;
-    }
-
-    throw json_parse_exception(ERR_JSON_MASK_VERIFY_FAILED, "json_mask error");
-}
-
 void manapi::json_builder::_check_eq_type() {
-    _reset_type();
-
-    if (current_types == nullptr)
-    {
-        return;
-    }
-    auto &current = get_current_type();
-    auto &current_type = current["type"].as_number();
-    if (current.contains("max_mean")) { max_mean_size = &current["max_mean"].as_number(); }
-    if (current.contains("min_mean")) { min_mean_size = &current["min_mean"].as_number(); }
-
-    if (current_type == -1)
+    if (rule == json_mask::npos)
     {
-        // this solve is better
-        current_types = nullptr;
         return;
     }
 
-    if (type == json::type_numeric)
+    // the value of the wrong type is rejected before it is built
+    if (!mask->resolve(rule, type))
     {
-        if (
-            current_type == json::type_decimal ||
-            current_type == json::type_bigint ||
-            current_type == json::type_number ||
-            current_type == json::type_boolean ||
-            current_type == json::type_null)
-        {
-            return;
-        }
-    }
-    else {
-        if (current_type == type)
-        {
-            return;
-        }
+        throw json_parse_exception(ERR_JSON_MASK_VERIFY_FAILED, "json_mask error");
     }
-
-    _next_type();
-    _check_eq_type();
 }
 
-bool manapi::json_builder::_check_max_mean(const bool &building) {
-    if (max_mean_size == nullptr) { return true; }
-
-    if (building)
+void manapi::json_builder::_check_size(const size_t &size) const {
+    if (rule != json_mask::npos && !mask->fits(rule, size))
     {
-        switch (type)
-        {
-            case json::type_string:
-                if (buffer.size() < *max_mean_size) { return true; }
-            default:
-                return true;
-        }
+        throw json_parse_exception(ERR_JSON_MASK_VERIFY_FAILED, "json_mask error");
     }
-    else
-    {
-        switch (type)
-        {
-            case json::type_string:
-                if (object.size() < *max_mean_size) { return true; }
-            break;
-            case json::type_number:
-                if (object.as_number() < *max_mean_size) { return true; }
-            break;
-            case json::type_bigint:
-                if (object.as_bigint() < *max_mean_size) { return true; }
-            break;
-            case json::type_decimal:
-                if (object.as_decimal() < *max_mean_size) { return true; }
-            break;
-            case json::type_array:
-            case json::type_object:
-                if (object.size() < *max_mean_size) { return true; }
-            break;
-            default:
-                return true;
-        }
-    }
-    _next_type();
-    return false;
-}
-
-bool manapi::json_builder::_check_min_mean() {
-    if (min_mean_size == nullptr) { return true; }
-
-    switch (type)
-    {
-        case json::type_string:
-            if (*min_mean_size < 0 || object.size() > *min_mean_size) { return true; }
-        break;
-        case json::type_number:
-            if (object.as_number() > *min_mean_size) { return true; }
-        break;
-        case json::type_bigint:
-            if (object.as_bigint() > *min_mean_size) { return true; }
-        break;
-        case json::type_decimal:
-            if (object.as_decimal() > *min_mean_size) { return true; }
-        break;
-        case json::type_array:
-        case json::type_object:
-            if (*min_mean_size < 0 || object.size() > *min_mean_size) { return true; }
-        break;
-        default:
-            return true;
-    }
-
-    _next_type();
-    return false;
 }
 
-bool manapi::json_builder::_check_type_none_complex_value() {
-    auto &current = get_current_type();
-    if (!current.contains("value"))
-    {
-        return true;
-    }
-    auto &value = current["value"];
-    if (value.is_array() || value.is_object())
+void manapi::json_builder::_check_value() const {
+    if (mask == nullptr)
     {
-        return true;
+        return;
     }
-    if ((current["value"] == object)) { return true; }
-
-    _next_type();
-    return false;
-}
 
-bool manapi::json_builder::_check_default() {
-    return (current_types == nullptr) || (_check_max_mean() && _check_min_mean() && _check_type_none_complex_value() && _check_meta_value());
-}
+    bool valid = true;
 
-bool manapi::json_builder::_check_meta_value() {
-    const auto &current = get_current_type ();
-    if (!current.contains("value")) { return true; }
-
-    if (current.at("value") == object) { return true; }
-    _next_type();
-    return false;
-}
-
-void manapi::json_builder::_check_string() {
-    while (true)
+    if (root)
     {
-        if (_check_default())
-        {
-            break;
-        }
+        // the whole document, once
+        valid = mask->check(object, 0);
     }
-}
-
-void manapi::json_builder::_check_numeric() {
-    while (true)
+    else if (rule != json_mask::npos && type != json::type_object && type != json::type_array)
     {
-        if (_check_default())
-        {
-            break;
-        }
+        // the containers are limited while building and checked by the root
+        valid = mask->check(object, rule);
     }
-}
 
-void manapi::json_builder::_check_object() {
-    while (true)
+    if (!valid)
     {
-        if (_check_default())
-        {
-            break;
-        }
+        throw json_parse_exception(ERR_JSON_MASK_VERIFY_FAILED, "json_mask error");
     }
 }
 
-void manapi::json_builder::_check_array() {
-    while (true)
-    {
-        if (_check_default())
-        {
-            break;
-        }
-    }
-}
-
-const manapi::json & manapi::json_builder::get_current_type() {
-    if (current_types->is_array()) { return current_types->at(current_type); }
-    return *current_types;
+std::unique_ptr<manapi::json_builder> manapi::json_builder::_make_item(const uint32_t &item_rule) const {
+    return std::unique_ptr<json_builder> (new json_builder (mask, item_rule, use_bigint, bigint_precision));
 }
 
 bool manapi::json_builder::_valid_utf_char(const std::string_view &plain_text, const size_t &i, size_t &left) {
@@ -951,8 +800,8 @@ void manapi::json_builder::_reset() {
     this->key.clear();
     this->exp_already = false;
     this->operate_already = false;
-
-    _reset_type();
+    this->element_index = 0;
+    this->rule = base_rule;
 
     action = std::bind(&json_builder::_check_type, this, std::placeholders::_1, std::placeholders::_2);
 }
@@ -1,9 +1,16 @@
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
 #include "ManapiJsonMask.hpp"
 #include "ManapiUtils.hpp"
 #include "ManapiJsonBuilder.hpp"
+#include "ManapiJsonTape.hpp"
 
 #define MANAPI_JSON_ANY (-1)
 #define MANAPI_JSON_NONE (-2)
+// the compiled node: one of the children
+#define MANAPI_JSON_ALTERNATIVES (-3)
 
 #define MANAPI_MASK_COMPARE_NONE (-1)
 #define MANAPI_MASK_COMPARE_EQUAL 0
@@ -20,6 +27,9 @@ manapi::json_mask::json_mask(const std::initializer_list<json> &data)
     information = data;
     initial_resolve_information (information);
 
+    // once, on the registration of the handler
+    compile (information);
+
     enabled = true;
 }
 
@@ -45,7 +55,7 @@ bool manapi::json_mask::valid(const manapi::json &obj) const
         THROW_MANAPI_JSON_ERROR2(ERR_JSON_MASK_VERIFY_FAILED, "json_mask is not enabled to valid the object.");
     }
 
-    return recursive_valid (obj, information);
+    return execute (obj, 0);
 }
 
 bool manapi::json_mask::valid(const std::map<std::string, std::string> &obj) const
@@ -55,14 +65,18 @@ bool manapi::json_mask::valid(const std::map<std::string, std::string> &obj) con
         THROW_MANAPI_JSON_ERROR2(ERR_JSON_MASK_VERIFY_FAILED, "json_mask is not enabled to valid the object.");
     }
 
-    json a = json::object();
+    // without the temporary json
+    return execute (obj, 0);
+}
 
-    for (const auto &it: obj)
+bool manapi::json_mask::valid(const json_view &obj) const
+{
+    if (!enabled)
     {
-        a.insert(it.first, it.second);
+        THROW_MANAPI_JSON_ERROR2(ERR_JSON_MASK_VERIFY_FAILED, "json_mask is not enabled to valid the object.");
     }
 
-    return recursive_valid (a, information);
+    return execute (obj, 0);
 }
 
 const manapi::json & manapi::json_mask::get_api_tree() const {
@@ -453,278 +467,536 @@ void manapi::json_mask::initial_resolve_information(manapi::json &obj)
     }
 }
 
-bool manapi::json_mask::recursive_valid(const manapi::json &obj, const manapi::json &item, const bool &is_complex) {
+uint32_t manapi::json_mask::compile(const manapi::json &item, const bool &is_complex) {
     const auto &information = is_complex ? item["obj"] : item;
 
+    // the children append their nodes, so the node is filled at the end
+    const auto index = static_cast<uint32_t>(rules.size());
+    rules.emplace_back();
+
+    rule_t rule;
+
     if (information.is_array())
     {
-        // is an array
+        std::vector<uint32_t> alternatives;
+
         for (auto it = information.begin<json::ARRAY>(); it != information.end<json::ARRAY>(); it++)
         {
-            if (recursive_valid(obj, *it, false))
+            // {none|type}: the key may be missed, the value is checked by the others
+            if (it->is_object() && !it->contains("type"))
             {
-                return true;
+                continue;
             }
+
+            alternatives.push_back(compile(*it, false));
         }
 
-        return false;
+        rule.type   = MANAPI_JSON_ALTERNATIVES;
+        rule.first  = static_cast<uint32_t>(children.size());
+        rule.count  = static_cast<uint32_t>(alternatives.size());
+
+        children.insert(children.end(), alternatives.begin(), alternatives.end());
+
+        rules[index] = rule;
+
+        return index;
     }
 
-    // information is a map
+    // {none}
+    rule.type = information.contains("type") ? information["type"].as_number() : MANAPI_JSON_NONE;
 
-    auto &type = information["type"].as_number();
+    if (information.contains("value"))
+    {
+        rule.value = static_cast<uint32_t>(values.size());
+        values.push_back(information["value"]);
+    }
+
+    if (information.contains("mean"))
+    {
+        rule.mean = static_cast<uint32_t>(values.size());
+        values.push_back(information["mean"]);
+    }
 
-    if (type == json::type_string)
+    if (rule.type == json::type_string || rule.type == json::type_object || rule.type == json::type_array)
     {
-        // invalid type
-        if (!obj.is_string())
+        // by size
+        if (information.contains("min_mean"))
         {
-            return false;
+            rule.has_min    = true;
+            rule.min        = information["min_mean"].as_number();
         }
 
-        if (!default_compare_information (obj, information))
+        if (information.contains("max_mean"))
         {
-            return false;
+            rule.has_max    = true;
+            rule.max        = information["max_mean"].as_number();
         }
+    }
+
+    if (rule.type == json::type_object && information.contains("data"))
+    {
+        std::vector<field_t> items;
 
-        // by value ex: STR1 != STR2
-        if (information.contains("value"))
+        for (const auto &[key, value]: information["data"].as_object())
         {
-            return information["value"].as_string() == obj.as_string();
+            items.push_back({key, json_tape::hash(key), compile(value), value["none"].as_bool()});
         }
 
-        // ex: {string}
-        return true;
-    }
-    if (type == json::type_null)
-    {
-        // invalid type
-        return obj.is_null();
+        rule.has_data   = true;
+        rule.first      = static_cast<uint32_t>(fields.size());
+        rule.count      = static_cast<uint32_t>(items.size());
+
+        std::move(items.begin(), items.end(), std::back_inserter(fields));
     }
-    if (type == json::type_boolean)
+    else if (rule.type == json::type_array)
     {
-        // invalid type
-        if (!obj.is_bool())
+        if (information.contains("data"))
         {
-            return false;
-        }
+            std::vector<uint32_t> items;
 
-        // false / true
-        if (information.contains("value"))
-        {
-            return obj.as_bool() == information["value"].as_bool();
+            for (const auto &value: information["data"].as_array())
+            {
+                items.push_back(compile(value));
+            }
+
+            rule.has_data   = true;
+            rule.first      = static_cast<uint32_t>(children.size());
+            rule.count      = static_cast<uint32_t>(items.size());
+
+            children.insert(children.end(), items.begin(), items.end());
         }
 
-        if (information.contains("mean"))
+        if (information.contains("default"))
         {
-            return obj.as_bool() == information["mean"].as_bool();
+            // type[...] keeps the rule without the wrapper
+            rule.items = compile(information["default"], false);
         }
-
-        // ex: {bool}
-        return true;
     }
-    if (type == json::type_number)
+
+    rules[index] = rule;
+
+    return index;
+}
+
+template <typename T>
+bool manapi::json_mask::execute(const T &obj, const uint32_t &index) const {
+    const auto &rule = rules[index];
+
+    if constexpr (std::is_same_v<T, std::map<std::string, std::string>>)
     {
-        // invalid type
-        if (!obj.is_number())
+        // the form is the object of the strings
+        switch (rule.type)
         {
-            return false;
-        }
+            case MANAPI_JSON_ALTERNATIVES:
+                for (uint32_t i = rule.first; i < rule.first + rule.count; i++)
+                {
+                    if (execute(obj, children[i]))
+                    {
+                        return true;
+                    }
+                }
 
-        // invalid value
-        if (information.contains("value"))
-        {
-            return obj.as_number() == information["value"].as_number();
+                return false;
+            case json::type_object:
+                return compare_size(obj.size(), rule) && execute_object(obj, rule);
+            case MANAPI_JSON_ANY:
+            case MANAPI_JSON_NONE:
+                return true;
+            default:
+                return false;
         }
+    }
+    else
+    {
+        // value or mean
+        const json *expected = rule.value != npos ? &values[rule.value] : (rule.mean != npos ? &values[rule.mean] : nullptr);
 
-        if (information.contains("mean"))
+        switch (rule.type)
         {
-            return obj.as_number() == information["mean"].as_number();
+            case MANAPI_JSON_ALTERNATIVES:
+                for (uint32_t i = rule.first; i < rule.first + rule.count; i++)
+                {
+                    if (execute(obj, children[i]))
+                    {
+                        return true;
+                    }
+                }
+
+                return false;
+            case json::type_string:
+                if (!obj.is_string() || !compare_size(obj.size(), rule))
+                {
+                    return false;
+                }
+
+                // by value ex: STR1 != STR2
+                return rule.value == npos || values[rule.value].as_string() == obj.as_string();
+            case json::type_null:
+                return obj.is_null();
+            case json::type_boolean:
+                return obj.is_bool() && (expected == nullptr || obj.as_bool() == expected->as_bool());
+            case json::type_number:
+                return obj.is_number() && (expected == nullptr || obj.as_number() == expected->as_number());
+            case json::type_decimal:
+                return obj.is_decimal() && (expected == nullptr || obj.as_decimal() == expected->as_decimal());
+            case json::type_bigint:
+                return obj.is_bigint() && (expected == nullptr || obj.as_bigint() == expected->as_bigint());
+            case json::type_numeric:
+                return obj.is_bigint() || obj.is_number() || obj.is_decimal();
+            case json::type_object:
+                return obj.is_object() && compare_size(obj.size(), rule) && execute_object(obj, rule);
+            case json::type_array:
+                return obj.is_array() && compare_size(obj.size(), rule) && execute_array(obj, rule);
+            case MANAPI_JSON_ANY:
+            case MANAPI_JSON_NONE:
+                return true;
+            default:
+                return false;
         }
+    }
+}
 
-        // ex: {number}
+bool manapi::json_mask::execute_object(const manapi::json &obj, const rule_t &rule) const {
+    if (!rule.has_data)
+    {
         return true;
     }
-    if (type == json::type_decimal)
+
+    const auto &items = obj.as_object();
+
+    if (items.size() > rule.count)
     {
-        // invalid type
-        if (!obj.is_decimal())
+        return false;
+    }
+
+    // both are sorted by the keys -> one pass without the lookups
+    auto it = items.begin();
+
+    for (uint32_t i = rule.first; i < rule.first + rule.count; i++)
+    {
+        const auto &field = fields[i];
+
+        while (it != items.end() && it->first < field.key)
         {
-            return false;
+            it++;
         }
 
-        // invalid value
-        if (information.contains("value"))
+        // incorrect key, the rest of the fields are still checked
+        if (it == items.end() || it->first != field.key)
         {
-            return obj.as_decimal() == information["value"].as_decimal();
+            if (!field.none)
+            {
+                return false;
+            }
+
+            continue;
         }
 
-        if (information.contains("mean"))
+        // incorrect value
+        if (!execute(it->second, field.rule))
         {
-            return obj.as_decimal() == information["mean"].as_decimal();
+            return false;
         }
+    }
 
-        // ex: {decimal}
+    return true;
+}
+
+bool manapi::json_mask::execute_object(const json_view &obj, const rule_t &rule) const {
+    if (!rule.has_data)
+    {
         return true;
     }
-    if (type == json::type_bigint)
+
+    if (obj.size() > rule.count)
     {
-        // invalid type
-        if (!obj.is_bigint())
-        {
-            return false;
-        }
+        return false;
+    }
 
-        // invalid value
-        if (information.contains("value"))
-        {
-            return obj.as_bigint() == information["value"].as_bigint();
-        }
+    for (uint32_t i = rule.first; i < rule.first + rule.count; i++)
+    {
+        const auto &field = fields[i];
+
+        // the hash of the key is compiled
+        const size_t found = obj.find(field.key, field.hash);
 
-        if (information.contains("mean"))
+        // incorrect key
+        if (found == std::string_view::npos)
         {
-            return obj.as_bigint() == information["mean"].as_bigint();
+            if (!field.none)
+            {
+                return false;
+            }
+
+            continue;
         }
 
-        // ex: {bigint}
-        return true;
-    }
-    if (type == json::type_numeric)
-    {
-        if (!obj.is_bigint() && !obj.is_number() && !obj.is_decimal())
+        // incorrect value
+        if (!execute(json_view (obj.tape, found), field.rule))
         {
             return false;
         }
+    }
+
+    return true;
+}
 
+bool manapi::json_mask::execute_object(const std::map<std::string, std::string> &obj, const rule_t &rule) const {
+    if (!rule.has_data)
+    {
         return true;
     }
-    if (type == MANAPI_JSON_ANY)
+
+    if (obj.size() > rule.count)
     {
-        return true;
+        return false;
     }
-    if (type == json::type_object)
+
+    auto it = obj.begin();
+
+    for (uint32_t i = rule.first; i < rule.first + rule.count; i++)
     {
-        if (!obj.is_object())
+        const auto &field = fields[i];
+
+        while (it != obj.end() && it->first < field.key)
         {
-            return false;
+            it++;
+        }
+
+        // incorrect key
+        if (it == obj.end() || it->first != field.key)
+        {
+            if (!field.none)
+            {
+                return false;
+            }
+
+            continue;
         }
 
-        if (!default_compare_information (obj, information))
+        // incorrect value
+        if (!execute_string(it->second, field.rule))
         {
             return false;
         }
+    }
 
-        if (information.contains("data"))
+    return true;
+}
+
+bool manapi::json_mask::execute_array(const manapi::json &obj, const rule_t &rule) const {
+    const auto &items = obj.as_array();
+
+    if (rule.has_data)
+    {
+        if (items.size() != rule.count)
         {
-            auto &data = information["data"];
+            return false;
+        }
 
-            if (obj.size() > data.size())
+        for (uint32_t i = 0; i < rule.count; i++)
+        {
+            if (!execute(items[i], children[rule.first + i]))
             {
                 return false;
             }
-
-            for (auto it = data.begin<json::OBJECT>(); it != data.end<json::OBJECT>(); it++)
-            {
-                // incorrect key
-                if (!obj.contains(it->first))
-                {
-                    return it->second["none"].as_bool();
-                }
-                // incorrect value
-                if (!recursive_valid(obj.at(it->first), it->second))
-                {
-                    return false;
-                }
-            }
         }
-
-        // all ok
-        return true;
     }
-    if (type == json::type_array)
+
+    if (rule.items != npos)
     {
-        if (!obj.is_array())
+        // we need to validate all items as 'type' (from type[...] or type(...)[...])
+        for (const auto &item: items)
         {
-            return false;
+            if (!execute(item, rule.items))
+            {
+                return false;
+            }
         }
+    }
+
+    return true;
+}
 
-        if (!default_compare_information (obj, information))
+bool manapi::json_mask::execute_array(const json_view &obj, const rule_t &rule) const {
+    if (rule.has_data)
+    {
+        if (obj.size() != rule.count)
         {
             return false;
         }
 
-        if (information.contains("data")) {
-
-            auto &data = information["data"];
+        uint32_t i = rule.first;
 
-            if (obj.size() != data.size())
+        for (auto it = obj.begin(); it != obj.end(); ++it, i++)
+        {
+            if (!execute(*it, children[i]))
             {
                 return false;
             }
+        }
+    }
 
-            for (size_t i = 0; i < obj.size(); i++)
+    if (rule.items != npos)
+    {
+        for (auto it = obj.begin(); it != obj.end(); ++it)
+        {
+            if (!execute(*it, rule.items))
             {
-                if (!recursive_valid(obj.at(i), data.at(i)))
-                {
-                    return false;
-                }
+                return false;
             }
         }
+    }
 
-        if (information.contains("default"))
-        {
-            // we need to validate all items as 'type' (from type[...] or type(...)[...])
+    return true;
+}
 
-            auto &_default = information["default"];
+bool manapi::json_mask::execute_string(const std::string_view &obj, const uint32_t &index) const {
+    const auto &rule = rules[index];
 
-            for (size_t i = 0; i < obj.size(); i++)
+    switch (rule.type)
+    {
+        case MANAPI_JSON_ALTERNATIVES:
+            for (uint32_t i = rule.first; i < rule.first + rule.count; i++)
             {
-                if (!recursive_valid(obj.at(i), _default))
+                if (execute_string(obj, children[i]))
                 {
-                    return false;
+                    return true;
                 }
             }
-        }
 
-        return true;
+            return false;
+        case json::type_string:
+            if (!compare_size(obj.size(), rule))
+            {
+                return false;
+            }
+
+            return rule.value == npos || values[rule.value].as_string() == obj;
+        case MANAPI_JSON_ANY:
+        case MANAPI_JSON_NONE:
+            return true;
+        default:
+            // the values of the form are only the strings
+            return false;
     }
+}
 
-    if (type == MANAPI_JSON_NONE) {
-        return true;
+bool manapi::json_mask::compare_size(const size_t &size, const rule_t &rule) const {
+    // by length
+    if (rule.mean != npos && static_cast<json::NUMBER>(size) != values[rule.mean].as_number())
+    {
+        return false;
+    }
+
+    if (rule.has_min && static_cast<json::NUMBER>(size) <= rule.min)
+    {
+        return false;
+    }
+
+    if (rule.has_max && static_cast<json::NUMBER>(size) >= rule.max)
+    {
+        return false;
     }
 
-    return false;
+    return true;
 }
 
-bool manapi::json_mask::default_compare_information(const manapi::json &obj, const manapi::json &information, const bool &by_size) {
-    if (by_size)
+bool manapi::json_mask::resolve(uint32_t &index, const json::types &type) const {
+    const auto &rule = rules[index];
+
+    switch (rule.type)
     {
-        // by length
-        if (information.contains("mean"))
+        case MANAPI_JSON_ALTERNATIVES:
         {
-            if (obj.size() != information["mean"].as_number())
-            {
-                return false;
-            }
-        }
+            uint32_t    found   = npos;
+            size_t      matched = 0;
 
-        if (information.contains("min_mean"))
-        {
-            if (obj.size() <= information["min_mean"].as_number())
+            for (uint32_t i = rule.first; i < rule.first + rule.count; i++)
             {
-                return false;
+                uint32_t child = children[i];
+
+                if (resolve(child, type))
+                {
+                    found = child;
+                    matched++;
+                }
             }
-        }
 
-        if (information.contains("max_mean"))
-        {
-            if (obj.size() >= information["max_mean"].as_number())
+            // the only alternative of the type is checked while building
+            if (matched == 1)
             {
-                return false;
+                index = found;
             }
-        }
+
+            return matched > 0;
+        }
+        case MANAPI_JSON_ANY:
+        case MANAPI_JSON_NONE:
+            index = npos;
+            return true;
+        case json::type_string:
+        case json::type_object:
+        case json::type_array:
+            return rule.type == type;
+        default:
+            // json_builder knows the scalar after the last char
+            return rule.type == type || type == json::type_numeric;
     }
+}
 
+uint32_t manapi::json_mask::field(const uint32_t &index, const std::string_view &key) const {
+    const auto &rule = rules[index];
 
-    return true;
+    if (rule.type != json::type_object || !rule.has_data)
+    {
+        return npos;
+    }
+
+    const auto begin    = fields.begin() + rule.first;
+    const auto end      = begin + rule.count;
+
+    // the fields are sorted by the keys
+    const auto it = std::lower_bound(begin, end, key, [] (const field_t &field, const std::string_view &key) -> bool {
+        return field.key < key;
+    });
+
+    return it != end && it->key == key ? it->rule : npos;
+}
+
+uint32_t manapi::json_mask::item(const uint32_t &index, const size_t &element) const {
+    const auto &rule = rules[index];
+
+    if (rule.type != json::type_array)
+    {
+        return npos;
+    }
+
+    if (rule.has_data)
+    {
+        return element < rule.count ? children[rule.first + element] : npos;
+    }
+
+    return rule.items;
+}
+
+bool manapi::json_mask::fits(const uint32_t &index, const size_t &size) const {
+    const auto &rule = rules[index];
+
+    if (rule.has_max && static_cast<json::NUMBER>(size) >= rule.max)
+    {
+        return false;
+    }
+
+    if (rule.mean != npos && static_cast<json::NUMBER>(size) > values[rule.mean].as_number())
+    {
+        return false;
+    }
+
+    // the object has more keys than the fields, the array has more items than the data
+    return !rule.has_data || size <= rule.count;
+}
+
+bool manapi::json_mask::check(const json &obj, const uint32_t &index) const {
+    return execute (obj, index);
 }
@@ -0,0 +1,1372 @@
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <format>
+
+#include "ManapiJsonTape.hpp"
+#include "ManapiJsonBuilder.hpp"
+#include "ManapiUtils.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MANAPI_JSON_TAPE_X86
+#endif
+
+#define THROW_MANAPI_JSON_ERROR(errnum, msg, ...) throw manapi::json_parse_exception (errnum, std::format(msg, __VA_ARGS__));
+
+namespace manapi {
+    // the classes of the 64 bytes, the bit i is the byte i
+    struct json_block_t {
+        uint64_t    quote;
+        uint64_t    backslash;
+        // { } [ ] : ,
+        uint64_t    op;
+        uint64_t    space;
+        uint64_t    control;
+        uint64_t    high;
+    };
+
+    typedef void (*json_classify_t) (const char *data, const size_t &count, json_block_t *blocks);
+
+    static void json_classify_scalar (const char *data, const size_t &count, json_block_t *blocks)
+    {
+        for (size_t n = 0; n < count; n++, data += 64)
+        {
+            json_block_t &block = blocks[n];
+
+            block = {};
+
+            for (size_t j = 0; j < 64; j++)
+            {
+                const auto c = static_cast<unsigned char>(data[j]);
+                const uint64_t bit = 1ull << j;
+
+                switch (c)
+                {
+                    case '"':
+                        block.quote |= bit;
+                        break;
+                    case '\\':
+                        block.backslash |= bit;
+                        break;
+                    case '{':
+                    case '}':
+                    case '[':
+                    case ']':
+                    case ':':
+                    case ',':
+                        block.op |= bit;
+                        break;
+                    case ' ':
+                    case '\t':
+                    case '\n':
+                    case '\r':
+                        block.space |= bit;
+                        break;
+                    default:
+                        break;
+                }
+
+                if (c < 0x20)
+                {
+                    block.control |= bit;
+                }
+                else if (c >= 0x80)
+                {
+                    block.high |= bit;
+                }
+            }
+        }
+    }
+
+#ifdef MANAPI_JSON_TAPE_X86
+    static void json_classify_sse2 (const char *data, const size_t &count, json_block_t *blocks)
+    {
+        const auto eq = [] (const __m128i &v, const char &c) -> uint64_t {
+            return static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+        };
+
+        for (size_t n = 0; n < count; n++, data += 64)
+        {
+            json_block_t &block = blocks[n];
+
+            block = {};
+
+            for (size_t j = 0; j < 4; j++)
+            {
+                const __m128i v     = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + j * 16));
+                // '[' -> '{', ']' -> '}'
+                const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+                const uint64_t high = static_cast<uint16_t>(_mm_movemask_epi8(v));
+                // signed: the bytes >= 0x80 are negative
+                const uint64_t less = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmplt_epi8(v, _mm_set1_epi8(0x20))));
+
+                block.quote     |= eq(v, '"') << (j * 16);
+                block.backslash |= eq(v, '\\') << (j * 16);
+                block.op        |= (eq(lower, '{') | eq(lower, '}') | eq(v, ':') | eq(v, ',')) << (j * 16);
+                block.space     |= (eq(v, ' ') | eq(v, '\t') | eq(v, '\n') | eq(v, '\r')) << (j * 16);
+                block.control   |= (less & ~high) << (j * 16);
+                block.high      |= high << (j * 16);
+            }
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static void json_classify_avx2 (const char *data, const size_t &count, json_block_t *blocks)
+    {
+        const auto eq = [] (const __m256i &v, const char &c) __attribute__((target("avx2"))) -> uint64_t {
+            return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+        };
+
+        for (size_t n = 0; n < count; n++, data += 64)
+        {
+            json_block_t &block = blocks[n];
+
+            block = {};
+
+            for (size_t j = 0; j < 2; j++)
+            {
+                const __m256i v     = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + j * 32));
+                const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+                const uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+                const uint64_t less = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), v)));
+
+                block.quote     |= eq(v, '"') << (j * 32);
+                block.backslash |= eq(v, '\\') << (j * 32);
+                block.op        |= (eq(lower, '{') | eq(lower, '}') | eq(v, ':') | eq(v, ',')) << (j * 32);
+                block.space     |= (eq(v, ' ') | eq(v, '\t') | eq(v, '\n') | eq(v, '\r')) << (j * 32);
+                block.control   |= (less & ~high) << (j * 32);
+                block.high      |= high << (j * 32);
+            }
+        }
+    }
+#endif
+
+    static json_classify_t json_classify_select ()
+    {
+#ifdef MANAPI_JSON_TAPE_X86
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return json_classify_avx2;
+        }
+
+        return json_classify_sse2;
+#else
+        return json_classify_scalar;
+#endif
+    }
+
+    // the bits after the odd sequences of the backslashes
+    static uint64_t json_escaped (uint64_t backslash, uint64_t &prev_escaped)
+    {
+        constexpr uint64_t even_bits = 0x5555555555555555ull;
+
+        backslash &= ~prev_escaped;
+
+        const uint64_t follows_escape       = backslash << 1 | prev_escaped;
+        const uint64_t odd_sequence_starts  = backslash & ~even_bits & ~follows_escape;
+
+        uint64_t sequences_starting_on_even_bits;
+        prev_escaped = __builtin_add_overflow(odd_sequence_starts, backslash, &sequences_starting_on_even_bits);
+
+        const uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+
+        return (even_bits ^ invert_mask) & follows_escape;
+    }
+
+    // the bit is set between the quotes (the opening quote is included)
+    static uint64_t json_prefix_xor (uint64_t bits)
+    {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+
+        return bits;
+    }
+
+    /**
+     * one pass over the text without the recursion, the containers are on the stack
+     */
+    class json_tape_parser {
+    public:
+        json_tape_parser (json_tape &tape, const std::string_view &text) : tape (tape), text (text) {}
+
+        /**
+         * stage 1: the positions of the structural chars, the quotes and the starts of the scalars
+         * by the masks of the 64-byte blocks, the strings are not visited by stage 2
+         */
+        void index ()
+        {
+            static const json_classify_t classify = json_classify_select();
+
+            auto &positions = tape.structurals;
+
+            positions.clear();
+            positions.reserve(text.size() / 4 + 1);
+
+            uint64_t prev_escaped   = 0;
+            uint64_t prev_in_string = 0;
+            uint64_t prev_scalar    = 0;
+            uint64_t high           = 0;
+
+            json_block_t blocks[64];
+
+            for (size_t offset = 0; offset < text.size();)
+            {
+                size_t count = std::min<size_t>((text.size() - offset) / 64, 64);
+
+                if (count > 0)
+                {
+                    classify(text.data() + offset, count, blocks);
+                }
+                else
+                {
+                    // the tail is padded by the spaces
+                    char tail[64];
+
+                    memset(tail, ' ', sizeof (tail));
+                    memcpy(tail, text.data() + offset, text.size() - offset);
+
+                    classify(tail, 1, blocks);
+                    count = 1;
+                }
+
+                for (size_t n = 0; n < count; n++, offset += 64)
+                {
+                    const json_block_t &block = blocks[n];
+
+                    const uint64_t quote        = block.quote & ~json_escaped(block.backslash, prev_escaped);
+                    const uint64_t in_string    = json_prefix_xor(quote) ^ prev_in_string;
+
+                    prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+                    if (block.control & in_string)
+                    {
+                        throw json_parse_exception(ERR_JSON_INVALID_CHAR, "Bad control character at " + std::to_string(offset + std::countr_zero(block.control & in_string)));
+                    }
+
+                    high |= block.high;
+
+                    const uint64_t scalar   = ~(block.op | block.space | quote | in_string);
+                    const uint64_t starts   = scalar & ~(scalar << 1 | prev_scalar);
+
+                    prev_scalar = scalar >> 63;
+
+                    for (uint64_t structural = (block.op & ~in_string) | quote | starts; structural; structural &= structural - 1)
+                    {
+                        positions.push_back(static_cast<uint32_t>(offset + std::countr_zero(structural)));
+                    }
+                }
+            }
+
+            if (prev_in_string)
+            {
+                json::error_unexpected_end(text.size());
+            }
+
+            // the UTF-8 of the whole text once
+            if (high)
+            {
+                json_builder::_valid_utf_string(text);
+            }
+
+            indexed = true;
+        }
+
+        /**
+         * stage 2: the tape by the tokens
+         */
+        void run ()
+        {
+            enum {
+                STATE_VALUE,
+                STATE_KEY_FIRST,
+                STATE_KEY,
+                STATE_ARRAY_FIRST,
+                STATE_NEXT
+            } state = STATE_VALUE;
+
+            while (true)
+            {
+                skip_spaces();
+
+                switch (state)
+                {
+                    case STATE_ARRAY_FIRST:
+                        if (i < text.size() && text[i] == ']')
+                        {
+                            close(json_tape::TAPE_ARRAY_END);
+                            state = STATE_NEXT;
+                            continue;
+                        }
+
+                        [[fallthrough]];
+                    case STATE_VALUE:
+                        if (i >= text.size())
+                        {
+                            json::error_unexpected_end(i);
+                        }
+
+                        if (!stack.empty() && stack.back().type == json_tape::TAPE_ARRAY)
+                        {
+                            stack.back().count++;
+                        }
+
+                        switch (text[i])
+                        {
+                            case '{':
+                                open(json_tape::TAPE_OBJECT);
+                                state = STATE_KEY_FIRST;
+                                continue;
+                            case '[':
+                                open(json_tape::TAPE_ARRAY);
+                                state = STATE_ARRAY_FIRST;
+                                continue;
+                            case '"':
+                                parse_string(false);
+                                break;
+                            case 't':
+                                parse_literal("true", json_tape::TAPE_TRUE);
+                                break;
+                            case 'f':
+                                parse_literal("false", json_tape::TAPE_FALSE);
+                                break;
+                            case 'n':
+                                parse_literal("null", json_tape::TAPE_NULL);
+                                break;
+                            case '-':
+                            case '0':
+                            case '1':
+                            case '2':
+                            case '3':
+                            case '4':
+                            case '5':
+                            case '6':
+                            case '7':
+                            case '8':
+                            case '9':
+                                parse_number();
+                                break;
+                            default:
+                                json::error_invalid_char(text, i);
+                        }
+
+                        state = STATE_NEXT;
+                        continue;
+                    case STATE_KEY_FIRST:
+                        if (i < text.size() && text[i] == '}')
+                        {
+                            close(json_tape::TAPE_OBJECT_END);
+                            state = STATE_NEXT;
+                            continue;
+                        }
+
+                        [[fallthrough]];
+                    case STATE_KEY:
+                        if (i >= text.size())
+                        {
+                            json::error_unexpected_end(i);
+                        }
+
+                        if (text[i] != '"')
+                        {
+                            json::error_invalid_char(text, i);
+                        }
+
+                        stack.back().count++;
+                        parse_string(true);
+
+                        skip_spaces();
+
+                        if (i >= text.size())
+                        {
+                            json::error_unexpected_end(i);
+                        }
+
+                        if (text[i] != ':')
+                        {
+                            json::error_invalid_char(text, i);
+                        }
+
+                        i++;
+                        state = STATE_VALUE;
+                        continue;
+                    case STATE_NEXT:
+                        if (stack.empty())
+                        {
+                            if (i != text.size())
+                            {
+                                json::error_invalid_char(text, i);
+                            }
+
+                            return;
+                        }
+
+                        if (i >= text.size())
+                        {
+                            json::error_unexpected_end(i);
+                        }
+
+                        const auto top = stack.back().type;
+
+                        if (text[i] == ',')
+                        {
+                            i++;
+                            state = top == json_tape::TAPE_OBJECT ? STATE_KEY : STATE_VALUE;
+                            continue;
+                        }
+
+                        if (text[i] == '}' && top == json_tape::TAPE_OBJECT)
+                        {
+                            close(json_tape::TAPE_OBJECT_END);
+                            continue;
+                        }
+
+                        if (text[i] == ']' && top == json_tape::TAPE_ARRAY)
+                        {
+                            close(json_tape::TAPE_ARRAY_END);
+                            continue;
+                        }
+
+                        json::error_invalid_char(text, i);
+                }
+            }
+        }
+    private:
+        struct container_t {
+            size_t              start;
+            size_t              count;
+            json_tape::word_t   type;
+        };
+
+        // to the next token
+        void skip_spaces ()
+        {
+            if (indexed)
+            {
+                const auto &positions = tape.structurals;
+                const size_t next = k < positions.size() ? positions[k++] : text.size();
+
+                // the rest of the scalar (12x)
+                if (i < next && !is_space(text[i]))
+                {
+                    json::error_invalid_char(text, i);
+                }
+
+                i = next;
+                return;
+            }
+
+            while (i < text.size() && is_space(text[i]))
+            {
+                i++;
+            }
+        }
+
+        static bool is_space (const char &c)
+        {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        void open (const json_tape::word_t &type)
+        {
+            if (stack.size() >= json_tape::max_depth)
+            {
+                THROW_MANAPI_JSON_ERROR(ERR_JSON_OUT_OF_RANGE, "the depth of the JSON is more than {} at {}", json_tape::max_depth, i + 1);
+            }
+
+            stack.push_back({tape.tape.size(), 0, type});
+
+            tape.write(type, 0);
+            i++;
+        }
+
+        void close (const json_tape::word_t &type)
+        {
+            const size_t start = stack.back().start;
+            const size_t count = std::min<size_t>(stack.back().count, 0xFFFFFF);
+
+            stack.pop_back();
+
+            tape.write(type, start);
+
+            // the start knows the count and the end
+            tape.tape[start] = static_cast<uint64_t>(tape.word(start)) << 56 | count << 32 | tape.tape.size();
+            i++;
+        }
+
+        void parse_literal (const std::string_view &literal, const json_tape::word_t &type)
+        {
+            if (text.substr(i, literal.size()) != literal)
+            {
+                if (text.size() - i < literal.size() && literal.starts_with(text.substr(i)))
+                {
+                    json::error_unexpected_end(text.size());
+                }
+
+                json::error_invalid_char(text, i);
+            }
+
+            tape.write(type, 0);
+            i += literal.size();
+        }
+
+        void parse_number ()
+        {
+            const size_t start = i;
+            bool decimal = false;
+
+            if (text[i] == '-')
+            {
+                i++;
+            }
+
+            if (i >= text.size())
+            {
+                json::error_unexpected_end(i);
+            }
+
+            if (text[i] == '0')
+            {
+                i++;
+            }
+            else if (text[i] >= '1' && text[i] <= '9')
+            {
+                skip_digits();
+            }
+            else
+            {
+                json::error_invalid_char(text, i);
+            }
+
+            if (i < text.size() && text[i] == '.')
+            {
+                i++;
+                decimal = true;
+
+                expect_digits();
+            }
+
+            if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+            {
+                i++;
+                decimal = true;
+
+                if (i < text.size() && (text[i] == '+' || text[i] == '-'))
+                {
+                    i++;
+                }
+
+                expect_digits();
+            }
+
+            const auto number = text.substr(start, i - start);
+
+            if (!tape.use_bigint)
+            {
+                if (!decimal)
+                {
+                    int64_t value;
+
+                    if (std::from_chars(number.data(), number.data() + number.size(), value).ec == std::errc {})
+                    {
+                        tape.write(json_tape::TAPE_NUMBER, 0);
+                        tape.tape.push_back(std::bit_cast<uint64_t>(value));
+                        return;
+                    }
+                }
+                else
+                {
+                    // the precision of json::parse
+                    json::DECIMAL value;
+
+                    if (std::from_chars(number.data(), number.data() + number.size(), value).ec == std::errc {})
+                    {
+                        uint64_t words[json_tape::decimal_words] {};
+
+                        memcpy(words, &value, sizeof (value));
+
+                        tape.write(json_tape::TAPE_DECIMAL, 0);
+                        tape.tape.insert(tape.tape.end(), words, words + json_tape::decimal_words);
+                        return;
+                    }
+                }
+            }
+
+            // the text is kept for the bigint or out of the range
+            const size_t offset = tape.begin_string();
+            tape.strings.append(number);
+            tape.end_string(offset, false);
+
+            tape.write(json_tape::TAPE_BIGINT, offset);
+        }
+
+        void skip_digits ()
+        {
+            while (i < text.size() && text[i] >= '0' && text[i] <= '9')
+            {
+                i++;
+            }
+        }
+
+        void expect_digits ()
+        {
+            if (i >= text.size())
+            {
+                json::error_unexpected_end(i);
+            }
+
+            if (text[i] < '0' || text[i] > '9')
+            {
+                json::error_invalid_char(text, i);
+            }
+
+            skip_digits();
+        }
+
+        void parse_string (const bool &key)
+        {
+            const size_t offset = tape.begin_string();
+            bool ascii = true;
+
+            if (indexed)
+            {
+                // the closing quote is the next position, the text is valid UTF-8
+                const size_t end = tape.structurals[k++];
+                const auto value = text.substr(i + 1, end - i - 1);
+
+                if (memchr(value.data(), '\\', value.size()) == nullptr)
+                {
+                    tape.strings.append(value);
+                    i = end + 1;
+
+                    tape.end_string(offset, key);
+                    tape.write(json_tape::TAPE_STRING, offset);
+                    return;
+                }
+            }
+
+            // the quote
+            i++;
+
+            while (true)
+            {
+                const size_t start = i;
+
+                // the plain part is copied by one append
+                while (i < text.size())
+                {
+                    const auto c = static_cast<unsigned char>(text[i]);
+
+                    if (c == '"' || c == '\\' || c < 0x20)
+                    {
+                        break;
+                    }
+
+                    ascii &= c < 0x80;
+                    i++;
+                }
+
+                tape.strings.append(text.data() + start, i - start);
+
+                if (i >= text.size())
+                {
+                    json::error_unexpected_end(i);
+                }
+
+                if (text[i] == '"')
+                {
+                    i++;
+                    break;
+                }
+
+                if (text[i] != '\\')
+                {
+                    throw json_parse_exception(ERR_JSON_INVALID_CHAR, "Bad control character at " + std::to_string(i));
+                }
+
+                if (++i >= text.size())
+                {
+                    json::error_unexpected_end(i);
+                }
+
+                switch (text[i])
+                {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        tape.strings += text[i];
+                        break;
+                    case 'b':
+                        tape.strings += '\b';
+                        break;
+                    case 'f':
+                        tape.strings += '\f';
+                        break;
+                    case 'n':
+                        tape.strings += '\n';
+                        break;
+                    case 'r':
+                        tape.strings += '\r';
+                        break;
+                    case 't':
+                        tape.strings += '\t';
+                        break;
+                    case 'u':
+                        parse_unicode_escape();
+                        continue;
+                    default:
+                        throw json_parse_exception(ERR_JSON_BAD_ESCAPED_CHAR, "Bad escaped character at " + std::to_string(i));
+                }
+
+                i++;
+            }
+
+            if (!ascii && !indexed)
+            {
+                json_builder::_valid_utf_string(std::string_view (tape.strings).substr(offset + 8));
+            }
+
+            tape.end_string(offset, key);
+            tape.write(json_tape::TAPE_STRING, offset);
+        }
+
+        uint32_t parse_hex4 ()
+        {
+            if (text.size() - i < 4)
+            {
+                json::error_unexpected_end(text.size());
+            }
+
+            uint32_t code = 0;
+
+            for (size_t k = 0; k < 4; k++, i++)
+            {
+                const auto c = static_cast<unsigned char>(text[i]);
+
+                code <<= 4;
+
+                if (c >= '0' && c <= '9')
+                {
+                    code |= c - '0';
+                }
+                else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+                {
+                    code |= (c | 0x20) - 'a' + 10;
+                }
+                else
+                {
+                    throw json_parse_exception (ERR_JSON_BAD_ESCAPED_CHAR, "bad Unicode escape at " + std::to_string(i));
+                }
+            }
+
+            return code;
+        }
+
+        // \uXXXX (i at 'u') -> UTF-8
+        void parse_unicode_escape ()
+        {
+            i++;
+
+            uint32_t code = parse_hex4();
+
+            if (code >= 0xD800 && code <= 0xDBFF)
+            {
+                // the surrogate pair
+                if (text.substr(i, 2) != "\\u")
+                {
+                    throw json_parse_exception (ERR_JSON_BAD_ESCAPED_CHAR, "bad Unicode escape at " + std::to_string(i));
+                }
+
+                i += 2;
+
+                const uint32_t low = parse_hex4();
+
+                if (low < 0xDC00 || low > 0xDFFF)
+                {
+                    throw json_parse_exception (ERR_JSON_BAD_ESCAPED_CHAR, "bad Unicode escape at " + std::to_string(i));
+                }
+
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            else if (code >= 0xDC00 && code <= 0xDFFF)
+            {
+                throw json_parse_exception (ERR_JSON_BAD_ESCAPED_CHAR, "bad Unicode escape at " + std::to_string(i));
+            }
+
+            auto &out = tape.strings;
+
+            if (code < 0x80)
+            {
+                out += static_cast<char>(code);
+            }
+            else if (code < 0x800)
+            {
+                out += static_cast<char>(0xC0 | code >> 6);
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | code >> 12);
+                out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | code >> 18);
+                out += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+                out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        json_tape               &tape;
+        const std::string_view  text;
+        size_t                  i           = 0;
+
+        // stage 1 is done, k is the next position
+        bool                    indexed     = false;
+        size_t                  k           = 0;
+
+        // the indexes of the open containers and their items
+        std::vector<container_t>
+                                stack;
+    };
+}
+
+// =================[json_tape              ]================= //
+
+manapi::json_tape::json_tape(const std::string_view &plain_text, const bool &use_bigint, const size_t &bigint_precision) {
+    this->use_bigint        = use_bigint;
+    this->bigint_precision  = bigint_precision;
+
+    parse(plain_text);
+}
+
+void manapi::json_tape::parse(const std::string_view &plain_text) {
+    tape.clear();
+    strings.clear();
+
+    // the most documents fit without the reallocations
+    tape.reserve(plain_text.size() / 4 + 2);
+    strings.reserve(plain_text.size());
+
+    try
+    {
+        json_tape_parser parser (*this, plain_text);
+
+        // the positions are 32-bit
+        if (plain_text.size() <= UINT32_MAX)
+        {
+            parser.index();
+        }
+
+        parser.run();
+    }
+    catch (...)
+    {
+        tape.clear();
+        strings.clear();
+
+        throw;
+    }
+}
+
+manapi::json_view manapi::json_tape::root() const {
+    if (tape.empty())
+    {
+        THROW_MANAPI_JSON_ERROR(ERR_JSON_UNEXPECTED_END, "the tape is empty: {}", "parse () was not called");
+    }
+
+    return {this, 0};
+}
+
+bool manapi::json_tape::empty() const {
+    return tape.empty();
+}
+
+size_t manapi::json_tape::memory() const {
+    return tape.capacity() * sizeof (uint64_t) + strings.capacity() + structurals.capacity() * sizeof (uint32_t);
+}
+
+uint32_t manapi::json_tape::hash(const std::string_view &key) {
+    // FNV-1a
+    uint32_t result = 2166136261u;
+
+    for (const auto &c: key)
+    {
+        result = (result ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+
+    return result;
+}
+
+uint8_t manapi::json_tape::word(const size_t &index) const {
+    return static_cast<uint8_t>(tape[index] >> 56);
+}
+
+uint64_t manapi::json_tape::payload(const size_t &index) const {
+    return tape[index] & 0x00FFFFFFFFFFFFFFull;
+}
+
+size_t manapi::json_tape::skip(const size_t &index) const {
+    switch (word(index))
+    {
+        case TAPE_NUMBER:
+            return index + 2;
+        case TAPE_DECIMAL:
+            return index + 1 + decimal_words;
+        case TAPE_OBJECT:
+        case TAPE_ARRAY:
+            return payload(index) & 0xFFFFFFFF;
+        default:
+            return index + 1;
+    }
+}
+
+std::string_view manapi::json_tape::string(const size_t &index) const {
+    const size_t offset = payload(index);
+    uint32_t size;
+
+    memcpy(&size, strings.data() + offset, sizeof (size));
+
+    return {strings.data() + offset + 8, size};
+}
+
+uint32_t manapi::json_tape::string_hash(const size_t &index) const {
+    uint32_t result;
+
+    memcpy(&result, strings.data() + payload(index) + 4, sizeof (result));
+
+    return result;
+}
+
+void manapi::json_tape::write(const word_t &type, const uint64_t &payload) {
+    tape.push_back(static_cast<uint64_t>(type) << 56 | payload);
+}
+
+size_t manapi::json_tape::begin_string() {
+    const size_t offset = strings.size();
+
+    strings.append(8, '\0');
+
+    return offset;
+}
+
+void manapi::json_tape::end_string(const size_t &offset, const bool &key) {
+    const auto size     = static_cast<uint32_t>(strings.size() - offset - 8);
+    const uint32_t code = key ? hash(std::string_view (strings).substr(offset + 8)) : 0;
+
+    memcpy(strings.data() + offset, &size, sizeof (size));
+    memcpy(strings.data() + offset + 4, &code, sizeof (code));
+}
+
+// =================[json_view              ]================= //
+
+manapi::json_view::json_view(const json_tape *tape, const size_t &index) : tape (tape), index (index) {}
+
+manapi::json::types manapi::json_view::type() const {
+    switch (tape->word(index))
+    {
+        case json_tape::TAPE_TRUE:
+        case json_tape::TAPE_FALSE:
+            return json::type_boolean;
+        case json_tape::TAPE_NUMBER:
+            return json::type_number;
+        case json_tape::TAPE_DECIMAL:
+            return json::type_decimal;
+        case json_tape::TAPE_BIGINT:
+            return json::type_bigint;
+        case json_tape::TAPE_STRING:
+            return json::type_string;
+        case json_tape::TAPE_OBJECT:
+            return json::type_object;
+        case json_tape::TAPE_ARRAY:
+            return json::type_array;
+        default:
+            return json::type_null;
+    }
+}
+
+bool manapi::json_view::is_object() const {
+    return tape->word(index) == json_tape::TAPE_OBJECT;
+}
+
+bool manapi::json_view::is_array() const {
+    return tape->word(index) == json_tape::TAPE_ARRAY;
+}
+
+bool manapi::json_view::is_string() const {
+    return tape->word(index) == json_tape::TAPE_STRING;
+}
+
+bool manapi::json_view::is_number() const {
+    return tape->word(index) == json_tape::TAPE_NUMBER;
+}
+
+bool manapi::json_view::is_null() const {
+    return tape->word(index) == json_tape::TAPE_NULL;
+}
+
+bool manapi::json_view::is_decimal() const {
+    return tape->word(index) == json_tape::TAPE_DECIMAL;
+}
+
+bool manapi::json_view::is_bigint() const {
+    return tape->word(index) == json_tape::TAPE_BIGINT;
+}
+
+bool manapi::json_view::is_bool() const {
+    return tape->word(index) == json_tape::TAPE_TRUE || tape->word(index) == json_tape::TAPE_FALSE;
+}
+
+std::string_view manapi::json_view::as_string() const {
+    if (!is_string())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    return tape->string(index);
+}
+
+manapi::json::NUMBER manapi::json_view::as_number() const {
+    if (!is_number())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    return std::bit_cast<int64_t>(tape->tape[index + 1]);
+}
+
+manapi::json::DECIMAL manapi::json_view::as_decimal() const {
+    if (!is_decimal())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    json::DECIMAL value;
+
+    memcpy(&value, tape->tape.data() + index + 1, sizeof (value));
+
+    return value;
+}
+
+manapi::json::BIGINT manapi::json_view::as_bigint() const {
+    if (!is_bigint())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    return json::BIGINT (std::string (tape->string(index)), tape->bigint_precision);
+}
+
+bool manapi::json_view::as_bool() const {
+    if (!is_bool())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    return tape->word(index) == json_tape::TAPE_TRUE;
+}
+
+manapi::json::DECIMAL manapi::json_view::as_decimal_cast() const {
+    switch (tape->word(index))
+    {
+        case json_tape::TAPE_NUMBER:
+            return static_cast<json::DECIMAL>(as_number());
+        case json_tape::TAPE_DECIMAL:
+            return as_decimal();
+        case json_tape::TAPE_BIGINT:
+            return std::strtold(std::string (tape->string(index)).data(), nullptr);
+        default:
+            throw_could_not_use_func(__FUNCTION__);
+    }
+
+    return 0;
+}
+
+size_t manapi::json_view::size() const {
+    switch (tape->word(index))
+    {
+        case json_tape::TAPE_STRING:
+            return tape->string(index).size();
+        case json_tape::TAPE_OBJECT:
+        case json_tape::TAPE_ARRAY:
+        {
+            const size_t count = tape->payload(index) >> 32;
+
+            if (count < 0xFFFFFF)
+            {
+                return count;
+            }
+
+            // the counter is saturated
+            size_t result = 0;
+
+            for (auto it = begin(); it != end(); ++it)
+            {
+                result++;
+            }
+
+            return result;
+        }
+        default:
+            throw_could_not_use_func(__FUNCTION__);
+    }
+
+    return 0;
+}
+
+bool manapi::json_view::contains(const std::string_view &key) const {
+    return is_object() && find(key) != std::string_view::npos;
+}
+
+manapi::json_view manapi::json_view::operator[](const std::string_view &key) const {
+    return at(key);
+}
+
+manapi::json_view manapi::json_view::operator[](const size_t &index) const {
+    return at(index);
+}
+
+manapi::json_view manapi::json_view::at(const std::string_view &key) const {
+    if (!is_object())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    const size_t found = find(key);
+
+    if (found == std::string_view::npos)
+    {
+        THROW_MANAPI_JSON_ERROR(ERR_JSON_NO_SUCH_KEY, "No such key. ({})", net::utils::escape_string(std::string (key)));
+    }
+
+    return {tape, found};
+}
+
+manapi::json_view manapi::json_view::at(const size_t &index) const {
+    if (!is_array())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    size_t current = 0;
+
+    // the elements are skipped one by one (the containers by their end index)
+    for (auto it = begin(); it != end(); ++it, current++)
+    {
+        if (current == index)
+        {
+            return *it;
+        }
+    }
+
+    THROW_MANAPI_JSON_ERROR(ERR_JSON_OUT_OF_RANGE, "Out of range: {} >= {}", index, current);
+}
+
+manapi::json_view::iterator manapi::json_view::begin() const {
+    if (!is_object() && !is_array())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    return {tape, index + 1, is_object()};
+}
+
+manapi::json_view::iterator manapi::json_view::end() const {
+    if (!is_object() && !is_array())
+    {
+        throw_could_not_use_func(__FUNCTION__);
+    }
+
+    // the closing word
+    return {tape, tape->skip(index) - 1, is_object()};
+}
+
+std::string manapi::json_view::dump() const {
+    std::string out;
+
+    dump_to(out);
+
+    return out;
+}
+
+void manapi::json_view::dump_to(std::string &out) const {
+    switch (tape->word(index))
+    {
+        case json_tape::TAPE_NULL:
+            out += "null";
+            break;
+        case json_tape::TAPE_TRUE:
+            out += "true";
+            break;
+        case json_tape::TAPE_FALSE:
+            out += "false";
+            break;
+        case json_tape::TAPE_NUMBER:
+            json::dump_number(out, as_number());
+            break;
+        case json_tape::TAPE_DECIMAL:
+        {
+            // the shortest text of the decimal
+            char buffer[64];
+
+            const auto result = std::to_chars(buffer, buffer + sizeof (buffer), as_decimal());
+
+            out.append(buffer, result.ptr);
+            break;
+        }
+        case json_tape::TAPE_BIGINT:
+            out += tape->string(index);
+            break;
+        case json_tape::TAPE_STRING:
+            json::dump_string(out, as_string());
+            break;
+        case json_tape::TAPE_OBJECT:
+            out += '{';
+
+            for (auto it = begin(); it != end(); ++it)
+            {
+                if (it != begin())
+                {
+                    out += ',';
+                }
+
+                json::dump_string(out, it.key());
+                out += ':';
+
+                (*it).dump_to(out);
+            }
+
+            out += '}';
+            break;
+        case json_tape::TAPE_ARRAY:
+            out += '[';
+
+            for (auto it = begin(); it != end(); ++it)
+            {
+                if (it != begin())
+                {
+                    out += ',';
+                }
+
+                (*it).dump_to(out);
+            }
+
+            out += ']';
+            break;
+        default:
+            THROW_MANAPI_JSON_ERROR(ERR_JSON_BUG, "JSON BUG: Invalid word of the tape: {}", tape->word(index));
+    }
+}
+
+manapi::json manapi::json_view::to_json() const {
+    switch (tape->word(index))
+    {
+        case json_tape::TAPE_NULL:
+            return nullptr;
+        case json_tape::TAPE_TRUE:
+            return true;
+        case json_tape::TAPE_FALSE:
+            return false;
+        case json_tape::TAPE_NUMBER:
+            return as_number();
+        case json_tape::TAPE_DECIMAL:
+            return as_decimal();
+        case json_tape::TAPE_BIGINT:
+            if (tape->use_bigint)
+            {
+                return as_bigint();
+            }
+
+            return as_decimal_cast();
+        case json_tape::TAPE_STRING:
+            return json::STRING (as_string());
+        case json_tape::TAPE_OBJECT:
+        {
+            auto result = json::object();
+            // the items are moved into the map (insert () copies the subtree)
+            auto &entries = result.entries();
+
+            for (auto it = begin(); it != end(); ++it)
+            {
+                if (!entries.emplace(it.key(), (*it).to_json()).second)
+                {
+                    THROW_MANAPI_JSON_ERROR(ERR_JSON_DUPLICATE_KEY, "duplicate key: {}", net::utils::escape_string(std::string (it.key())));
+                }
+            }
+
+            return result;
+        }
+        case json_tape::TAPE_ARRAY:
+        {
+            auto result = json::array();
+
+            result.each().reserve(size());
+
+            for (auto it = begin(); it != end(); ++it)
+            {
+                result.push_back((*it).to_json());
+            }
+
+            return result;
+        }
+        default:
+            THROW_MANAPI_JSON_ERROR(ERR_JSON_BUG, "JSON BUG: Invalid word of the tape: {}", tape->word(index));
+    }
+}
+
+size_t manapi::json_view::get_index() const {
+    return index;
+}
+
+size_t manapi::json_view::find(const std::string_view &key) const {
+    return find(key, json_tape::hash(key));
+}
+
+size_t manapi::json_view::find(const std::string_view &key, const uint32_t &code) const {
+    for (size_t i = index + 1; tape->word(i) != json_tape::TAPE_OBJECT_END; i = tape->skip(i + 1))
+    {
+        if (tape->string_hash(i) == code && tape->string(i) == key)
+        {
+            return i + 1;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+void manapi::json_view::throw_could_not_use_func(const char *func) const {
+    THROW_MANAPI_JSON_ERROR(ERR_JSON_UNSUPPORTED_TYPE, "json object with type {} could not use func: {}", static_cast <int> (type()), func);
+}
+
+// =================[json_view::iterator    ]================= //
+
+manapi::json_view::iterator::iterator(const json_tape *tape, const size_t &index, const bool &object) : tape (tape), index (index), object (object) {}
+
+manapi::json_view manapi::json_view::iterator::operator*() const {
+    return {tape, object ? index + 1 : index};
+}
+
+manapi::json_view::iterator &manapi::json_view::iterator::operator++() {
+    index = tape->skip(object ? index + 1 : index);
+
+    return *this;
+}
+
+bool manapi::json_view::iterator::operator==(const iterator &other) const {
+    return index == other.index;
+}
+
+std::string_view manapi::json_view::iterator::key() const {
+    if (!object)
+    {
+        THROW_MANAPI_JSON_ERROR(ERR_JSON_UNSUPPORTED_TYPE, "json object with type {} could not use func: {}", static_cast <int> (json::type_array), __FUNCTION__);
+    }
+
+    return tape->string(index);
+}
@@ -0,0 +1,243 @@
+#include <charconv>
+#include <cstring>
+#include <format>
+
+#include "ManapiJsonWriter.hpp"
+
+#define THROW_MANAPI_JSON_ERROR(errnum, msg, ...) throw manapi::json_parse_exception (errnum, std::format(msg, __VA_ARGS__));
+
+manapi::json_writer::json_writer(handler_t handler, const size_t &block_size, const bool &chunked) : handler (std::move(handler)), block_size (block_size), chunked (chunked) {
+    prefix = chunked ? chunk_head_size : 0;
+
+    // + the last item + the end of the chunk
+    buffer.reserve(prefix + block_size + block_size / 4 + 7);
+    buffer.resize(prefix);
+}
+
+manapi::json_writer &manapi::json_writer::begin_object() {
+    before_value();
+
+    buffer += '{';
+
+    stack.push_back(true);
+    first = true;
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::end_object() {
+    close(true);
+
+    buffer += '}';
+
+    after_value();
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::begin_array() {
+    before_value();
+
+    buffer += '[';
+
+    stack.push_back(false);
+    first = true;
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::end_array() {
+    close(false);
+
+    buffer += ']';
+
+    after_value();
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::key(const std::string_view &key) {
+    if (stack.empty() || !stack.back() || after_key)
+    {
+        THROW_MANAPI_JSON_ERROR(ERR_JSON_UNSUPPORTED_TYPE, "json_writer: the key is not expected: {}", key);
+    }
+
+    if (!first)
+    {
+        buffer += ',';
+    }
+
+    json::dump_string(buffer, key);
+    buffer += ':';
+
+    after_key = true;
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::value(const std::string_view &str) {
+    before_value();
+    json::dump_string(buffer, str);
+    after_value();
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::value(const std::string &str) {
+    return value(std::string_view (str));
+}
+
+manapi::json_writer &manapi::json_writer::value(const char *str) {
+    return value(std::string_view (str));
+}
+
+manapi::json_writer &manapi::json_writer::value(const double &num) {
+    return value(static_cast<json::DECIMAL>(num));
+}
+
+manapi::json_writer &manapi::json_writer::value(const json::DECIMAL &num) {
+    before_value();
+    json::dump_decimal(buffer, num);
+    after_value();
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::value(const bool &b) {
+    before_value();
+    buffer += b ? "true" : "false";
+    after_value();
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::value(const std::nullptr_t &) {
+    before_value();
+    buffer += "null";
+    after_value();
+
+    return *this;
+}
+
+manapi::json_writer &manapi::json_writer::value(const json &obj) {
+    before_value();
+    obj.dump_to(buffer);
+    after_value();
+
+    return *this;
+}
+
+void manapi::json_writer::flush() {
+    // the empty chunk is the end of the body
+    if (buffer.size() == prefix)
+    {
+        return;
+    }
+
+    emit(false);
+}
+
+void manapi::json_writer::finish() {
+    if (!chunked)
+    {
+        flush();
+        return;
+    }
+
+    if (buffer.size() == prefix)
+    {
+        handler("0\r\n\r\n", 5);
+
+        written += 5;
+        return;
+    }
+
+    emit(true);
+}
+
+bool manapi::json_writer::is_complete() const {
+    return complete;
+}
+
+size_t manapi::json_writer::get_written() const {
+    return written;
+}
+
+void manapi::json_writer::before_value() {
+    if (complete)
+    {
+        THROW_MANAPI_JSON_ERROR(ERR_JSON_UNSUPPORTED_TYPE, "json_writer: {}", "the document is already complete");
+    }
+
+    if (stack.empty())
+    {
+        return;
+    }
+
+    if (stack.back())
+    {
+        if (!after_key)
+        {
+            THROW_MANAPI_JSON_ERROR(ERR_JSON_UNSUPPORTED_TYPE, "json_writer: {}", "the value of the object without the key");
+        }
+
+        after_key = false;
+    }
+    else if (!first)
+    {
+        buffer += ',';
+    }
+}
+
+void manapi::json_writer::after_value() {
+    first = false;
+
+    if (stack.empty())
+    {
+        complete = true;
+    }
+
+    // the blocks of the socket
+    if (buffer.size() - prefix >= block_size)
+    {
+        flush();
+    }
+}
+
+void manapi::json_writer::close(const bool &object) {
+    if (stack.empty() || stack.back() != object || after_key)
+    {
+        THROW_MANAPI_JSON_ERROR(ERR_JSON_UNSUPPORTED_TYPE, "json_writer: the end of the {} is not expected", object ? "object" : "array");
+    }
+
+    stack.pop_back();
+}
+
+void manapi::json_writer::emit(const bool &last) {
+    size_t offset = 0;
+
+    if (chunked)
+    {
+        char head[chunk_head_size];
+
+        char *end = std::to_chars(head, head + sizeof (head), buffer.size() - prefix, 16).ptr;
+        *end++ = '\r';
+        *end++ = '\n';
+
+        // the head is right before the data
+        offset = prefix - (end - head);
+        memcpy(buffer.data() + offset, head, end - head);
+
+        buffer += "\r\n";
+
+        if (last)
+        {
+            buffer += "0\r\n\r\n";
+        }
+    }
+
+    handler(buffer.data() + offset, buffer.size() - offset);
+
+    written += buffer.size() - offset;
+    buffer.resize(prefix);
+}
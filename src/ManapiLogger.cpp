@@ -0,0 +1,335 @@
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <unistd.h>
+
+#include "ManapiLogger.hpp"
+
+manapi::net::utils::logger &manapi::net::utils::logger::shared() {
+    // never deleted, the static destructors can log
+    static logger *instance = [] () -> logger * {
+        const auto created = new logger();
+
+        std::atexit([] () -> void { shared().stop(); });
+
+        return created;
+    } ();
+
+    return *instance;
+}
+
+manapi::net::utils::logger::logger() {
+    slots = std::make_unique<slot_t[]>(capacity);
+
+    for (size_t i = 0; i < capacity; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    flusher = std::thread ([this] () -> void { run(); });
+}
+
+bool manapi::net::utils::logger::allow(const char *file, const size_t &line, uint32_t &suppressed) {
+    suppressed = 0;
+
+    const size_t max = rate.load(std::memory_order_relaxed);
+
+    if (max == 0)
+    {
+        return true;
+    }
+
+    // the call site is the pointer to the file name + the line
+    auto &limit = limits[(reinterpret_cast<uintptr_t>(file) >> 3 ^ line * 0x9E3779B97F4A7C15ULL) % limits_count];
+
+    const auto second = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+
+    uint64_t state = limit.state.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        uint64_t next;
+
+        if (state >> 24 == second)
+        {
+            if ((state & 0xFFFFFF) >= max)
+            {
+                limit.suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            next = state + 1;
+        }
+        else
+        {
+            next = second << 24 | 1;
+        }
+
+        if (limit.state.compare_exchange_weak(state, next, std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    if (limit.suppressed.load(std::memory_order_relaxed) > 0)
+    {
+        suppressed = limit.suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    return true;
+}
+
+void manapi::net::utils::logger::write(const log_level_t &level, const err_num &errnum, const size_t &line, const char *file, const char *func, const uint32_t &suppressed, const std::string_view &message) {
+    static thread_local const pid_t thread = gettid();
+
+    size_t position = tail.load(std::memory_order_relaxed);
+    slot_t *slot;
+
+    while (true)
+    {
+        slot = &slots[position % capacity];
+
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+        if (diff == 0)
+        {
+            if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // the flusher is behind
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    auto &record        = slot->record;
+
+    record.time         = std::chrono::system_clock::now();
+    record.file         = file;
+    record.func         = func;
+    record.line         = line;
+    record.errnum       = errnum;
+    record.thread       = thread;
+    record.suppressed   = suppressed;
+    record.level        = level;
+    record.size         = static_cast<uint16_t>(std::min(message.size(), message_size));
+
+    memcpy(record.message, message.data(), record.size);
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    // the record is visible before the flag is read, pairs with run()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (idle.load(std::memory_order_relaxed))
+    {
+        wake();
+    }
+
+    if (!running.load(std::memory_order_relaxed))
+    {
+        // after the exit, the flusher is stopped
+        flush();
+    }
+}
+
+void manapi::net::utils::logger::flush() {
+    std::lock_guard<std::mutex> lk (m_drain);
+
+    drain();
+}
+
+void manapi::net::utils::logger::stop() {
+    if (!running.exchange(false))
+    {
+        return;
+    }
+
+    wake();
+
+    if (flusher.joinable())
+    {
+        flusher.join();
+    }
+
+    flush();
+}
+
+void manapi::net::utils::logger::set_format(const log_format_t &format) {
+    this->format.store(format, std::memory_order_relaxed);
+}
+
+void manapi::net::utils::logger::set_rate_limit(const size_t &rate) {
+    this->rate.store(rate, std::memory_order_relaxed);
+}
+
+size_t manapi::net::utils::logger::get_dropped() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void manapi::net::utils::logger::run() {
+    while (running.load(std::memory_order_relaxed))
+    {
+        bool written;
+
+        {
+            std::lock_guard<std::mutex> lk (m_drain);
+
+            written = drain();
+        }
+
+        if (!written)
+        {
+            // sleep until a producer publishes the record or the stop
+            idle.store(true);
+
+            if (running.load() && !pending())
+            {
+                idle.wait(true);
+            }
+
+            idle.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool manapi::net::utils::logger::pending() const {
+    const size_t position = head.load(std::memory_order_relaxed);
+
+    return slots[position % capacity].sequence.load() == position + 1;
+}
+
+void manapi::net::utils::logger::wake() {
+    idle.store(false, std::memory_order_relaxed);
+    idle.notify_one();
+}
+
+bool manapi::net::utils::logger::drain() {
+    std::string out;
+    std::string err;
+
+    size_t position = head.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        auto &slot = slots[position % capacity];
+
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+        {
+            // empty or the record is not finished yet
+            break;
+        }
+
+        append(slot.record.level == LOG_ERROR ? err : out, slot.record);
+
+        slot.sequence.store(position + capacity, std::memory_order_release);
+        position++;
+
+        head.store(position, std::memory_order_relaxed);
+    }
+
+    if (const size_t count = dropped.load(std::memory_order_relaxed); count != dropped_written)
+    {
+        err += std::format("[logger]: {} records are dropped, the ring is full\n", count - dropped_written);
+
+        dropped_written = count;
+    }
+
+    // one syscall per batch
+    for (const auto &[fd, data]: {std::pair<int, std::string *> {STDOUT_FILENO, &out}, {STDERR_FILENO, &err}})
+    {
+        for (size_t offset = 0; offset < data->size();)
+        {
+            const ssize_t written = ::write(fd, data->data() + offset, data->size() - offset);
+
+            if (written <= 0)
+            {
+                break;
+            }
+
+            offset += written;
+        }
+    }
+
+    return !out.empty() || !err.empty();
+}
+
+void manapi::net::utils::logger::append(std::string &out, const record_t &record) {
+    const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch()).count();
+    const int64_t second    = microseconds / 1000000;
+
+    if (second != time_second)
+    {
+        const std::time_t t = second;
+        std::tm tm {};
+
+        localtime_r(&t, &tm);
+
+        char buffer[32];
+        time_text.assign(buffer, std::strftime(buffer, sizeof (buffer), format == LOG_FORMAT_JSON ? "%Y-%m-%dT%H:%M:%S" : "%H:%M:%S", &tm));
+
+        time_second = second;
+    }
+
+    const std::string_view message (record.message, record.size);
+
+    if (format == LOG_FORMAT_JSON)
+    {
+        out += std::format(R"({{"time":"{}.{:06}","level":"{}","errnum":{},"thread":{},"func":"{}","file":"{}","line":{},"suppressed":{},"message":")",
+            time_text, microseconds % 1000000, record.level == LOG_ERROR ? "error" : "debug", static_cast<size_t>(record.errnum), record.thread,
+            record.func, record.file, record.line, record.suppressed);
+
+        for (const auto &c: message)
+        {
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        out += std::format("\\u{:04x}", c);
+                    }
+                    else
+                    {
+                        out += c;
+                    }
+            }
+        }
+
+        out += "\"}\n";
+
+        return;
+    }
+
+    out += std::format("[{}][{}]: {}() ({}:{}): ", time_text, static_cast<size_t>(record.errnum), record.func, record.file, record.line);
+    out += message;
+
+    if (record.suppressed > 0)
+    {
+        out += std::format(" (+{} suppressed)", record.suppressed);
+    }
+
+    out += '\n';
+}
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <bit>
+#include <format>
+
+#include "ManapiMetrics.hpp"
+
+namespace manapi::net::metrics {
+    // the upper bounds of the exported buckets (microseconds)
+    static constexpr uint64_t   histogram_bounds[] = {
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000
+    };
+
+    static std::atomic<size_t>  next_slot   = 0;
+
+    static size_t thread_slot () {
+        thread_local const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % slots_count;
+
+        return slot;
+    }
+}
+
+// ======================[ counter ]==========================
+
+void manapi::net::metrics::counter::add(const uint64_t &value) {
+    slots[thread_slot()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t manapi::net::metrics::counter::get() const {
+    uint64_t value = 0;
+
+    for (const auto &slot: slots)
+    {
+        value += slot.value.load(std::memory_order_relaxed);
+    }
+
+    return value;
+}
+
+// ======================[ histogram ]==========================
+
+void manapi::net::metrics::histogram::record(const uint64_t &value) {
+    buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+
+    count.add();
+    sum.add(value);
+}
+
+uint64_t manapi::net::metrics::histogram::get_count() const {
+    return count.get();
+}
+
+uint64_t manapi::net::metrics::histogram::get_sum() const {
+    return sum.get();
+}
+
+uint64_t manapi::net::metrics::histogram::count_below(const uint64_t &value) const {
+    uint64_t result = 0;
+
+    for (size_t i = 0; i < buckets_count && lower(i) <= value; i++)
+    {
+        result += buckets[i].load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+size_t manapi::net::metrics::histogram::index(const uint64_t &value) {
+    if (value < sub_count)
+    {
+        return value;
+    }
+
+    const size_t msb = 63 - std::countl_zero(value);
+
+    if (msb >= max_bits)
+    {
+        return buckets_count - 1;
+    }
+
+    // the power of two selects the group, the next bits select the bucket in the group
+    const size_t shift = msb - sub_bits;
+
+    return (shift + 1) * sub_count + (value >> shift & (sub_count - 1));
+}
+
+uint64_t manapi::net::metrics::histogram::lower(const size_t &index) {
+    if (index < sub_count)
+    {
+        return index;
+    }
+
+    const size_t shift = index / sub_count - 1;
+
+    return (sub_count + index % sub_count) << shift;
+}
+
+// ======================[ writer ]==========================
+
+void manapi::net::metrics::writer::add_counter(const std::string &name, const std::string &help, const double &value, const std::string &labels) {
+    sample(family(name, help, "counter").samples, name, labels, value);
+}
+
+void manapi::net::metrics::writer::add_gauge(const std::string &name, const std::string &help, const double &value, const std::string &labels) {
+    sample(family(name, help, "gauge").samples, name, labels, value);
+}
+
+void manapi::net::metrics::writer::add_histogram(const std::string &name, const std::string &help, const histogram &value, const std::string &labels) {
+    auto &samples = family(name, help, "histogram").samples;
+
+    const std::string prefix = labels.empty() ? "" : labels + ',';
+
+    // the count is read first, so the buckets are not larger than +Inf
+    const uint64_t count = value.get_count();
+
+    for (const auto &bound: histogram_bounds)
+    {
+        sample(samples, name + "_bucket", prefix + label("le", std::format("{}", static_cast<double>(bound) / 1e6)),
+            static_cast<double>(std::min(count, value.count_below(bound))));
+    }
+
+    sample(samples, name + "_bucket", prefix + label("le", "+Inf"), static_cast<double>(count));
+    sample(samples, name + "_sum", labels, static_cast<double>(value.get_sum()) / 1e6);
+    sample(samples, name + "_count", labels, static_cast<double>(count));
+}
+
+std::string manapi::net::metrics::writer::str() const {
+    std::string out;
+
+    for (const auto &name: order)
+    {
+        const auto &f = families.at(name);
+
+        out += "# HELP " + name + ' ' + f.help + '\n';
+        out += "# TYPE " + name + ' ' + f.type + '\n';
+        out += f.samples;
+    }
+
+    return out;
+}
+
+manapi::net::metrics::writer::family_t &manapi::net::metrics::writer::family(const std::string &name, const std::string &help, const std::string &type) {
+    const auto [it, inserted] = families.try_emplace(name);
+
+    if (inserted)
+    {
+        it->second.help = help;
+        it->second.type = type;
+
+        order.push_back(name);
+    }
+
+    return it->second;
+}
+
+void manapi::net::metrics::writer::sample(std::string &out, const std::string &name, const std::string &labels, const double &value) {
+    out += name;
+
+    if (!labels.empty())
+    {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+
+    out += std::format(" {}\n", value);
+}
+
+// ======================[ registry ]==========================
+
+manapi::net::metrics::histogram *manapi::net::metrics::registry::route(const std::string &method, const std::string &uri) {
+    std::lock_guard<std::mutex> lk (mutex);
+
+    auto &item = routes[{method, uri}];
+
+    if (item == nullptr)
+    {
+        item = std::make_unique<histogram>();
+    }
+
+    return item.get();
+}
+
+size_t manapi::net::metrics::registry::add_collector(collector_t collector) {
+    std::lock_guard<std::mutex> lk (mutex);
+
+    // 0 -> not registered
+    const size_t id = ++next_collector;
+
+    collectors.insert({id, std::move(collector)});
+
+    return id;
+}
+
+void manapi::net::metrics::registry::remove_collector(const size_t &id) {
+    if (id == 0)
+    {
+        return;
+    }
+
+    // waits for the scrape, the collector can use the pool
+    std::lock_guard<std::mutex> lk (mutex);
+
+    collectors.erase(id);
+}
+
+std::string manapi::net::metrics::registry::render() const {
+    writer out;
+
+    // closed before accepted, so the active connections are not negative
+    const uint64_t closed_count     = closed.get();
+    const uint64_t accepted_count   = std::max(accepted.get(), closed_count);
+
+    out.add_counter("manapi_connections_accepted_total", "The accepted connections.", static_cast<double>(accepted_count));
+    out.add_gauge("manapi_connections_active", "The open connections.", static_cast<double>(accepted_count - closed_count));
+
+    out.add_counter("manapi_http_requests_total", "The handled requests.", static_cast<double>(requests.get()));
+    out.add_counter("manapi_received_bytes_total", "The bytes read from the sockets.", static_cast<double>(bytes_in.get()));
+    out.add_counter("manapi_sent_bytes_total", "The bytes written to the sockets.", static_cast<double>(bytes_out.get()));
+
+    const uint64_t compress_in_count = compress_in.get();
+    const uint64_t compress_out_count = compress_out.get();
+
+    out.add_counter("manapi_compress_input_bytes_total", "The bodies before the compression.", static_cast<double>(compress_in_count));
+    out.add_counter("manapi_compress_output_bytes_total", "The bodies after the compression.", static_cast<double>(compress_out_count));
+    out.add_gauge("manapi_compress_ratio", "The compressed size / the original size.", compress_in_count == 0 ? 1 : static_cast<double>(compress_out_count) / static_cast<double>(compress_in_count));
+
+    out.add_histogram("manapi_timer_lag_seconds", "The delay of the timers after the deadline.", timer_lag);
+
+    out.add_counter("manapi_quic_packets_received_total", "The packets of the closed QUIC connections.", static_cast<double>(quic_recv.get()));
+    out.add_counter("manapi_quic_packets_sent_total", "The packets of the closed QUIC connections.", static_cast<double>(quic_sent.get()));
+    out.add_counter("manapi_quic_packets_lost_total", "The packets of the closed QUIC connections.", static_cast<double>(quic_lost.get()));
+    out.add_histogram("manapi_quic_rtt_seconds", "The RTT of the closed QUIC connections.", quic_rtt);
+
+    std::lock_guard<std::mutex> lk (mutex);
+
+    for (const auto &[key, value]: routes)
+    {
+        out.add_histogram("manapi_http_request_duration_seconds", "The time of the requests by the page.", *value, label("method", key.first) + ',' + label("route", key.second));
+    }
+
+    out.add_histogram("manapi_http_request_duration_seconds", "The time of the requests by the page.", unmatched, label("method", "") + ',' + label("route", ""));
+
+    for (const auto &collector: collectors)
+    {
+        collector.second (out);
+    }
+
+    return out.str();
+}
+
+std::string manapi::net::metrics::label(const std::string &name, const std::string &value) {
+    std::string result = name + "=\"";
+
+    for (const auto &c: value)
+    {
+        switch (c) {
+            case '\\':
+                result += "\\\\";
+                break;
+            case '"':
+                result += "\\\"";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            default:
+                result += c;
+        }
+    }
+
+    result += '"';
+
+    return result;
+}
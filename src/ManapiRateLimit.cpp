@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "ManapiRateLimit.hpp"
+
+manapi::net::rate_limiter::rate_limiter(const rate_limit_config_t &config) : config (config) {
+    shard_entries = std::max<size_t>(1, config.max_entries / shards_count);
+
+    for (auto &s: shards)
+    {
+        s.overflow.tokens = static_cast<double>(config.burst);
+        s.overflow.updated = std::chrono::steady_clock::now();
+    }
+}
+
+bool manapi::net::rate_limiter::make_key(const sockaddr *addr, key_t &key) {
+    if (addr->sa_family == AF_INET)
+    {
+        key.hi      = 0;
+        key.lo      = ntohl(reinterpret_cast<const sockaddr_in *>(addr)->sin_addr.s_addr);
+        key.prefix  = 32;
+
+        return true;
+    }
+
+    if (addr->sa_family == AF_INET6)
+    {
+        const auto &in6 = reinterpret_cast<const sockaddr_in6 *>(addr)->sin6_addr;
+
+        if (IN6_IS_ADDR_V4MAPPED(&in6))
+        {
+            uint32_t v4;
+            memcpy(&v4, in6.s6_addr + 12, sizeof (v4));
+
+            key.hi      = 0;
+            key.lo      = ntohl(v4);
+            key.prefix  = 32;
+
+            return true;
+        }
+
+        uint8_t bytes[16];
+        memcpy(bytes, in6.s6_addr, sizeof (bytes));
+
+        key.hi      = 0;
+        key.lo      = 0;
+
+        for (size_t i = 0; i < 8; i++)
+        {
+            key.hi  = key.hi << 8 | bytes[i];
+            key.lo  = key.lo << 8 | bytes[i + 8];
+        }
+
+        key.prefix  = 128;
+
+        return true;
+    }
+
+    return false;
+}
+
+bool manapi::net::rate_limiter::make_key(const std::string &ip, key_t &key) {
+    sockaddr_storage addr {};
+
+    if (inet_pton(AF_INET, ip.data(), &reinterpret_cast<sockaddr_in *>(&addr)->sin_addr) == 1)
+    {
+        addr.ss_family = AF_INET;
+    }
+    else if (inet_pton(AF_INET6, ip.data(), &reinterpret_cast<sockaddr_in6 *>(&addr)->sin6_addr) == 1)
+    {
+        addr.ss_family = AF_INET6;
+    }
+    else
+    {
+        return false;
+    }
+
+    return make_key(reinterpret_cast<const sockaddr *>(&addr), key);
+}
+
+bool manapi::net::rate_limiter::allow(const key_t &key, const double &cost) {
+    const auto now = std::chrono::steady_clock::now();
+
+    {
+        auto &s = shard(key);
+        std::lock_guard<std::mutex> lk (s.mutex);
+
+        const auto bucket = find(s, key, static_cast<double>(config.burst), now);
+
+        if (!take(bucket != nullptr ? *bucket : s.overflow, static_cast<double>(config.rate), static_cast<double>(config.burst), cost, now))
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    if (config.subnet_rate == 0)
+    {
+        return true;
+    }
+
+    const auto net = subnet(key);
+
+    auto &s = shard(net);
+    std::lock_guard<std::mutex> lk (s.mutex);
+
+    const auto bucket = find(s, net, static_cast<double>(config.subnet_burst), now);
+
+    if (bucket == nullptr)
+    {
+        // the overflow bucket is already charged by the address
+        return true;
+    }
+
+    if (!take(*bucket, static_cast<double>(config.subnet_rate), static_cast<double>(config.subnet_burst), cost, now))
+    {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+bool manapi::net::rate_limiter::connect(const key_t &key, bool &counted) {
+    counted = false;
+
+    if (config.max_connections == 0)
+    {
+        return true;
+    }
+
+    auto &s = shard(key);
+    std::lock_guard<std::mutex> lk (s.mutex);
+
+    const auto bucket = find(s, key, static_cast<double>(config.burst), std::chrono::steady_clock::now());
+
+    if (bucket == nullptr)
+    {
+        // the table is full, the connections are not counted
+        return true;
+    }
+
+    if (bucket->connections >= config.max_connections)
+    {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bucket->connections++;
+    counted = true;
+
+    return true;
+}
+
+void manapi::net::rate_limiter::disconnect(const key_t &key) {
+    if (config.max_connections == 0)
+    {
+        return;
+    }
+
+    auto &s = shard(key);
+    std::lock_guard<std::mutex> lk (s.mutex);
+
+    if (const auto it = s.buckets.find(key); it != s.buckets.end() && it->second.connections > 0)
+    {
+        it->second.connections--;
+    }
+}
+
+void manapi::net::rate_limiter::sweep() {
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto &s: shards)
+    {
+        std::lock_guard<std::mutex> lk (s.mutex);
+
+        sweep(s, now);
+    }
+}
+
+const manapi::net::rate_limit_config_t &manapi::net::rate_limiter::get_config() const {
+    return config;
+}
+
+size_t manapi::net::rate_limiter::get_rejected() const {
+    return rejected.load(std::memory_order_relaxed);
+}
+
+size_t manapi::net::rate_limiter::key_hash_t::operator()(const key_t &key) const {
+    // splitmix64 finalizer
+    uint64_t x = key.hi * 0x9E3779B97F4A7C15ULL ^ key.lo ^ static_cast<uint64_t>(key.prefix) << 56;
+
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+
+    return x;
+}
+
+manapi::net::rate_limiter::key_t manapi::net::rate_limiter::subnet(const key_t &key) {
+    if (key.prefix == 32)
+    {
+        return {0, key.lo & 0xFFFFFF00ULL, 24};
+    }
+
+    return {key.hi, 0, 64};
+}
+
+bool manapi::net::rate_limiter::take(bucket_t &bucket, const double &rate, const double &burst, const double &cost, const std::chrono::steady_clock::time_point &now) {
+    const double elapsed = std::chrono::duration<double>(now - bucket.updated).count();
+
+    bucket.tokens   = std::min(burst, bucket.tokens + elapsed * rate);
+    bucket.updated  = now;
+
+    if (bucket.tokens < cost)
+    {
+        return false;
+    }
+
+    bucket.tokens -= cost;
+
+    return true;
+}
+
+manapi::net::rate_limiter::bucket_t *manapi::net::rate_limiter::find(shard_t &shard, const key_t &key, const double &burst, const std::chrono::steady_clock::time_point &now) {
+    if (const auto it = shard.buckets.find(key); it != shard.buckets.end())
+    {
+        return &it->second;
+    }
+
+    if (shard.buckets.size() >= shard_entries)
+    {
+        // the limiters without the timer are compacted here, not often under the flood
+        if (now - shard.swept >= std::chrono::seconds(1))
+        {
+            sweep(shard, now);
+        }
+
+        if (shard.buckets.size() >= shard_entries)
+        {
+            return nullptr;
+        }
+    }
+
+    return &shard.buckets.insert({key, bucket_t {burst, now, 0}}).first->second;
+}
+
+void manapi::net::rate_limiter::sweep(shard_t &shard, const std::chrono::steady_clock::time_point &now) const {
+    shard.swept = now;
+
+    std::erase_if(shard.buckets, [this, &now] (const auto &item) -> bool {
+        const bool      address = item.first.prefix == 32 || item.first.prefix == 128;
+        const double    rate    = static_cast<double>(address ? config.rate : config.subnet_rate);
+        const double    burst   = static_cast<double>(address ? config.burst : config.subnet_burst);
+
+        const double    elapsed = std::chrono::duration<double>(now - item.second.updated).count();
+
+        return item.second.connections == 0 && item.second.tokens + elapsed * rate >= burst;
+    });
+}
+
+manapi::net::rate_limiter::shard_t &manapi::net::rate_limiter::shard(const key_t &key) {
+    return shards[key_hash_t{}(key) % shards_count];
+}
@@ -52,7 +52,7 @@ void manapi::net::site::setup() {
 }
 
 void manapi::net::site::timer_pool_setup(threadpool<task> *tasks_pool) {
-    timerpool = std::make_unique<utils::timerpool>(*tasks_pool, 5);
+    timerpool = std::make_unique<utils::timerpool>(*tasks_pool, 5, &metrics_registry.timer_lag);
     tasks_pool->append_task(std::make_unique<function_task>([this] () -> void { timerpool->doit(); }));
 }
 
@@ -362,6 +362,7 @@ manapi::net::http_uri_part *manapi::net::site::set_handler(const std::string &me
                 cur->handlers = std::make_unique<handlers_types_t> ();
             }
             check_exists_method_on_url(uri, cur->handlers, method);
+            functions.latency = metrics_registry.route(method, uri);
             cur->handlers->insert({method, std::move(functions)});
 
             break;
@@ -389,6 +390,19 @@ manapi::net::http_uri_part *manapi::net::site::set_handler(const std::string &me
     return cur;
 }
 
+manapi::net::http_uri_part *manapi::net::site::set_handler(const std::string &method, const std::string &uri, const handler_template_t &handler, const http_cache_config_t &cache, const json_mask &get_mask, const json_mask &post_mask) {
+    http_uri_part *cur      = set_handler(method, uri, handler, get_mask, post_mask);
+
+    if (cur->handlers == nullptr || !cur->handlers->contains(method))
+    {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_ADD_PAGE, "{}", "the cache can be used only with the pages");
+    }
+
+    cur->handlers->at(method).cache = std::make_unique<http_response_cache> (cache);
+
+    return cur;
+}
+
 manapi::net::http_uri_part *manapi::net::site::set_handler(const std::string &method, const std::string &uri, const std::string &folder) {
     size_t  type            = URI_PAGE_DEFAULT;
 
@@ -412,6 +426,49 @@ manapi::net::http_uri_part *manapi::net::site::set_handler(const std::string &me
     return cur;
 }
 
+void manapi::net::site::set_rate_limit(const std::string &method, const std::string &uri, const rate_limit_config_t &limit) {
+    size_t  type            = URI_PAGE_DEFAULT;
+
+    http_uri_part *cur      = build_uri_part(uri, type);
+
+    if (type != URI_PAGE_DEFAULT || cur->handlers == nullptr || !cur->handlers->contains(method))
+    {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_ADD_PAGE, "the page {} {} is not found", method, uri);
+    }
+
+    cur->handlers->at(method).limiter = std::make_unique<rate_limiter> (limit);
+}
+
+void manapi::net::site::enable_metrics(const std::string &uri) {
+    set_handler("GET", uri, [this] (http_request &req, http_response &res) -> void {
+        res.set_header(HTTP_HEADER.CONTENT_TYPE, "text/plain; version=0.0.4; charset=utf-8");
+        res.text(metrics_registry.render());
+    });
+
+    // the queues are read only by the scrape
+    metrics_registry.add_collector([this] (metrics::writer &out) -> void {
+        const auto &pool = get_tasks_pool();
+
+        if (pool == nullptr)
+        {
+            return;
+        }
+
+        for (size_t level = 0; level < pool->get_queues_count(); level++)
+        {
+            const std::string labels = metrics::label("level", std::to_string(level));
+
+            out.add_gauge("manapi_tasks_queue_size", "The tasks waiting for the thread.", static_cast<double>(pool->get_queue_size(level)), labels);
+            out.add_gauge("manapi_tasks_queue_sojourn_seconds", "The time in the queue of the last started task.", std::chrono::duration<double>(pool->get_sojourn(level)).count(), labels);
+            out.add_gauge("manapi_tasks_overloaded", "The admission control rejects the new work.", pool->is_overloaded(level) ? 1 : 0, labels);
+        }
+    });
+}
+
+manapi::net::metrics::registry &manapi::net::site::get_metrics() {
+    return metrics_registry;
+}
+
 manapi::net::http_uri_part *manapi::net::site::build_uri_part(const std::string &uri, size_t &type)
 {
     std::string                 buff;
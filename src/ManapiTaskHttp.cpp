@@ -26,16 +26,38 @@
 #include "ManapiFilesystem.hpp"
 #include "ManapiTaskFunction.hpp"
 
-#define MANAPI_TASK_HTTP_TCP_NEXT_BLOCK_IF_NEEDED(_x) if (_x == size) {         \
-request_data.headers_size += _x;                                                \
-if (!manapi::net::http_task::read_next_part (maxsize, _x, this, &request_data)) \
-    return;                                                                     \
+// the head is accumulated by tcp_prepare, so the end of the buffer is the malformed head
+#define MANAPI_TASK_HTTP_TCP_NEXT_BLOCK_IF_NEEDED(_x) if (_x >= size) {                             \
+THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "the request head is malformed at {}", _x);         \
 }
 
 #define MANAPI_QUIC_CONNECTION_ID_LEN 16
 
+#ifdef MANAPI_HTTP_TRACING
+#define MANAPI_TASK_HTTP_TRACE_HEAD(_res) trace_response_head(_res)
+#else
+#define MANAPI_TASK_HTTP_TRACE_HEAD(_res) ((void) 0)
+#endif
+
 manapi::net::http_task::~http_task() {
-    delete []static_cast<uint8_t *>(buff);
+    if (conn_type == CONN_TCP) {
+        site->get_metrics().closed.add();
+    }
+
+    if (conn_limiter != nullptr) {
+        conn_limiter->disconnect(conn_key);
+    }
+
+    if (h2_connections != nullptr) {
+        h2_connections->fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    if (buff_pool != nullptr) {
+        buff_pool->release(static_cast<uint8_t *>(buff));
+    }
+    else {
+        delete []static_cast<uint8_t *>(buff);
+    }
 }
 
 manapi::net::http_task::http_task(int _fd, const sockaddr &_client, const socklen_t &_client_len,
@@ -53,14 +75,47 @@ manapi::net::http_task::http_task(int _fd, const sockaddr &_client, const sockle
         .port = htons(reinterpret_cast<struct sockaddr_in *>(&client)->sin_port)
     };
 
-    buff = new uint8_t[config->get_socket_block_size()];
+    buff_pool = config->get_buffer_pool();
+    limiter = config->get_rate_limiter();
+    access = config->get_access_log();
+#ifdef MANAPI_HTTP_TRACING
+    request_tracer = config->get_tracer();
+#endif
+
+    if (buff_pool != nullptr && buff_pool->get_block_size() >= config->get_socket_block_size()) {
+        buff = buff_pool->acquire();
+    }
+    else {
+        buff_pool = nullptr;
+        buff = new uint8_t[config->get_socket_block_size()];
+    }
 
     buff_size = 0;
+
+    // the QUIC connections are counted by the pool, the streams are not the connections
+    if (conn_type == CONN_TCP) {
+        site->get_metrics().accepted.add();
+    }
+    else {
+        // the streams are dispatched after the headers, TCP after tcp_prepare ()
+        MANAPI_TRACE_BEGIN(spans, TRACE_QUEUE);
+    }
+}
+
+void manapi::net::http_task::set_conn_limiter(const std::shared_ptr<rate_limiter> &limiter, const rate_limiter::key_t &key) {
+    conn_limiter = limiter;
+    conn_key = key;
+}
+
+void manapi::net::http_task::set_h2_connections(const std::shared_ptr<std::atomic<size_t> > &counter) {
+    h2_connections = counter;
 }
 
 // DO ITS
 
 void manapi::net::http_task::doit() {
+    MANAPI_TRACE_END(spans, TRACE_QUEUE);
+
     switch (conn_type) {
         case CONN_TCP: {
             tcp_doit();
@@ -70,6 +125,10 @@ void manapi::net::http_task::doit() {
             udp_doit();
             break;
         }
+        case CONN_H2: {
+            h2_doit();
+            break;
+        }
         default:
             THROW_MANAPI_EXCEPTION(ERR_CONFIG_ERROR, "invalid connection protocol: conn_type = {}", conn_type);
     }
@@ -333,7 +392,9 @@ void manapi::net::http_task::udp_doit() {
         }
     });
 
+    MANAPI_TRACE_BEGIN(spans, TRACE_ROUTE);
     const auto handler = site->get_handler(request_data);
+    MANAPI_TRACE_END(spans, TRACE_ROUTE);
 
     if (request_data.has_body) {
         if (!request_data.headers.contains(HTTP_HEADER.CONTENT_LENGTH)) {
@@ -364,7 +425,7 @@ void manapi::net::http_task::udp_doit() {
 
     handle_request(&handler);
 
-    if (!is_deleting) {
+    if (!is_deleting && !stream_aborted) {
         quiche_h3_send_body(conn_io->http3, conn_io->conn, stream_id, nullptr, 0, true);
     }
 }
@@ -645,6 +706,8 @@ void manapi::net::http_task::quic_generate_output_packages(quic_map_conns_t *qui
                         MANAPI_LOG("connection closed, recv={} sent={} lost={} rtt={} ns cwnd={}",
                                    stats.recv, stats.sent, stats.lost, path_stats.rtt, path_stats.cwnd);
 
+                        quic_closed_metrics(site, stats, path_stats);
+
                         // multi thread
                         auto &conn_io = it->second;
                         http_task::quic_delete_conn_io(conn_io.get(), site);
@@ -689,6 +752,29 @@ bool manapi::net::http_task::socket_wait_select() const {
     return result;
 }
 
+bool manapi::net::http_task::socket_wait_write() const {
+    struct timeval timeout{};
+
+    fd_set write_fds;
+
+    FD_ZERO(&write_fds);
+    FD_SET(conn_fd, &write_fds);
+
+    timeout.tv_sec = config->get_send_timeout();
+    timeout.tv_usec = 0;
+
+    int ready = select(conn_fd + 1, nullptr, &write_fds, nullptr, &timeout);
+
+    if (ready < 0) {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "unknow socket status (select() < 0): {}", conn_fd);
+    } else if (ready == 0) {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "The waiting time of {} seconds has been exceeded",
+                               config->get_send_timeout());
+    }
+
+    return FD_ISSET(conn_fd, &write_fds);
+}
+
 void manapi::net::http_task::quic_set_to_delete(http_task *task) {
     if (!task->is_deleting) {
         task->is_deleting = true;
@@ -704,93 +790,312 @@ void manapi::net::http_task::quic_set_to_delete(http_task *task) {
 
 // tcp doit (pool connections)
 void manapi::net::http_task::tcp_doit() {
-    utils::before_delete bd_tcp_doit([this]() -> void {
+    utils::before_delete bd_tcp_doit([this]() -> void { tcp_close(); });
+
+    // the handshake and the request head are already read by the event loop (tcp_prepare)
+    try {
         if (ssl != nullptr) {
-            SSL_shutdown(ssl);
-            SSL_free(ssl);
+            mask_write = [this](auto &&PH1, auto &&PH2) -> ssize_t {
+                return openssl_write(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
+            };
+            mask_read = [this](auto &&PH1, auto &&PH2) -> ssize_t {
+                return openssl_read(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
+            };
+        } else {
+            mask_write = [this](auto &&PH1, auto &&PH2) -> ssize_t {
+                return socket_write(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
+            };
+            mask_read = [this](auto &&PH1, auto &&PH2) -> ssize_t {
+                return socket_read(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
+            };
         }
 
-        close(conn_fd);
-    });
-    if (socket_wait_select()) {
-        try {
-            if (ssl != nullptr) {
-                SSL_set_fd(ssl, conn_fd);
+        mask_response = [this](auto &&PH1) { return tcp_send_response(std::forward<decltype(PH1)>(PH1)); };
 
-                mask_write = [this](auto &&PH1, auto &&PH2) -> ssize_t {
-                    return openssl_write(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
-                };
-                mask_read = [this](auto &&PH1, auto &&PH2) -> ssize_t {
-                    return openssl_read(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
-                };
+        if (tcp_h2) {
+            const auto h2_connection = std::make_shared<http2::connection>(this, conn_fd, ssl, site, config);
 
-                const auto res = SSL_accept(ssl);
+            // the connection reads the socket itself
+            const std::string initial = std::move(head_data);
+            head_data.clear();
 
-                if (!res) {
-                    THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "couldnt SSL accept: SSL_accept(ssl) = {}", res);
-                }
+            h2_connection->run(initial.data(), initial.size());
+        } else {
+            // the whole head is in head_data (tcp_prepare)
+            size_t head_end = 0;
+
+            MANAPI_TRACE_BEGIN(spans, TRACE_PARSE);
+            tcp_parse_request_response(head_data.data(), head_data.size(), head_end);
+            MANAPI_TRACE_END(spans, TRACE_PARSE);
+
+            // the rest of the head buffer is the beginning of the body
+            const size_t body_part = std::min(head_data.size() - head_end, config->get_socket_block_size());
+
+            memcpy(buff, head_data.data() + head_end, body_part);
+            head_data.erase(0, head_end + body_part);
+
+            size_t content_length = 0;
+            if (request_data.headers.contains(HTTP_HEADER.CONTENT_LENGTH)) {
+                content_length = std::stoull(request_data.headers[HTTP_HEADER.CONTENT_LENGTH]);
+            }
+
+            request_data.has_body = content_length > 0;
+
+            MANAPI_TRACE_BEGIN(spans, TRACE_ROUTE);
+            const auto handler = site->get_handler(request_data);
+            MANAPI_TRACE_END(spans, TRACE_ROUTE);
+
+            if (early_request && !http_task::is_safe_early_method(request_data.method)) {
+                send_error_response(425, HTTP_STATUS.TOO_EARLY_425, handler.error.get());
+                return;
+            }
+
+            if (request_data.has_body) {
+                // the buff contains only the body
+                request_data.headers_part = 0;
+                request_data.body_part = body_part > 0 ? body_part : read_next();
+
+                request_data.body_size = content_length;
+                request_data.body_left = request_data.body_size;
+                request_data.body_ptr = (char *) buff;
+
+                request_data.body_index = 0;
             } else {
-                mask_write = [this](auto &&PH1, auto &&PH2) -> ssize_t {
-                    return socket_write(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
-                };
-                mask_read = [this](auto &&PH1, auto &&PH2) -> ssize_t {
-                    return socket_read(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
-                };
+                request_data.body_ptr = nullptr;
+                request_data.body_size = 0;
             }
 
-            mask_response = [this](auto &&PH1) { return tcp_send_response(std::forward<decltype(PH1)>(PH1)); };
+            handle_request(&handler);
+        }
+    } catch (const manapi::net::utils::exception &e) {
+        MANAPI_LOG("close connection: {}", e.what());
+    }
+}
+
+int manapi::net::http_task::tcp_prepare() {
+    if (ssl != nullptr && !tcp_handshaked) {
+        MANAPI_TRACE_BEGIN(spans, TRACE_HANDSHAKE);
+
+        if (config->get_ssl_config().early_data > 0 && !tcp_early_finished) {
+            const int status = tcp_read_early_data();
+
+            if (status != TCP_PREPARE_DONE) {
+                return status;
+            }
+        }
+
+        const int res = SSL_accept(ssl);
+
+        if (res <= 0) {
+            return tcp_ssl_status(res);
+        }
+
+        tcp_handshaked = true;
+
+        MANAPI_TRACE_END(spans, TRACE_HANDSHAKE);
+
+        // the first block is from 0-RTT, it can be replayed
+        early_request = !early_data.empty();
+
+        head_data = std::move(early_data);
+        early_data.clear();
+
+        const unsigned char *alpn;
+        unsigned int alpn_len;
+
+        SSL_get0_alpn_selected(ssl, &alpn, &alpn_len);
+
+        if (alpn_len == 2 && memcmp(alpn, "h2", 2) == 0) {
+            tcp_h2 = true;
+
+            MANAPI_TRACE_BEGIN(spans, TRACE_QUEUE);
+            return TCP_PREPARE_DONE;
+        }
+
+        if (tcp_head_received(0)) {
+            MANAPI_TRACE_BEGIN(spans, TRACE_QUEUE);
+            return TCP_PREPARE_DONE;
+        }
+    }
+
+    MANAPI_TRACE_BEGIN(spans, TRACE_HEAD);
+
+    // the most heads are read by one syscall, the larger ones double the read size
+    if (tcp_read_size == 0) {
+        tcp_read_size = config->get_tcp_read_size();
+    }
 
-            const ssize_t size = read_next();
+    while (true) {
+        const size_t offset = head_data.size();
+        ssize_t read = 0;
 
-            if (size == -1) {
-                THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "Could not read from the socket: {}", conn_fd);
+        // the bytes are read into the head buffer, the earlier blocks are kept
+        head_data.resize_and_overwrite(offset + tcp_read_size, [this, &read, &offset] (char *data, const size_t &) -> size_t {
+            if (ssl != nullptr) {
+                read = SSL_read(ssl, data + offset, static_cast<int>(tcp_read_size));
             } else {
-                const size_t *socket_block_size = &config->get_socket_block_size();
+                read = recv(conn_fd, data + offset, tcp_read_size, 0);
+            }
 
-                request_data.body_index = 0;
-                request_data.body_size = size;
+            return offset + std::max<ssize_t>(read, 0);
+        });
 
-                tcp_parse_request_response((char *) buff, *socket_block_size, request_data.body_index);
+        if (read <= 0) {
+            if (ssl != nullptr) {
+                return tcp_ssl_status(static_cast<int>(read));
+            }
 
-                size_t content_length = 0;
-                if (request_data.headers.contains(HTTP_HEADER.CONTENT_LENGTH)) {
-                    content_length = std::stoull(request_data.headers[HTTP_HEADER.CONTENT_LENGTH]);
-                }
+            if (read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return TCP_PREPARE_WANT_READ;
+            }
 
-                request_data.has_body = content_length > 0;
+            return TCP_PREPARE_FAILED;
+        }
 
-                const auto handler = site->get_handler(request_data);
+        site->get_metrics().bytes_in.add(read);
 
-                if (request_data.has_body) {
-                    // if the buffer capacity is exhausted
-                    if (request_data.body_index == request_data.body_size) {
-                        request_data.body_part = read_next();
+        if (tcp_head_received(offset)) {
+            config->observe_tcp_head_size(head_data.size());
 
-                        request_data.headers_part = 0;
-                        request_data.body_index = 0;
-                    } else {
-                        // calculate how much space contains headers in the last block
-                        request_data.headers_part = request_data.body_index;
-                        request_data.body_part = request_data.body_size - request_data.headers_part;
-                    }
+            MANAPI_TRACE_END(spans, TRACE_HEAD);
+            MANAPI_TRACE_BEGIN(spans, TRACE_QUEUE);
 
-                    // request.body_size <- now this is the size of all read data
+            return TCP_PREPARE_DONE;
+        }
 
-                    request_data.body_size = content_length;
-                    request_data.body_left = request_data.body_size;
-                    request_data.body_ptr = (char *) buff + request_data.body_index * sizeof(char);
+        if (head_data.size() > config->get_max_header_block_size()) {
+            MANAPI_LOG("the request head is too large: {} > {}", head_data.size(), config->get_max_header_block_size());
+            return TCP_PREPARE_FAILED;
+        }
 
-                    request_data.body_index = 0;
-                } else {
-                    request_data.body_ptr = nullptr;
-                    request_data.body_size = 0;
+        if (static_cast<size_t>(read) == tcp_read_size) {
+            tcp_read_size = std::min(tcp_read_size * 2, config->get_tcp_read_max());
+        }
+    }
+}
+
+bool manapi::net::http_task::is_tcp_handshaked() const {
+    return ssl == nullptr || tcp_handshaked;
+}
+
+bool manapi::net::http_task::is_tcp_h2() const {
+    return tcp_h2;
+}
+
+bool manapi::net::http_task::can_splice() const {
+    return conn_type == CONN_TCP && ssl == nullptr && head_data.empty();
+}
+
+void manapi::net::http_task::tcp_splice(const int &fd, const size_t &size) {
+    int pipes[2];
+
+    if (pipe2(pipes, O_CLOEXEC) < 0) {
+        THROW_MANAPI_EXCEPTION(ERR_FILE_IO, "Could not create the pipe for splice: {}", errno);
+    }
+
+    utils::before_delete bd_pipes ([&pipes] () -> void { close(pipes[0]); close(pipes[1]); });
+
+    for (size_t total = 0; total < size;) {
+        // the socket is read only when the file has taken the previous part
+        const ssize_t in = splice(conn_fd, nullptr, pipes[1], nullptr, std::min<size_t>(size - total, MANAPI_HTTP_SPLICE_SIZE), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+        if (in < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // the client is silent for the timeout -> the upload is failed
+            if (!socket_wait_select()) {
+                THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "Could not splice the body from the socket: {} (timeout)", conn_fd);
+            }
+
+            continue;
+        }
+
+        if (in <= 0) {
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "Could not splice the body from the socket: {}", conn_fd);
+        }
+
+        for (ssize_t out = 0; out < in;) {
+            const ssize_t moved = splice(pipes[0], nullptr, fd, nullptr, in - out, SPLICE_F_MOVE);
+
+            if (moved <= 0) {
+                THROW_MANAPI_EXCEPTION(ERR_FILE_IO, "Could not splice the body to the file: {}", fd);
+            }
+
+            out += moved;
+        }
+
+        total += in;
+        site->get_metrics().bytes_in.add(in);
+    }
+}
+
+void manapi::net::http_task::tcp_close() {
+    if (ssl != nullptr) {
+        SSL_shutdown(ssl);
+        SSL_free(ssl);
+
+        ssl = nullptr;
+    }
+
+    close(conn_fd);
+}
+
+// http2 stream doit (the connection is read by the tcp task)
+void manapi::net::http_task::h2_doit() {
+    const auto id = static_cast<uint32_t>(stream_id);
+
+    mask_read = [this, id](char *part_buff, const size_t &part_buff_size) -> ssize_t {
+        return h2_conn->stream_read(id, part_buff, part_buff_size);
+    };
+
+    mask_write = [this, id](const char *part_buff, const size_t &part_buff_size) -> ssize_t {
+        return h2_conn->stream_write(id, part_buff, part_buff_size);
+    };
+
+    mask_response = [this, id](http_response &res) -> ssize_t { return h2_conn->stream_response(id, res); };
+
+    // END_STREAM or RST_STREAM if the response is not sent
+    utils::before_delete bd_stream([this, id]() -> void { h2_conn->stream_finish(id); });
+
+    try {
+        MANAPI_TRACE_BEGIN(spans, TRACE_ROUTE);
+        const auto handler = site->get_handler(request_data);
+        MANAPI_TRACE_END(spans, TRACE_ROUTE);
+
+        // the stream was opened by 0-RTT
+        if (early_request && !http_task::is_safe_early_method(request_data.method)) {
+            send_error_response(425, HTTP_STATUS.TOO_EARLY_425, handler.error.get());
+            return;
+        }
+
+        if (request_data.has_body) {
+            // END_STREAM delimits the body, the connection checks the content-length if it is present
+            const auto it = request_data.headers.find(HTTP_HEADER.CONTENT_LENGTH);
+
+            request_data.headers_part = 0;
+            request_data.body_size = it != request_data.headers.end() ? std::stoull(it->second) : SIZE_MAX;
+            request_data.body_left = request_data.body_size;
+            request_data.body_ptr = (char *) buff;
+            request_data.body_part = 0;
+            request_data.body_index = 0;
+
+            if (request_data.body_size > 0) {
+                const ssize_t read = mask_read((char *) buff, std::min(request_data.body_size, config->get_socket_block_size()));
+
+                if (read < 0) {
+                    THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "Could not read the body of the stream: {}", id);
                 }
 
-                handle_request(&handler);
+                request_data.body_part = read;
             }
-        } catch (const manapi::net::utils::exception &e) {
-            MANAPI_LOG("close connection: {}", e.what());
+        } else {
+            request_data.body_ptr = nullptr;
+            request_data.body_size = 0;
+            request_data.body_part = 0;
+            request_data.headers_part = 0;
         }
+
+        handle_request(&handler);
+    } catch (const manapi::net::utils::exception &e) {
+        MANAPI_LOG("close http2 stream {}: {}", id, e.what());
     }
 }
 
@@ -798,19 +1103,93 @@ void manapi::net::http_task::tcp_doit() {
 
 void manapi::net::http_task::handle_request(const http_handler_page *data, const size_t &status,
                                             const std::string &message) {
+    const auto started = std::chrono::steady_clock::now();
+
+    if (request_started == std::chrono::steady_clock::time_point {}) {
+        request_started = started;
+    }
+
+    // the rejected and the cached responses are also measured
+    utils::before_delete unwrap_metrics ([this, data, &started] () -> void {
+        auto &metrics = site->get_metrics();
+        auto latency = data->handler != nullptr && data->handler->latency != nullptr ? data->handler->latency : &metrics.unmatched;
+
+        metrics.requests.add();
+        latency->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count());
+    });
+
+    if (is_rate_limited(data)) {
+        return send_error_response(429, HTTP_STATUS.TOO_MANY_REQUESTS_429, data->error.get());
+    }
+
+    // the streams of the open connections are the new work, the connections are checked at accept
+    if (conn_type != CONN_TCP && config->get_admission_target() > 0 && site->get_tasks_pool()->is_overloaded(2)) {
+        return send_error_response(503, HTTP_STATUS.SERVICE_UNAVAILABLE_503, data->error.get());
+    }
+
+    http_response_cache *cache = data->handler != nullptr ? data->handler->cache.get() : nullptr;
+
+    if (cache != nullptr) {
+        // the same choice as http_response::get_compress ()
+        std::string encoding;
+
+        if (const auto it = request_data.headers.find(HTTP_HEADER.ACCEPT_ENCODING); it != request_data.headers.end()) {
+            for (const auto &value: utils::parse_header_value(it->second)) {
+                if (config->contains_compressor(value.value)) {
+                    encoding = value.value;
+                    break;
+                }
+            }
+        }
+
+        cache_key = cache->key(request_data, encoding);
+
+        std::shared_ptr<const http_cache_entry_t> entry;
+
+        switch (cache->acquire(cache_key, entry)) {
+            case CACHE_HIT:
+                // without the layers and the handler
+                try {
+                    send_cached_response(*entry);
+                } catch (const std::exception &e) {
+                    MANAPI_LOG("Unexpected error: {}", e.what());
+                }
+
+                return;
+            case CACHE_LEAD:
+                cache_lead = cache;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // the response was not cached (the error, the propagation was stopped, etc)
+    utils::before_delete unwrap_cache ([this] () -> void {
+        if (cache_lead != nullptr) {
+            cache_lead->abandon(cache_key);
+            cache_lead = nullptr;
+        }
+    });
+
     http_request req(socket_information, request_data, this, config, data);
     http_response res(request_data, status, message, std::make_unique<api::pool> (site->get_tasks_pool().get()), config);
     try {
+        MANAPI_TRACE_BEGIN(spans, TRACE_LAYERS);
+
         // handle layers
         for (const auto &layer: data->layer) {
             layer->handler(req, res);
 
             if (!req.get_propagation()) {
+                MANAPI_TRACE_END(spans, TRACE_LAYERS);
                 // skip other layers and handlers
                 goto finish;
             }
         }
 
+        MANAPI_TRACE_END(spans, TRACE_LAYERS);
+
         // handler function not be found
         if (data->handler == nullptr) {
             // check exists static folder/file
@@ -843,7 +1222,9 @@ void manapi::net::http_task::handle_request(const http_handler_page *data, const
 
             return send_error_response(404, HTTP_STATUS.NOT_FOUND_404, data->error.get());
         }
+        MANAPI_TRACE_BEGIN(spans, TRACE_HANDLER);
         execute_custom_handler(data, req, res);
+        MANAPI_TRACE_END(spans, TRACE_HANDLER);
 
     finish:
         send_response(res);
@@ -859,6 +1240,130 @@ void manapi::net::http_task::handle_request(const http_handler_page *data, const
     }
 }
 
+bool manapi::net::http_task::is_rate_limited(const http_handler_page *data) const {
+    // the HTTP/1 connection is charged once at accept
+    const bool streams = limiter != nullptr && conn_type != CONN_TCP;
+    const bool route = data->handler != nullptr && data->handler->limiter != nullptr;
+
+    if (!streams && !route) {
+        return false;
+    }
+
+    rate_limiter::key_t key;
+
+    if (!rate_limiter::make_key(socket_information.ip, key)) {
+        return false;
+    }
+
+    return (streams && !limiter->allow(key)) || (route && !data->handler->limiter->allow(key));
+}
+
+void manapi::net::http_task::send_cached_response(const http_cache_entry_t &entry) {
+    http_response res(request_data, entry.status, entry.message, std::make_unique<api::pool> (site->get_tasks_pool().get()), config);
+
+    for (const auto &header: entry.headers) {
+        res.set_header(header.first, header.second);
+    }
+
+    // already compressed
+    res.text(entry.body);
+
+    send_response(res);
+}
+
+void manapi::net::http_task::log_access(http_response &res) {
+    if (access == nullptr || !access->sampled()) {
+        return;
+    }
+
+    try {
+        const auto &headers = res.get_headers();
+
+        size_t bytes = 0;
+        std::string_view compress;
+
+        if (const auto it = headers.find(HTTP_HEADER.CONTENT_LENGTH); it != headers.end()) {
+            bytes = std::strtoull(it->second.data(), nullptr, 10);
+        }
+
+        if (const auto it = headers.find(HTTP_HEADER.CONTENT_ENCODING); it != headers.end()) {
+            compress = it->second;
+        }
+
+        std::string_view protocol = request_data.http;
+
+        if (protocol.empty()) {
+            protocol = conn_type == CONN_UDP ? "HTTP/3" : conn_type == CONN_H2 ? "HTTP/2" : "HTTP/1.1";
+        }
+
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - request_started);
+
+        access->append({
+            .time       = std::chrono::system_clock::now() - duration,
+            .duration   = duration,
+            .ip         = socket_information.ip,
+            .port       = socket_information.port,
+            .method     = request_data.method,
+            .uri        = request_data.uri,
+            .protocol   = protocol,
+            .compress   = compress,
+            .status     = res.get_status_code(),
+            .bytes      = bytes
+        });
+    } catch (const std::exception &e) {
+        MANAPI_LOG("access log: {}", e.what());
+    }
+}
+
+#ifdef MANAPI_HTTP_TRACING
+void manapi::net::http_task::trace_response_head(http_response &res) {
+    if (request_tracer != nullptr && request_tracer->get_config().server_timing) {
+        res.set_header(HTTP_HEADER.SERVER_TIMING, spans.server_timing());
+    }
+
+    MANAPI_TRACE_BEGIN(spans, TRACE_SEND);
+}
+
+void manapi::net::http_task::trace_finish(http_response &res) {
+    MANAPI_TRACE_END(spans, TRACE_SEND);
+
+    if (request_tracer == nullptr || !request_tracer->sampled()) {
+        return;
+    }
+
+    try {
+        request_tracer->append(spans, request_data.method, request_data.uri, res.get_status_code());
+    } catch (const std::exception &e) {
+        MANAPI_LOG("trace: {}", e.what());
+    }
+}
+#endif
+
+void manapi::net::http_task::cache_response(http_response &res, const std::string &body) {
+    if (cache_lead == nullptr) {
+        return;
+    }
+
+    if (res.get_status_code() != 200 || res.has_header(HTTP_HEADER.SET_COOKIE)) {
+        // the personal or failed responses
+        return;
+    }
+
+    http_cache_entry_t entry;
+
+    entry.status    = res.get_status_code();
+    entry.message   = res.get_status_message();
+    entry.headers   = res.get_headers();
+    entry.body      = body;
+
+    entry.headers.erase(HTTP_HEADER.DATE);
+    entry.headers.erase(HTTP_HEADER.CONNECTION);
+    entry.headers.erase(HTTP_HEADER.CONTENT_LENGTH);
+
+    cache_lead->store(cache_key, std::move(entry));
+    cache_lead = nullptr;
+}
+
 void manapi::net::http_task::execute_custom_handler(const http_handler_page *handler, http_request &req,
                                                     http_response &resp) {
     handler->handler->handler(req, resp);
@@ -908,6 +1413,13 @@ std::string manapi::net::http_task::compress_file(const std::string &file, const
 }
 
 void manapi::net::http_task::send_response(manapi::net::http_response &res) {
+    // the status and the headers are final after the send
+    utils::before_delete unwrap_access_log ([this, &res] () -> void { log_access(res); });
+
+#ifdef MANAPI_HTTP_TRACING
+    utils::before_delete unwrap_trace ([this, &res] () -> void { trace_finish(res); });
+#endif
+
     std::string response;
     std::string compressed;
 
@@ -917,7 +1429,8 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
     auto &body = res.get_body();
 
 
-    if (!compress.empty()) {
+    // the stream is not compressed
+    if (!compress.empty() && !res.is_stream()) {
         if (!res.is_file() ||
             !res.get_partial_enabled() ||
             manapi::net::filesystem::get_size(res.get_file()) < config->get_partial_data_min_size()
@@ -936,8 +1449,8 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
     // set time
     res.set_header(HTTP_HEADER.DATE, manapi::net::utils::time("%a, %d %b %Y %H:%M:%S GMT", false));
 
-    if (config->get_http_version() < versions::HTTP_v2) {
-        // if HTTP/0.9, HTTP/1.0 or HTTP/1.1
+    if (conn_type == CONN_TCP) {
+        // if HTTP/0.9, HTTP/1.0 or HTTP/1.1 (also the ALPN fallback from h2)
         res.set_header(HTTP_HEADER.CONNECTION, "close");
     }
 
@@ -949,7 +1462,9 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
                 THROW_MANAPI_EXCEPTION2(ERR_HTTP_SETTINGS_INCOMPATIBILITY, "replacers can not be use with compressing");
             }
 
+            MANAPI_TRACE_BEGIN(spans, TRACE_COMPRESS);
             filepath = compress_file(res.get_file(), site->config_cache_dir, compress, compressor);
+            MANAPI_TRACE_END(spans, TRACE_COMPRESS);
         } else {
             filepath = res.get_file();
         }
@@ -1032,6 +1547,8 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
                                        "bytes " + std::to_string(start) + '-' + std::to_string(back) + '/' +
                                        std::to_string(fileSize));
 
+                        MANAPI_TASK_HTTP_TRACE_HEAD(res);
+
                         if (mask_response(res) >= 0) {
                             if (buff_type == MANAPI_HTTP_BUFF_FILE) {
                                 mask_write_file(filepath, start, size);
@@ -1052,6 +1569,8 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
             } else {
                 res.set_header(HTTP_HEADER.CONTENT_LENGTH, std::to_string(dynamicFileSize));
 
+                MANAPI_TASK_HTTP_TRACE_HEAD(res);
+
                 if (mask_response(res) >= 0) {
                     if (replacers.empty()) {
                         // without replacers
@@ -1078,7 +1597,12 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
 
         if (compressor != nullptr) {
             // encode content !
+            MANAPI_TRACE_BEGIN(spans, TRACE_COMPRESS);
             plaintext = new std::string(compressor(body, nullptr));
+            MANAPI_TRACE_END(spans, TRACE_COMPRESS);
+
+            site->get_metrics().compress_in.add(body.size());
+            site->get_metrics().compress_out.add(plaintext->size());
         } else {
             // no need to clean up
             unwrap_plaintext.disable();
@@ -1090,12 +1614,55 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
             res.set_header(HTTP_HEADER.CONTENT_TYPE, "text/html; charset=UTF-8");
         }
 
+        cache_response(res, *plaintext);
+
+        // after the cache, the timings are of this request
+        MANAPI_TASK_HTTP_TRACE_HEAD(res);
+
         if (mask_response(res) >= 0) {
             send_text(*plaintext, plaintext->size());
         } else {
             MANAPI_LOG("{}", "mask_response(...) < 0");
         }
 
+        return;
+    } else if (res.is_stream()) {
+        // the size is unknown: chunked for HTTP/1.1, the frames for HTTP/2 and HTTP/3
+        const bool chunked = conn_type == CONN_TCP;
+
+        if (chunked) {
+            res.set_header(HTTP_HEADER.TRANSFER_ENCODING, "chunked");
+        }
+
+        MANAPI_TASK_HTTP_TRACE_HEAD(res);
+
+        if (mask_response(res) < 0) {
+            MANAPI_LOG("{}", "mask_response(...) < 0");
+            return;
+        }
+
+        // the status is sent, so the errors can not be the error responses
+        try {
+            // the framing of the chunks is in the buffer of the writer -> one write per block
+            json_writer writer ([this] (const char *data, const size_t &size) -> void {
+                send_block(data, size);
+            }, config->get_socket_block_size(), chunked);
+
+            res.get_stream()(writer);
+
+            // the containers are not closed -> the truncated document is not valid
+            if (!writer.is_complete()) {
+                THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "{}", "the json stream is not complete");
+            }
+
+            writer.finish();
+        }
+        catch (const std::exception &e) {
+            MANAPI_LOG("the json stream is aborted: {}", e.what());
+
+            abort_stream();
+        }
+
         return;
     } else if (res.is_proxy()) {
         auto proxy = std::make_unique<fetch>(res.get_data());
@@ -1108,6 +1675,7 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
                 res.set_header(HTTP_HEADER.CONTENT_LENGTH, headers.at(HTTP_HEADER.CONTENT_LENGTH));
             }
 
+            MANAPI_TASK_HTTP_TRACE_HEAD(res);
             mask_response(res);
         });
 
@@ -1126,11 +1694,16 @@ void manapi::net::http_task::send_response(manapi::net::http_response &res) {
         return;
     }
 
+    MANAPI_TASK_HTTP_TRACE_HEAD(res);
     mask_response(res);
 }
 
 void manapi::net::http_task::send_text(const std::string &text, const size_t &size) const {
-    const char *current = text.data();
+    send_block(text.data(), size);
+}
+
+void manapi::net::http_task::send_block(const char *data, const size_t &size) const {
+    const char *current = data;
     size_t sent = size;
 
     while (sent != 0) {
@@ -1152,6 +1725,22 @@ void manapi::net::http_task::send_text(const std::string &text, const size_t &si
     }
 }
 
+void manapi::net::http_task::abort_stream() {
+    switch (conn_type) {
+        case CONN_TCP:
+            // the client gets the body without the last chunk
+            shutdown(conn_fd, SHUT_RDWR);
+            break;
+        case CONN_H2:
+            h2_conn->stream_reset(static_cast<uint32_t>(stream_id), http2::errors::INTERNAL_ERROR);
+            break;
+        default:
+            // H3_INTERNAL_ERROR
+            quiche_conn_stream_shutdown(conn_io->conn, stream_id, QUICHE_SHUTDOWN_WRITE, 0x102);
+            stream_aborted = true;
+    }
+}
+
 void manapi::net::http_task::send_file(manapi::net::http_response &res, std::ifstream &f, ssize_t size) const {
     auto block_size = static_cast<ssize_t>(config->get_socket_block_size());
     char block[block_size];
@@ -1378,28 +1967,174 @@ void manapi::net::http_task::send_error_response(const size_t &status, const std
 
 // MASKS
 
-ssize_t manapi::net::http_task::socket_read(char *part_buff, const size_t &part_buff_size) const {
+ssize_t manapi::net::http_task::socket_read(char *part_buff, const size_t &part_buff_size) {
+    if (!head_data.empty()) {
+        return static_cast<ssize_t>(tcp_read_head_data(part_buff, part_buff_size));
+    }
+
     if (!socket_wait_select()) {
         return -1;
     }
 
-    return read(conn_fd, part_buff, part_buff_size);
+    const ssize_t read = ::read(conn_fd, part_buff, part_buff_size);
+
+    if (read > 0) {
+        site->get_metrics().bytes_in.add(read);
+    }
+
+    return read;
 }
 
 ssize_t manapi::net::http_task::socket_write(const char *part_buff, const size_t &part_buff_size) const {
-    return send(conn_fd, part_buff, part_buff_size, MSG_NOSIGNAL);
+    while (true) {
+        const ssize_t sent = send(conn_fd, part_buff, part_buff_size, MSG_NOSIGNAL);
+
+        // the socket is non-blocking
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!socket_wait_write()) {
+                return -1;
+            }
+
+            continue;
+        }
+
+        if (sent > 0) {
+            site->get_metrics().bytes_out.add(sent);
+        }
+
+        return sent;
+    }
 }
 
-ssize_t manapi::net::http_task::openssl_read(char *part_buff, const size_t &part_buff_size) const {
-    return SSL_read(ssl, part_buff, reinterpret_cast<const int &>(part_buff_size));
+ssize_t manapi::net::http_task::openssl_read(char *part_buff, const size_t &part_buff_size) {
+    if (!head_data.empty()) {
+        return static_cast<ssize_t>(tcp_read_head_data(part_buff, part_buff_size));
+    }
+
+    while (true) {
+        const int read = SSL_read(ssl, part_buff, reinterpret_cast<const int &>(part_buff_size));
+
+        if (read > 0) {
+            site->get_metrics().bytes_in.add(read);
+            return read;
+        }
+
+        switch (SSL_get_error(ssl, read)) {
+            case SSL_ERROR_WANT_READ:
+                if (!socket_wait_select()) {
+                    return -1;
+                }
+                break;
+            case SSL_ERROR_WANT_WRITE:
+                if (!socket_wait_write()) {
+                    return -1;
+                }
+                break;
+            default:
+                return read;
+        }
+    }
 }
 
 ssize_t manapi::net::http_task::openssl_write(const char *part_buff, const size_t &part_buff_size) const {
-    return SSL_write(ssl, part_buff, reinterpret_cast<const int &>(part_buff_size));
+    while (true) {
+        const int sent = SSL_write(ssl, part_buff, reinterpret_cast<const int &>(part_buff_size));
+
+        if (sent > 0) {
+            site->get_metrics().bytes_out.add(sent);
+            return sent;
+        }
+
+        switch (SSL_get_error(ssl, sent)) {
+            case SSL_ERROR_WANT_READ:
+                if (!socket_wait_select()) {
+                    return -1;
+                }
+                break;
+            case SSL_ERROR_WANT_WRITE:
+                if (!socket_wait_write()) {
+                    return -1;
+                }
+                break;
+            default:
+                return sent;
+        }
+    }
 }
 
 // TCP
 
+int manapi::net::http_task::tcp_read_early_data() {
+    const size_t max_size = config->get_ssl_config().early_data;
+    // the socket block is free until the request head is parsed
+    const auto block = static_cast<char *>(buff);
+
+    while (true) {
+        size_t read = 0;
+        const int status = SSL_read_early_data(ssl, block, config->get_socket_block_size(), &read);
+
+        if (status == SSL_READ_EARLY_DATA_ERROR) {
+            return tcp_ssl_status(status);
+        }
+
+        if (early_data.size() + read > max_size) {
+            MANAPI_LOG("early data is too large: {}", early_data.size() + read);
+            return TCP_PREPARE_FAILED;
+        }
+
+        early_data.append(block, read);
+        site->get_metrics().bytes_in.add(read);
+
+        if (status == SSL_READ_EARLY_DATA_FINISH) {
+            tcp_early_finished = true;
+
+            return TCP_PREPARE_DONE;
+        }
+    }
+}
+
+int manapi::net::http_task::tcp_ssl_status(const int &res) const {
+    switch (SSL_get_error(ssl, res)) {
+        case SSL_ERROR_WANT_READ:
+            return TCP_PREPARE_WANT_READ;
+        case SSL_ERROR_WANT_WRITE:
+            return TCP_PREPARE_WANT_WRITE;
+        case SSL_ERROR_WANT_ASYNC:
+            return TCP_PREPARE_WANT_ASYNC;
+        default:
+            return TCP_PREPARE_FAILED;
+    }
+}
+
+bool manapi::net::http_task::tcp_head_received(const size_t &offset) {
+    // h2c with prior knowledge, the preface contains the empty line too
+    if (ssl == nullptr && config->get_http_version() == versions::HTTP_v2 && head_data.starts_with("PRI ")) {
+        if (head_data.size() < MANAPI_HTTP2_PREFACE_LEN) {
+            return false;
+        }
+
+        tcp_h2 = http2::connection::is_preface(head_data.data(), head_data.size());
+
+        return true;
+    }
+
+    // the empty line can be split between the blocks
+    return head_data.find("\r\n\r\n", offset < 3 ? 0 : offset - 3) != std::string::npos;
+}
+
+size_t manapi::net::http_task::tcp_read_head_data(char *part_buff, const size_t &part_buff_size) {
+    const size_t size = std::min(part_buff_size, head_data.size());
+
+    memcpy(part_buff, head_data.data(), size);
+    head_data.erase(0, size);
+
+    return size;
+}
+
+bool manapi::net::http_task::is_safe_early_method(const std::string &method) {
+    return method == "GET" || method == "HEAD" || method == "OPTIONS";
+}
+
 void manapi::net::http_task::tcp_stringify_headers(std::string &response, manapi::net::http_response &res,
                                                    char *delimiter) {
     // add headers
@@ -1410,7 +2145,10 @@ void manapi::net::http_task::tcp_stringify_headers(std::string &response, manapi
 
 void manapi::net::http_task::tcp_stringify_http_info(std::string &response, manapi::net::http_response &res,
                                                      char *delimiter) const {
-    response += "HTTP/" + config->get_http_version_str() + ' ' + std::to_string(res.get_status_code())
+    // the TCP connection without h2 speaks HTTP/1.1
+    const std::string &version = config->get_http_version() >= versions::HTTP_v2 ? "1.1" : config->get_http_version_str();
+
+    response += "HTTP/" + version + ' ' + std::to_string(res.get_status_code())
             + ' ' + res.get_status_message() + delimiter;
 }
 
@@ -1434,7 +2172,7 @@ void manapi::net::http_task::tcp_parse_request_response(char *response, const si
     // URI
     // scip \n
     i++;
-    parse_uri_path_dynamic(request_data, (char *) response, size, i, [&maxsize, this, &size, &i]() {
+    parse_uri_path_dynamic(request_data, (char *) response, size, i, [&size, &i]() {
         MANAPI_TASK_HTTP_TCP_NEXT_BLOCK_IF_NEEDED(i);
     });
 
@@ -1581,7 +2319,7 @@ uint8_t *manapi::net::http_task::gen_cid(uint8_t *cid, const size_t &cid_len) {
 
 void manapi::net::http_task::quic_flush_egress(quic_map_conns_t *conns, manapi::net::http_quic_conn_io *conn_io,
                                                class site *site) {
-    uint8_t out[MANAPI_MAX_DATAGRAM_SIZE];
+    uint8_t *out = conn_io->out.get();
 
     quiche_send_info send_info;
 
@@ -1590,7 +2328,7 @@ void manapi::net::http_task::quic_flush_egress(quic_map_conns_t *conns, manapi::
             MANAPI_LOG("ERROR: {}", "conn_io->conn = nullptr");
         }
 
-        const ssize_t written = quiche_conn_send(conn_io->conn, out, sizeof(out), &send_info);
+        const ssize_t written = quiche_conn_send(conn_io->conn, out, conn_io->max_datagram_size, &send_info);
 
         if (written == QUICHE_ERR_DONE) {
             //std::cout << "done writing"<< conn_io->key << "\n";
@@ -1609,6 +2347,8 @@ void manapi::net::http_task::quic_flush_egress(quic_map_conns_t *conns, manapi::
             return;
         }
 
+        site->get_metrics().bytes_out.add(sent);
+
         //fprintf(stderr, "sent %zd bytes\n", sent);
     }
 
@@ -1703,6 +2443,9 @@ std::unique_ptr<manapi::net::http_quic_conn_io> &manapi::net::http_task::quic_cr
         conn_io->peer_addr = client;
         conn_io->peer_addr_len = client_len;
 
+        conn_io->max_datagram_size = config->get_quic_max_datagram_size();
+        conn_io->out = std::make_unique<uint8_t[]>(conn_io->max_datagram_size);
+
         conn_io->timer_id = 0;
 
         quic_map_conns->lock();
@@ -1745,7 +2488,9 @@ void manapi::net::http_task::quic_timeout_cb(std::string cid, quic_map_conns_t *
         quiche_conn_path_stats(p->conn, 0, &path_stats);
 
         MANAPI_LOG("(timer) connection closed: {}, recv={} sent={} lost={} rtt={} ns cwnd={}",
-                   p->key, stats.recv, stats.sent, stats.lost, path_stats.rtt, path_stats.cwnd); {
+                   p->key, stats.recv, stats.sent, stats.lost, path_stats.rtt, path_stats.cwnd);
+
+        quic_closed_metrics(site, stats, path_stats); {
             quic_delete_conn_io(p, site);
 
             auto unwrap_map = conns->lock_guard();
@@ -1851,6 +2596,16 @@ void manapi::net::http_task::parse_uri_path_dynamic(request_data_t &request_data
     }
 }
 
+void manapi::net::http_task::quic_closed_metrics(class site *site, const quiche_stats &stats, const quiche_path_stats &path_stats) {
+    auto &metrics = site->get_metrics();
+
+    metrics.closed.add();
+    metrics.quic_recv.add(stats.recv);
+    metrics.quic_sent.add(stats.sent);
+    metrics.quic_lost.add(stats.lost);
+    metrics.quic_rtt.record(path_stats.rtt / 1000);
+}
+
 void manapi::net::http_task::quic_delete_conn_io(manapi::net::http_quic_conn_io *conn_io, class site *site) { {
         if (conn_io->is_responsing) {
             MANAPI_LOG2("conn_io->is_responsing = true");
@@ -25,6 +25,7 @@ namespace manapi::net {
         }
 
         task_queues.resize(queues_count);
+        levels = std::make_unique<level_state_t[]>(queues_count);
     }
 
     template<class T>
@@ -44,10 +45,22 @@ namespace manapi::net {
 
     template<class T>
     void threadpool<T>::stop() {
-        is_stop = true;
+        {
+            // the worker checks it before the wait
+            std::lock_guard<std::mutex> lk (m);
+            is_stop = true;
+        }
+
         cv.notify_all();
     }
 
+    template<class T>
+    void threadpool<T>::wait_stopped() {
+        std::unique_lock<std::mutex> lk (m);
+
+        cv_stopped.wait(lk, [this] () -> bool { return stopped >= thread_number; });
+    }
+
     template<class T>
     void threadpool<T>::start() {
         for (size_t i = all_threads.size(); i < thread_number; i++) { all_threads.emplace_back(worker, this); all_threads[i].detach(); }
@@ -68,13 +81,28 @@ namespace manapi::net {
         {
             queue_mutex.unlock();
 
-            std::thread t ([this, &task] () -> void { task_doit(std::move(task)); });
+            // the own thread, the task is moved into it
+            std::thread t ([this, task = std::move(task)] () mutable -> void { task_doit(std::move(task)); });
             t.detach();
         }
         else
         {
+            const auto now = std::chrono::steady_clock::now();
+
             // add into the queue
-            task_queues[level].push_front (std::move(task));
+            task_queues[level].push_front ({std::move(task), now});
+            levels[level].size.store(task_queues[level].size(), std::memory_order_relaxed);
+
+            // all the workers can be blocked, then nothing is dequeued and getTask () does not see the standing queue
+            if (const auto target = admission_target.load(std::memory_order_relaxed); target > 0)
+            {
+                const auto oldest = task_queues[level].back().queued;
+
+                if (now - oldest >= std::chrono::nanoseconds(target + admission_interval.load(std::memory_order_relaxed)))
+                {
+                    levels[level].overloaded.store(true, std::memory_order_relaxed);
+                }
+            }
 
             queue_mutex.unlock();
 
@@ -91,19 +119,101 @@ namespace manapi::net {
         std::unique_ptr<T> task = nullptr;
         std::lock_guard<std::mutex> lk (queue_mutex);
         // from n ... 0 by level
-        for (auto task_queue = task_queues.rbegin(); task_queue != task_queues.rend(); task_queue++)
+        for (size_t level = task_queues.size(); level-- > 0;)
         {
-            if (!task_queue->empty())
+            auto &task_queue = task_queues[level];
+
+            if (!task_queue.empty())
             {
-                task = std::move(task_queue->back());
-                task_queue->pop_back();
+                auto queued = std::move(task_queue.back());
+                task_queue.pop_back();
+
+                levels[level].size.store(task_queue.size(), std::memory_order_relaxed);
+
+                update_admission(levels[level], queued.queued, task_queue.empty());
+
+                task = std::move(queued.task);
                 break;
             }
         }
 
+        if (task == nullptr)
+        {
+            // idle -> no standing queue
+            for (size_t level = 0; level < task_queues.size(); level++)
+            {
+                levels[level].first_above = {};
+                levels[level].overloaded.store(false, std::memory_order_relaxed);
+            }
+        }
+
         return std::move(task);
     }
 
+    template<class T>
+    void threadpool<T>::update_admission(level_state_t &state, const std::chrono::steady_clock::time_point &queued, const bool &empty) {
+        const auto now = std::chrono::steady_clock::now();
+        const auto sojourn = std::chrono::duration_cast<std::chrono::nanoseconds>(now - queued).count();
+
+        state.sojourn.store(sojourn, std::memory_order_relaxed);
+
+        const auto target = admission_target.load(std::memory_order_relaxed);
+
+        if (target == 0)
+        {
+            return;
+        }
+
+        if (sojourn < target || empty)
+        {
+            // the queue is drained, the burst is over
+            state.first_above = {};
+            state.overloaded.store(false, std::memory_order_relaxed);
+
+            return;
+        }
+
+        if (state.first_above == std::chrono::steady_clock::time_point {})
+        {
+            state.first_above = now + std::chrono::nanoseconds(admission_interval.load(std::memory_order_relaxed));
+        }
+        else if (now >= state.first_above)
+        {
+            state.overloaded.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    template<class T>
+    void threadpool<T>::set_admission(const std::chrono::milliseconds &target, const std::chrono::milliseconds &interval) {
+        admission_target.store(std::chrono::duration_cast<std::chrono::nanoseconds>(target).count(), std::memory_order_relaxed);
+        admission_interval.store(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count(), std::memory_order_relaxed);
+    }
+
+    template<class T>
+    bool threadpool<T>::is_overloaded(const size_t &level) const {
+        return level < task_queues.size() && levels[level].overloaded.load(std::memory_order_relaxed);
+    }
+
+    template<class T>
+    std::chrono::nanoseconds threadpool<T>::get_sojourn(const size_t &level) const {
+        if (level >= task_queues.size())
+        {
+            return std::chrono::nanoseconds(0);
+        }
+
+        return std::chrono::nanoseconds(levels[level].sojourn.load(std::memory_order_relaxed));
+    }
+
+    template<class T>
+    size_t threadpool<T>::get_queue_size(const size_t &level) const {
+        return level < task_queues.size() ? levels[level].size.load(std::memory_order_relaxed) : 0;
+    }
+
+    template<class T>
+    size_t threadpool<T>::get_queues_count() const {
+        return task_queues.size();
+    }
+
     template<class T>
     void *threadpool<T>::worker(void *arg) {
         auto *pool = static_cast<threadpool *> (arg);
@@ -118,7 +228,11 @@ namespace manapi::net {
             if (task == nullptr)
             {
                 std::unique_lock<std::mutex> lk (m);
-                cv.wait(lk);
+
+                if (!is_stop)
+                {
+                    cv.wait(lk);
+                }
             }
             else
             {
@@ -126,7 +240,11 @@ namespace manapi::net {
             }
         }
 
+        // under the mutex, the pool can be deleted right after the wait
+        std::lock_guard<std::mutex> lk (m);
+
         stopped++;
+        cv_stopped.notify_all();
     }
 
     template<class T>
@@ -5,9 +5,10 @@
 #include "ManapiUtils.hpp"
 #include "ManapiTaskFunction.hpp"
 
-manapi::net::utils::timerpool::timerpool(net::threadpool<net::task> &threadpool, const size_t &delay) {
+manapi::net::utils::timerpool::timerpool(net::threadpool<net::task> &threadpool, const size_t &delay, metrics::histogram *lag) {
     this->delay = delay;
     this->threadpool = &threadpool;
+    this->lag = lag;
 }
 
 manapi::net::utils::timerpool::~timerpool() {
@@ -40,7 +41,15 @@ void manapi::net::utils::timerpool::start() {
             for (auto task = tasks.begin(); task != tasks.end();) {
                 if (now >= task->second.point) {
                     const auto func = task->second.task;
-                    try { threadpool->append_task(std::make_unique<net::function_task>([func] () -> void { func (); })); }
+                    const auto point = task->second.point;
+                    const auto lag = this->lag;
+                    try {
+                        threadpool->append_task(std::make_unique<net::function_task>([func, point, lag] () -> void {
+                            // the sleep of the loop and the queue of the threadpool
+                            if (lag != nullptr) { lag->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - point).count()); }
+                            func ();
+                        }));
+                    }
                     catch (std::exception const &e) { MANAPI_LOG("Timer Task Exception: {}", e.what()); }
                     now = std::chrono::high_resolution_clock::now();
                     task = tasks.erase(task);
@@ -0,0 +1,367 @@
+#include <ctime>
+#include <cstring>
+#include <fstream>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/ocsp.h>
+#include <openssl/x509v3.h>
+#include <openssl/core_names.h>
+
+#include "ManapiTls.hpp"
+#include "ManapiFetch.hpp"
+#include "ManapiUtils.hpp"
+#include "ManapiTaskFunction.hpp"
+
+// OCSP_check_validity: the allowed clock skew in seconds
+#define MANAPI_OCSP_VALIDITY_PERIOD 300
+#define MANAPI_OCSP_RESPONDER_TIMEOUT 10
+
+// ======================[ ticket keys ]==========================
+
+manapi::net::tls::ticket_keys &manapi::net::tls::ticket_keys::shared() {
+    static ticket_keys keys;
+
+    return keys;
+}
+
+manapi::net::tls::ticket_keys::ticket_keys() {
+    generate();
+}
+
+void manapi::net::tls::ticket_keys::rotate(const std::chrono::seconds &interval, const size_t &max_keys) {
+    std::unique_lock<std::shared_mutex> lk (mutex);
+
+    // all pools call rotate(...), only the first one in the interval generates the key
+    if (std::chrono::steady_clock::now() - created >= interval) {
+        generate();
+    }
+
+    while (keys.size() > std::max<size_t>(max_keys, 1)) {
+        OPENSSL_cleanse(&keys.back(), sizeof (key_t));
+        keys.pop_back();
+    }
+}
+
+void manapi::net::tls::ticket_keys::generate() {
+    key_t key{};
+
+    if (RAND_bytes(key.name, sizeof (key.name)) <= 0 || RAND_bytes(key.aes_key, sizeof (key.aes_key)) <= 0 || RAND_bytes(key.hmac_key, sizeof (key.hmac_key)) <= 0) {
+        THROW_MANAPI_EXCEPTION2(ERR_EXTERNAL_LIB_CRASH, "cannot generate the session ticket key: RAND_bytes(...) <= 0");
+    }
+
+    keys.push_front(key);
+    created = std::chrono::steady_clock::now();
+}
+
+int manapi::net::tls::ticket_keys::callback(SSL *ssl, unsigned char *key_name, unsigned char *iv, EVP_CIPHER_CTX *ctx, EVP_MAC_CTX *hctx, int enc) {
+    auto &self = shared();
+
+    std::shared_lock<std::shared_mutex> lk (self.mutex);
+
+    const key_t *key = nullptr;
+
+    if (enc) {
+        key = &self.keys.front();
+
+        if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(EVP_aes_256_cbc())) <= 0) {
+            return -1;
+        }
+
+        memcpy(key_name, key->name, MANAPI_TLS_TICKET_KEY_NAME_LEN);
+    }
+    else {
+        for (const auto &k: self.keys) {
+            if (memcmp(k.name, key_name, MANAPI_TLS_TICKET_KEY_NAME_LEN) == 0) {
+                key = &k;
+                break;
+            }
+        }
+
+        if (key == nullptr) {
+            // the key has been rotated out -> full handshake
+            return 0;
+        }
+    }
+
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<unsigned char *>(key->hmac_key), sizeof (key->hmac_key)),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char *>("SHA256"), 0),
+        OSSL_PARAM_construct_end()
+    };
+
+    if (!EVP_MAC_CTX_set_params(hctx, params)) {
+        return -1;
+    }
+
+    if (enc) {
+        return EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key->aes_key, iv) ? 1 : -1;
+    }
+
+    if (!EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key->aes_key, iv)) {
+        return -1;
+    }
+
+    // the ticket encrypted by the old key is renewed
+    return key == &self.keys.front() ? 1 : 2;
+}
+
+// ======================[ ocsp stapler ]==========================
+
+manapi::net::tls::ocsp_stapler::ocsp_stapler(const ocsp_config_t &config) {
+    this->config = config;
+}
+
+manapi::net::tls::ocsp_stapler::~ocsp_stapler() {
+    X509_free(cert);
+    X509_free(issuer);
+}
+
+void manapi::net::tls::ocsp_stapler::attach(SSL_CTX *ctx) {
+    cert = SSL_CTX_get0_certificate(ctx);
+
+    if (cert == nullptr) {
+        THROW_MANAPI_EXCEPTION2(ERR_CONFIG_ERROR, "ocsp stapling requires the certificate");
+    }
+
+    X509_up_ref(cert);
+
+    // the issuer must be in the chain file
+    STACK_OF(X509) *chain = nullptr;
+    SSL_CTX_get0_chain_certs(ctx, &chain);
+
+    for (int i = 0; chain != nullptr && i < sk_X509_num(chain); i++) {
+        X509 *candidate = sk_X509_value(chain, i);
+
+        if (X509_check_issued(candidate, cert) == X509_V_OK) {
+            X509_up_ref(candidate);
+            issuer = candidate;
+            break;
+        }
+    }
+
+    STACK_OF(OPENSSL_STRING) *urls = X509_get1_ocsp(cert);
+
+    if (urls != nullptr && sk_OPENSSL_STRING_num(urls) > 0) {
+        url = sk_OPENSSL_STRING_value(urls, 0);
+    }
+
+    X509_email_free(urls);
+
+    if (config.file.empty() && (issuer == nullptr || url.empty())) {
+        MANAPI_LOG("{}", "ocsp stapling is disabled: the issuer is not in the chain or the certificate has no responder");
+        return;
+    }
+
+    SSL_CTX_set_tlsext_status_cb(ctx, callback);
+    SSL_CTX_set_tlsext_status_arg(ctx, this);
+}
+
+void manapi::net::tls::ocsp_stapler::refresh() {
+    std::string der;
+
+    try {
+        if (!config.file.empty()) {
+            std::ifstream f (config.file, std::ios::binary | std::ios::in);
+
+            if (!f.is_open()) {
+                THROW_MANAPI_EXCEPTION(ERR_FILE_IO, "Could not open the file by the following path: {}", config.file);
+            }
+
+            der.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        }
+        else {
+            if (issuer == nullptr || url.empty()) {
+                return;
+            }
+
+            OCSP_REQUEST *req = OCSP_REQUEST_new();
+            utils::before_delete bd_req ([&req] () -> void { OCSP_REQUEST_free(req); });
+
+            OCSP_CERTID *id = req == nullptr ? nullptr : OCSP_cert_to_id(nullptr, cert, issuer);
+
+            // the request owns the id only after OCSP_request_add0_id(...)
+            if (id == nullptr || OCSP_request_add0_id(req, id) == nullptr) {
+                OCSP_CERTID_free(id);
+
+                THROW_MANAPI_EXCEPTION2(ERR_EXTERNAL_LIB_CRASH, "cannot create the ocsp request");
+            }
+
+            std::string request (i2d_OCSP_REQUEST(req, nullptr), '\0');
+            auto p = reinterpret_cast<unsigned char *>(request.data());
+            i2d_OCSP_REQUEST(req, &p);
+
+            der = request_responder(request);
+        }
+    }
+    catch (const manapi::net::utils::exception &e) {
+        MANAPI_LOG("ocsp refresh failed, the old response is kept: {}", e.what());
+        return;
+    }
+
+    // validate the response before stapling
+    auto p = reinterpret_cast<const unsigned char *>(der.data());
+    OCSP_RESPONSE *resp = d2i_OCSP_RESPONSE(nullptr, &p, static_cast<long>(der.size()));
+    utils::before_delete bd_resp ([&resp] () -> void { OCSP_RESPONSE_free(resp); });
+
+    if (resp == nullptr || OCSP_response_status(resp) != OCSP_RESPONSE_STATUS_SUCCESSFUL) {
+        MANAPI_LOG("{}", "ocsp refresh failed: the response is not successful");
+        return;
+    }
+
+    OCSP_BASICRESP *basic = OCSP_response_get1_basic(resp);
+    utils::before_delete bd_basic ([&basic] () -> void { OCSP_BASICRESP_free(basic); });
+
+    if (basic == nullptr) {
+        MANAPI_LOG("{}", "ocsp refresh failed: no basic response");
+        return;
+    }
+
+    int status = V_OCSP_CERTSTATUS_UNKNOWN, reason;
+    ASN1_GENERALIZEDTIME *revtime, *this_update = nullptr, *next = nullptr;
+
+    if (issuer != nullptr) {
+        // the responder is trusted only if it is the issuer or delegated by the issuer
+        X509_STORE *store = X509_STORE_new();
+        STACK_OF(X509) *certs = sk_X509_new_null();
+        utils::before_delete bd_store ([&store, &certs] () -> void { X509_STORE_free(store); sk_X509_free(certs); });
+
+        X509_STORE_add_cert(store, issuer);
+        X509_STORE_set_flags(store, X509_V_FLAG_PARTIAL_CHAIN);
+        sk_X509_push(certs, issuer);
+
+        if (OCSP_basic_verify(basic, certs, store, 0) <= 0) {
+            MANAPI_LOG("{}", "ocsp refresh failed: the response signature is invalid");
+            return;
+        }
+
+        OCSP_CERTID *id = OCSP_cert_to_id(nullptr, cert, issuer);
+        const int found = OCSP_resp_find_status(basic, id, &status, &reason, &revtime, &this_update, &next);
+        OCSP_CERTID_free(id);
+
+        if (!found) {
+            MANAPI_LOG("{}", "ocsp refresh failed: the response is not for the certificate");
+            return;
+        }
+    }
+    else if (OCSP_resp_count(basic) > 0) {
+        status = OCSP_single_get0_status(OCSP_resp_get0(basic, 0), &reason, &revtime, &this_update, &next);
+    }
+
+    if (this_update == nullptr || !OCSP_check_validity(this_update, next, MANAPI_OCSP_VALIDITY_PERIOD, -1)) {
+        MANAPI_LOG("{}", "ocsp refresh failed: the response is expired");
+        return;
+    }
+
+    if (status != V_OCSP_CERTSTATUS_GOOD) {
+        MANAPI_LOG("ocsp: the certificate status is {}", OCSP_cert_status_str(status));
+    }
+
+    auto expires = std::chrono::system_clock::now() + std::chrono::seconds(config.refresh * 2);
+
+    if (next != nullptr) {
+        tm next_tm{};
+
+        if (ASN1_TIME_to_tm(next, &next_tm)) {
+            expires = std::chrono::system_clock::from_time_t(timegm(&next_tm));
+        }
+    }
+
+    std::lock_guard<std::mutex> lk (mutex);
+
+    response = std::move(der);
+    next_update = expires;
+}
+
+int manapi::net::tls::ocsp_stapler::callback(SSL *ssl, void *arg) {
+    auto self = static_cast<ocsp_stapler *>(arg);
+
+    std::lock_guard<std::mutex> lk (self->mutex);
+
+    if (self->response.empty() || std::chrono::system_clock::now() >= self->next_update) {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+
+    // OpenSSL takes the ownership of the buffer
+    auto data = static_cast<unsigned char *>(OPENSSL_memdup(self->response.data(), self->response.size()));
+
+    if (data == nullptr) {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+
+    SSL_set_tlsext_status_ocsp_resp(ssl, data, static_cast<long>(self->response.size()));
+
+    return SSL_TLSEXT_ERR_OK;
+}
+
+std::string manapi::net::tls::ocsp_stapler::request_responder(const std::string &request) const {
+    fetch responder (url);
+
+    responder.set_method("POST");
+    responder.set_body(request);
+    responder.set_headers({{"content-type", "application/ocsp-request"}});
+    responder.set_custom_setup([] (CURL *curl) -> void { curl_easy_setopt(curl, CURLOPT_TIMEOUT, MANAPI_OCSP_RESPONDER_TIMEOUT); });
+
+    std::string result = responder.text();
+
+    if (responder.get_status_code() != 200) {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "the ocsp responder {} returned {}", url, responder.get_status_code());
+    }
+
+    return result;
+}
+
+// ======================[ crypto pool ]==========================
+
+manapi::net::tls::crypto_pool::crypto_pool(const size_t &threads, const size_t &max_queued) {
+    this->max_queued = max_queued;
+
+    pool = std::make_unique<threadpool<task> >(threads, 1);
+    pool->start();
+}
+
+manapi::net::tls::crypto_pool::~crypto_pool() {
+    stop();
+}
+
+bool manapi::net::tls::crypto_pool::append(const std::function<void()> &job) {
+    const size_t current = ++queued;
+
+    if (current > max_queued) {
+        --queued;
+        ++rejected;
+
+        return false;
+    }
+
+    size_t max = max_seen;
+    while (current > max && !max_seen.compare_exchange_weak(max, current)) {}
+
+    const bool appended = pool->append_task(std::make_unique<function_task>([this, job] () -> void {
+        utils::before_delete bd_job ([this] () -> void { --queued; ++completed; });
+
+        job();
+    }));
+
+    if (!appended) {
+        --queued;
+        ++rejected;
+    }
+
+    return appended;
+}
+
+void manapi::net::tls::crypto_pool::stop() {
+    pool->stop();
+
+    // the jobs use the connections of the loop
+    pool->wait_stopped();
+}
+
+manapi::net::tls::crypto_stats_t manapi::net::tls::crypto_pool::get_stats() const {
+    return {
+        .queued     = queued,
+        .max_queued = max_seen,
+        .completed  = completed,
+        .rejected   = rejected
+    };
+}
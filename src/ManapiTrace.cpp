@@ -0,0 +1,230 @@
+#include <format>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ManapiTrace.hpp"
+#include "ManapiUtils.hpp"
+
+namespace manapi::net {
+    static void trace_escape (std::string &out, const std::string_view &value) {
+        for (const auto &c: value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+}
+
+manapi::net::trace_spans::trace_spans() {
+    created = now();
+}
+
+void manapi::net::trace_spans::begin(const trace_phase_t &phase) {
+    if (begins[phase] == 0)
+    {
+        begins[phase] = now();
+    }
+}
+
+void manapi::net::trace_spans::end(const trace_phase_t &phase) {
+    if (begins[phase] != 0)
+    {
+        ends[phase] = now();
+    }
+}
+
+int64_t manapi::net::trace_spans::get_created() const {
+    return created;
+}
+
+int64_t manapi::net::trace_spans::get_begin(const trace_phase_t &phase) const {
+    return ends[phase] != 0 ? begins[phase] : 0;
+}
+
+int64_t manapi::net::trace_spans::get_duration(const trace_phase_t &phase) const {
+    return ends[phase] != 0 ? ends[phase] - begins[phase] : 0;
+}
+
+std::string manapi::net::trace_spans::server_timing() const {
+    std::string result;
+
+    for (size_t i = 0; i < TRACE_PHASES_COUNT; i++)
+    {
+        const auto phase = static_cast<trace_phase_t>(i);
+
+        if (ends[phase] == 0)
+        {
+            continue;
+        }
+
+        // ms
+        result += std::format("{};dur={:.3f}, ", name(phase), static_cast<double>(get_duration(phase)) / 1e6);
+    }
+
+    result += std::format("total;dur={:.3f}", static_cast<double>(now() - created) / 1e6);
+
+    return result;
+}
+
+int64_t manapi::net::trace_spans::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *manapi::net::trace_spans::name(const trace_phase_t &phase) {
+    switch (phase)
+    {
+        case TRACE_HANDSHAKE:
+            return "handshake";
+        case TRACE_HEAD:
+            return "head";
+        case TRACE_QUEUE:
+            return "queue";
+        case TRACE_PARSE:
+            return "parse";
+        case TRACE_ROUTE:
+            return "route";
+        case TRACE_LAYERS:
+            return "layers";
+        case TRACE_HANDLER:
+            return "handler";
+        case TRACE_COMPRESS:
+            return "compress";
+        case TRACE_SEND:
+            return "send";
+        default:
+            return "unknown";
+    }
+}
+
+manapi::net::tracer::tracer(trace_config_t config) : config (std::move(config)) {
+    pid = getpid();
+
+    if (this->config.file.empty())
+    {
+        return;
+    }
+
+    fd = open(this->config.file.data(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0)
+    {
+        THROW_MANAPI_EXCEPTION(ERR_FILE_IO, "could not open the trace file: {}", this->config.file);
+    }
+
+    buffer = "[\n";
+}
+
+manapi::net::tracer::~tracer() {
+    stop();
+}
+
+bool manapi::net::tracer::sampled() const {
+    if (config.file.empty())
+    {
+        return false;
+    }
+
+    if (config.sample <= 1)
+    {
+        return true;
+    }
+
+    static thread_local size_t requests = 0;
+
+    return requests++ % config.sample == 0;
+}
+
+void manapi::net::tracer::append(const trace_spans &spans, const std::string_view &method, const std::string_view &uri, const size_t &status) {
+    const size_t id     = next_id.fetch_add(1, std::memory_order_relaxed);
+    const int64_t ended = trace_spans::now();
+
+    // the complete events (ph = X), the timestamps are microseconds
+    std::string events = R"({"name":")";
+    trace_escape(events, method);
+    events += ' ';
+    trace_escape(events, uri);
+    events += std::format(R"(","cat":"request","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{},"args":{{"status":{}}}}})",
+        static_cast<double>(spans.get_created()) / 1e3, static_cast<double>(ended - spans.get_created()) / 1e3, pid, id, status);
+
+    for (size_t i = 0; i < TRACE_PHASES_COUNT; i++)
+    {
+        const auto phase = static_cast<trace_phase_t>(i);
+
+        if (spans.get_begin(phase) == 0)
+        {
+            continue;
+        }
+
+        events += std::format(R"(,
+{{"name":"{}","cat":"phase","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{}}})",
+            trace_spans::name(phase), static_cast<double>(spans.get_begin(phase)) / 1e3, static_cast<double>(spans.get_duration(phase)) / 1e3, pid, id);
+    }
+
+    std::lock_guard<std::mutex> lk (mutex);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    if (!first)
+    {
+        buffer += ",\n";
+    }
+
+    first = false;
+    buffer += events;
+
+    if (buffer.size() >= block_size)
+    {
+        write_buffer();
+    }
+}
+
+void manapi::net::tracer::stop() {
+    std::lock_guard<std::mutex> lk (mutex);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    buffer += "\n]\n";
+
+    write_buffer();
+
+    close(fd);
+    fd = -1;
+}
+
+const manapi::net::trace_config_t &manapi::net::tracer::get_config() const {
+    return config;
+}
+
+void manapi::net::tracer::write_buffer() {
+    for (size_t offset = 0; offset < buffer.size();)
+    {
+        const ssize_t written = ::write(fd, buffer.data() + offset, buffer.size() - offset);
+
+        if (written <= 0)
+        {
+            MANAPI_LOG("could not write the trace to {}: {}", config.file, errno);
+            break;
+        }
+
+        offset += written;
+    }
+
+    buffer.clear();
+}
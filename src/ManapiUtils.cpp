@@ -8,6 +8,7 @@
 #include <random>
 #include <mutex>
 #include <fstream>
+#include <array>
 #include <unicode/utf32.h>
 #include <unicode/utf16.h>
 #include <unicode/utf8.h>
@@ -258,7 +259,69 @@ std::string manapi::net::utils::encode_url(const std::string &str) {
     return escaped.str();
 }
 
-std::string manapi::net::utils::decode_url(const std::string &str) {}
+// the value of the hex digit, -1 -> not a digit
+static constexpr std::array<int8_t, 256> hex_table = [] () {
+    std::array<int8_t, 256> table {};
+    table.fill(-1);
+
+    for (int i = 0; i < 10; i++)
+    {
+        table['0' + i] = static_cast<int8_t>(i);
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        table['a' + i] = static_cast<int8_t>(10 + i);
+        table['A' + i] = static_cast<int8_t>(10 + i);
+    }
+
+    return table;
+} ();
+
+std::string manapi::net::utils::decode_url(std::string_view str) {
+    std::string decoded;
+
+    // nothing to decode -> one copy
+    size_t pos = str.find_first_of("%+");
+
+    if (pos == std::string_view::npos)
+    {
+        return std::string (str);
+    }
+
+    decoded.reserve(str.size());
+
+    while (pos != std::string_view::npos)
+    {
+        decoded.append(str.data(), pos);
+
+        if (str[pos] == '+')
+        {
+            decoded.push_back(' ');
+
+            str.remove_prefix(pos + 1);
+        }
+        else if (pos + 2 < str.size() && hex_table[static_cast<uint8_t>(str[pos + 1])] >= 0 && hex_table[static_cast<uint8_t>(str[pos + 2])] >= 0)
+        {
+            decoded.push_back(static_cast<char>(hex_table[static_cast<uint8_t>(str[pos + 1])] << 4 | hex_table[static_cast<uint8_t>(str[pos + 2])]));
+
+            str.remove_prefix(pos + 3);
+        }
+        else
+        {
+            // the invalid escape
+            decoded.push_back('%');
+
+            str.remove_prefix(pos + 1);
+        }
+
+        pos = str.find_first_of("%+");
+    }
+
+    decoded.append(str);
+
+    return decoded;
+}
 
 std::string manapi::net::utils::json2form(const json &obj) {
     if (!obj.is_object())
@@ -434,6 +497,106 @@ std::vector <manapi::net::utils::replace_founded_item> manapi::net::utils::found
 // ===================== [ Classes ] ========================== //
 // ============================================================ //
 
+manapi::net::utils::url_params::url_params(std::string_view data) {
+    // a=1&b=2&a=3, one pass, the pairs are views
+    while (!data.empty())
+    {
+        const size_t end = std::min(data.find('&'), data.size());
+        const std::string_view pair = data.substr(0, end);
+
+        data.remove_prefix(std::min(end + 1, data.size()));
+
+        if (pair.empty())
+        {
+            continue;
+        }
+
+        item_t item;
+
+        if (const size_t eq = pair.find('='); eq != std::string_view::npos)
+        {
+            item.key    = pair.substr(0, eq);
+            item.value  = pair.substr(eq + 1);
+        }
+        else
+        {
+            item.key    = pair;
+        }
+
+        if (item.key.find_first_of("%+") != std::string_view::npos)
+        {
+            // the keys are compared on each lookup, decode once
+            item.key_decoded = decode_url(item.key);
+        }
+
+        items.push_back(std::move(item));
+    }
+}
+
+bool manapi::net::utils::url_params::contains(std::string_view name) const {
+    return find(name) != nullptr;
+}
+
+const std::string *manapi::net::utils::url_params::find(std::string_view name) const {
+    for (const auto &item: items)
+    {
+        if (item.name() == name)
+        {
+            return &item.get();
+        }
+    }
+
+    return nullptr;
+}
+
+manapi::net::utils::VEC_STR manapi::net::utils::url_params::find_all(std::string_view name) const {
+    VEC_STR values;
+
+    for (const auto &item: items)
+    {
+        if (item.name() == name)
+        {
+            values.push_back(item.get());
+        }
+    }
+
+    return values;
+}
+
+manapi::net::utils::MAP_STR_STR manapi::net::utils::url_params::to_map() const {
+    MAP_STR_STR map;
+
+    for (const auto &item: items)
+    {
+        std::string name (item.name());
+
+        if (!map.contains(name))
+        {
+            map.emplace(std::move(name), item.get());
+        }
+    }
+
+    return map;
+}
+
+size_t manapi::net::utils::url_params::size() const {
+    return items.size();
+}
+
+std::string_view manapi::net::utils::url_params::item_t::name() const {
+    return key_decoded.empty() ? key : key_decoded;
+}
+
+const std::string &manapi::net::utils::url_params::item_t::get() const {
+    if (!decoded)
+    {
+        value_decoded   = decode_url(value);
+        decoded         = true;
+    }
+
+    return value_decoded;
+}
+
 manapi::net::utils::exception::exception(const err_num &errnum, std::string message_): message(std::move(message_)) {
     this->errnum = errnum;
 }
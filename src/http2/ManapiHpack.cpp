@@ -0,0 +1,467 @@
+#include <array>
+#include <unordered_map>
+
+#include "ManapiUtils.hpp"
+#include "http2/ManapiHpack.hpp"
+
+// RFC 7541 4.1: each entry has 32 bytes of overhead
+#define MANAPI_HPACK_ENTRY_OVERHEAD 32
+#define MANAPI_HPACK_HUFFMAN_EOS 256
+
+namespace manapi::net::http2::hpack {
+    // RFC 7541 Appendix A
+    static const hpack_entry static_table[] = {
+        {":authority", ""},
+        {":method", "GET"},
+        {":method", "POST"},
+        {":path", "/"},
+        {":path", "/index.html"},
+        {":scheme", "http"},
+        {":scheme", "https"},
+        {":status", "200"},
+        {":status", "204"},
+        {":status", "206"},
+        {":status", "304"},
+        {":status", "400"},
+        {":status", "404"},
+        {":status", "500"},
+        {"accept-charset", ""},
+        {"accept-encoding", "gzip, deflate"},
+        {"accept-language", ""},
+        {"accept-ranges", ""},
+        {"accept", ""},
+        {"access-control-allow-origin", ""},
+        {"age", ""},
+        {"allow", ""},
+        {"authorization", ""},
+        {"cache-control", ""},
+        {"content-disposition", ""},
+        {"content-encoding", ""},
+        {"content-language", ""},
+        {"content-length", ""},
+        {"content-location", ""},
+        {"content-range", ""},
+        {"content-type", ""},
+        {"cookie", ""},
+        {"date", ""},
+        {"etag", ""},
+        {"expect", ""},
+        {"expires", ""},
+        {"from", ""},
+        {"host", ""},
+        {"if-match", ""},
+        {"if-modified-since", ""},
+        {"if-none-match", ""},
+        {"if-range", ""},
+        {"if-unmodified-since", ""},
+        {"last-modified", ""},
+        {"link", ""},
+        {"location", ""},
+        {"max-forwards", ""},
+        {"proxy-authenticate", ""},
+        {"proxy-authorization", ""},
+        {"range", ""},
+        {"referer", ""},
+        {"refresh", ""},
+        {"retry-after", ""},
+        {"server", ""},
+        {"set-cookie", ""},
+        {"strict-transport-security", ""},
+        {"transfer-encoding", ""},
+        {"user-agent", ""},
+        {"vary", ""},
+        {"via", ""},
+        {"www-authenticate", ""}
+    };
+
+    constexpr size_t static_table_size = sizeof (static_table) / sizeof (hpack_entry);
+
+    // RFC 7541 Appendix B: the code is canonical, so only the lengths of the codes are stored
+    static constexpr uint8_t huffman_lengths[257] = {
+        13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+        28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+         6, 10, 10, 12, 13,  6,  8, 11, 10, 10,  8, 11,  8,  6,  6,  6,
+         5,  5,  5,  6,  6,  6,  6,  6,  6,  6,  7,  8, 15,  6, 12, 10,
+        13,  6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+         7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  8, 13, 19, 13, 14,  6,
+        15,  5,  6,  5,  6,  5,  6,  6,  6,  5,  7,  7,  6,  6,  6,  5,
+         6,  7,  6,  5,  5,  6,  7,  7,  7,  7,  7, 15, 11, 14, 13, 28,
+        20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+        24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+        22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+        21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+        26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+        19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+        20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+        26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+        30
+    };
+
+    struct huffman_table_t {
+        uint32_t                    codes[257];
+        // canonical decoding: the first code, the count of codes and the offset in symbols for each length
+        uint32_t                    first_code[31];
+        uint16_t                    count[31];
+        uint16_t                    offset[31];
+        uint16_t                    symbols[257];
+    };
+
+    static const huffman_table_t &huffman_table () {
+        static const huffman_table_t table = [] () -> huffman_table_t {
+            huffman_table_t t{};
+
+            for (const auto &length: huffman_lengths) {
+                t.count[length]++;
+            }
+
+            uint32_t code = 0;
+            uint16_t offset = 0;
+            for (size_t length = 1; length <= 30; length++) {
+                code = (code + t.count[length - 1]) << 1;
+                t.first_code[length] = code;
+                t.offset[length] = offset;
+                offset += t.count[length];
+            }
+
+            uint16_t next[31];
+            std::copy(std::begin(t.offset), std::end(t.offset), std::begin(next));
+
+            // symbols with the same length are sorted by value
+            for (uint16_t symbol = 0; symbol <= MANAPI_HPACK_HUFFMAN_EOS; symbol++) {
+                const uint8_t length = huffman_lengths[symbol];
+                const uint16_t position = next[length]++;
+
+                t.symbols[position] = symbol;
+                t.codes[symbol] = t.first_code[length] + (position - t.offset[length]);
+            }
+
+            return t;
+        } ();
+
+        return table;
+    }
+
+    size_t decode_integer(const uint8_t *&ptr, const uint8_t *end, const uint8_t &prefix) {
+        if (ptr >= end) {
+            THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: unexpected end of the integer");
+        }
+
+        const size_t mask = (1 << prefix) - 1;
+        size_t value = *ptr & mask;
+        ptr++;
+
+        if (value < mask) {
+            return value;
+        }
+
+        for (size_t shift = 0; ptr < end; shift += 7) {
+            // the values are limited by 2^32 in the HTTP/2
+            if (shift > 28) {
+                THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: the integer is too large");
+            }
+
+            const uint8_t byte = *ptr++;
+            value += static_cast<size_t>(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+
+        THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: unexpected end of the integer");
+    }
+
+    void encode_integer(std::string &out, const uint8_t &flags, const uint8_t &prefix, size_t value) {
+        const size_t mask = (1 << prefix) - 1;
+
+        if (value < mask) {
+            out += static_cast<char>(flags | value);
+            return;
+        }
+
+        out += static_cast<char>(flags | mask);
+        value -= mask;
+
+        while (value >= 0x80) {
+            out += static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+
+        out += static_cast<char>(value);
+    }
+
+    void decode_string(std::string &out, const uint8_t *&ptr, const uint8_t *end) {
+        if (ptr >= end) {
+            THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: unexpected end of the string");
+        }
+
+        const bool huffman = *ptr & 0x80;
+        const size_t size = decode_integer(ptr, end, 7);
+
+        if (size > static_cast<size_t>(end - ptr)) {
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "hpack: the string length {} is out of the block", size);
+        }
+
+        if (huffman) {
+            huffman_decode(out, ptr, size);
+        }
+        else {
+            out.assign(reinterpret_cast<const char *>(ptr), size);
+        }
+
+        ptr += size;
+    }
+
+    void encode_string(std::string &out, const std::string &str) {
+        const size_t encoded_size = huffman_encoded_size(str);
+
+        if (encoded_size < str.size()) {
+            encode_integer(out, 0x80, 7, encoded_size);
+            huffman_encode(out, str);
+            return;
+        }
+
+        encode_integer(out, 0x00, 7, str.size());
+        out += str;
+    }
+
+    void huffman_decode(std::string &out, const uint8_t *data, const size_t &size) {
+        const auto &table = huffman_table();
+
+        out.reserve(out.size() + size * 8 / 5);
+
+        uint32_t code = 0;
+        uint8_t length = 0;
+
+        for (size_t i = 0; i < size; i++) {
+            for (int bit = 7; bit >= 0; bit--) {
+                code = (code << 1) | ((data[i] >> bit) & 1);
+                length++;
+
+                if (length > 30) {
+                    THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: invalid huffman code");
+                }
+
+                if (code >= table.first_code[length] && code - table.first_code[length] < table.count[length]) {
+                    const uint16_t symbol = table.symbols[table.offset[length] + code - table.first_code[length]];
+
+                    if (symbol == MANAPI_HPACK_HUFFMAN_EOS) {
+                        THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: the huffman string contains EOS");
+                    }
+
+                    out += static_cast<char>(symbol);
+                    code = 0;
+                    length = 0;
+                }
+            }
+        }
+
+        // RFC 7541 5.2: the padding is the most significant bits of EOS and not longer than 7 bits
+        if (length > 7 || code != (1u << length) - 1) {
+            THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: invalid huffman padding");
+        }
+    }
+
+    void huffman_encode(std::string &out, const std::string &str) {
+        const auto &table = huffman_table();
+
+        uint64_t bits = 0;
+        size_t count = 0;
+
+        for (const auto &c: str) {
+            const auto symbol = static_cast<uint8_t>(c);
+
+            bits = (bits << huffman_lengths[symbol]) | table.codes[symbol];
+            count += huffman_lengths[symbol];
+
+            while (count >= 8) {
+                count -= 8;
+                out += static_cast<char>(bits >> count);
+            }
+        }
+
+        if (count > 0) {
+            // the padding by the EOS prefix
+            out += static_cast<char>((bits << (8 - count)) | (0xff >> count));
+        }
+    }
+
+    size_t huffman_encoded_size(const std::string &str) {
+        size_t bits = 0;
+
+        for (const auto &c: str) {
+            bits += huffman_lengths[static_cast<uint8_t>(c)];
+        }
+
+        return (bits + 7) / 8;
+    }
+
+    size_t static_table_find(const std::string &name, const std::string &value, bool &full_match) {
+        static const std::unordered_map<std::string, size_t> names = [] () -> std::unordered_map<std::string, size_t> {
+            std::unordered_map<std::string, size_t> m;
+
+            for (size_t i = static_table_size; i > 0; i--) {
+                m[static_table[i - 1].name] = i;
+            }
+
+            return m;
+        } ();
+
+        full_match = false;
+
+        const auto it = names.find(name);
+
+        if (it == names.end()) {
+            return 0;
+        }
+
+        for (size_t i = it->second; i <= static_table_size && static_table[i - 1].name == name; i++) {
+            if (static_table[i - 1].value == value) {
+                full_match = true;
+                return i;
+            }
+        }
+
+        return it->second;
+    }
+}
+
+// ======================[ decoder ]==========================
+
+manapi::net::http2::hpack_decoder::hpack_decoder(const size_t &max_table_size) {
+    this->max_table_size = max_table_size;
+    this->table_capacity = max_table_size;
+}
+
+void manapi::net::http2::hpack_decoder::decode(const uint8_t *data, const size_t &size, const hpack_header_cb_t &callback) {
+    const uint8_t *ptr = data;
+    const uint8_t *end = data + size;
+
+    bool headers_started = false;
+
+    while (ptr < end) {
+        const uint8_t byte = *ptr;
+
+        if (byte & 0x80) {
+            // indexed header field
+            const size_t index = hpack::decode_integer(ptr, end, 7);
+            const auto &entry = get_entry(index);
+
+            callback(std::string(entry.name), std::string(entry.value));
+
+            headers_started = true;
+            continue;
+        }
+
+        if ((byte & 0xe0) == 0x20) {
+            // dynamic table size update, only at the beginning of the block (RFC 7541 4.2)
+            if (headers_started) {
+                THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: the dynamic table size update after the header field");
+            }
+
+            const size_t capacity = hpack::decode_integer(ptr, end, 5);
+
+            if (capacity > max_table_size) {
+                THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "hpack: the dynamic table size {} > {}", capacity, max_table_size);
+            }
+
+            table_capacity = capacity;
+            evict(table_capacity);
+            continue;
+        }
+
+        // literal header field
+        const bool indexing = byte & 0x40;
+        const size_t index = hpack::decode_integer(ptr, end, indexing ? 6 : 4);
+
+        std::string name, value;
+
+        if (index == 0) {
+            hpack::decode_string(name, ptr, end);
+        }
+        else {
+            name = get_entry(index).name;
+        }
+
+        hpack::decode_string(value, ptr, end);
+
+        if (indexing) {
+            insert(std::string(name), std::string(value));
+        }
+
+        callback(std::move(name), std::move(value));
+
+        headers_started = true;
+    }
+}
+
+const size_t &manapi::net::http2::hpack_decoder::get_max_table_size() const {
+    return max_table_size;
+}
+
+const manapi::net::http2::hpack_entry &manapi::net::http2::hpack_decoder::get_entry(const size_t &index) const {
+    if (index == 0) {
+        THROW_MANAPI_EXCEPTION2(ERR_HTTP_PROTOCOL_ERROR, "hpack: the index 0 is not used");
+    }
+
+    if (index <= hpack::static_table_size) {
+        return hpack::static_table[index - 1];
+    }
+
+    const size_t dynamic_index = index - hpack::static_table_size - 1;
+
+    if (dynamic_index >= table.size()) {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "hpack: the index {} is out of the tables", index);
+    }
+
+    return table[dynamic_index];
+}
+
+void manapi::net::http2::hpack_decoder::insert(std::string &&name, std::string &&value) {
+    const size_t size = name.size() + value.size() + MANAPI_HPACK_ENTRY_OVERHEAD;
+
+    // RFC 7541 4.4: an entry larger than the table empties the table
+    if (size > table_capacity) {
+        evict(0);
+        return;
+    }
+
+    evict(table_capacity - size);
+
+    table.push_front({std::move(name), std::move(value)});
+    table_size += size;
+}
+
+void manapi::net::http2::hpack_decoder::evict(const size_t &capacity) {
+    while (table_size > capacity && !table.empty()) {
+        const auto &entry = table.back();
+        table_size -= entry.name.size() + entry.value.size() + MANAPI_HPACK_ENTRY_OVERHEAD;
+        table.pop_back();
+    }
+}
+
+// ======================[ encoder ]==========================
+
+void manapi::net::http2::hpack_encoder::encode_status(std::string &out, const size_t &status) {
+    encode(out, ":status", std::to_string(status));
+}
+
+void manapi::net::http2::hpack_encoder::encode(std::string &out, const std::string &name, const std::string &value) {
+    bool full_match;
+    const size_t index = hpack::static_table_find(name, value, full_match);
+
+    if (full_match) {
+        // indexed header field
+        hpack::encode_integer(out, 0x80, 7, index);
+        return;
+    }
+
+    // literal header field without indexing
+    hpack::encode_integer(out, 0x00, 4, index);
+
+    if (index == 0) {
+        hpack::encode_string(out, name);
+    }
+
+    hpack::encode_string(out, value);
+}
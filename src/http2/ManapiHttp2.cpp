@@ -0,0 +1,1183 @@
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <algorithm>
+#include <charconv>
+#include <sys/socket.h>
+
+#include "ManapiUtils.hpp"
+#include "ManapiTaskHttp.hpp"
+#include "http2/ManapiHttp2.hpp"
+
+#define MANAPI_HTTP2_MIN_FRAME_SIZE     16384
+#define MANAPI_HTTP2_MAX_FRAME_SIZE     16777215
+// the smallest DATA frame for the low priority streams
+#define MANAPI_HTTP2_MIN_DATA_QUANTUM   1024
+// RFC 9113 8.2.2: the connection-specific header fields
+static const std::string connection_specific_headers[] = {"connection", "keep-alive", "proxy-connection", "transfer-encoding", "upgrade"};
+
+static uint32_t read_uint32 (const uint8_t *data) {
+    return static_cast<uint32_t>(data[0]) << 24 | static_cast<uint32_t>(data[1]) << 16 | static_cast<uint32_t>(data[2]) << 8 | data[3];
+}
+
+static void append_uint32 (std::string &out, const uint32_t &value) {
+    out += static_cast<char>(value >> 24);
+    out += static_cast<char>(value >> 16);
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value);
+}
+
+static bool is_connection_specific_header (const std::string &name) {
+    return std::find(std::begin(connection_specific_headers), std::end(connection_specific_headers), name) != std::end(connection_specific_headers);
+}
+
+manapi::net::http2::connection::connection(http_task *task, const int &fd, SSL *ssl, class site *site, class config *config) : decoder (config->get_http2_header_table_size()) {
+    this->task = task;
+    this->fd = fd;
+    this->ssl = ssl;
+    this->site = site;
+    this->config = config;
+
+    // send_settings () raises the connection window up to the initial window of the streams
+    this->recv_window = std::max<int64_t>(MANAPI_HTTP2_DEFAULT_WINDOW, static_cast<int64_t>(config->get_http2_initial_window_size()));
+}
+
+manapi::net::http2::connection::~connection() = default;
+
+bool manapi::net::http2::connection::is_preface(const char *data, const size_t &size) {
+    return size >= MANAPI_HTTP2_PREFACE_LEN && memcmp(data, MANAPI_HTTP2_PREFACE, MANAPI_HTTP2_PREFACE_LEN) == 0;
+}
+
+void manapi::net::http2::connection::run(const char *data, const size_t &size) {
+    // the SSL object is shared by the connection thread and the stream tasks,
+    // so the blocking calls can not be used while io_mutex is locked
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    in_buffer.assign(data, size);
+
+    // the initial bytes are 0-RTT when the handshake accepted the early data
+    early_left = task->early_request ? size : 0;
+
+    utils::before_delete bd_run([this] () -> void {
+        std::unique_lock<std::mutex> lk (mutex);
+
+        closed = true;
+        cv.notify_all();
+
+        // the stream tasks use the connection until they are finished
+        cv.wait(lk, [this] () -> bool { return streams.empty(); });
+    });
+
+    try {
+        send_settings();
+
+        if (!fill(MANAPI_HTTP2_PREFACE_LEN)) {
+            return;
+        }
+
+        if (!is_preface(in_buffer.data(), in_buffer.size())) {
+            connection_error(errors::PROTOCOL_ERROR, "invalid connection preface");
+        }
+
+        in_offset = MANAPI_HTTP2_PREFACE_LEN;
+        early_left -= std::min(early_left, MANAPI_HTTP2_PREFACE_LEN);
+
+        while (fill(MANAPI_HTTP2_FRAME_HEADER_LEN)) {
+            const auto header = reinterpret_cast<const uint8_t *>(in_buffer.data() + in_offset);
+
+            const size_t length = header[0] << 16 | header[1] << 8 | header[2];
+            const uint8_t type = header[3];
+            const uint8_t frame_flags = header[4];
+            const uint32_t id = read_uint32(header + 5) & MANAPI_HTTP2_MAX_WINDOW;
+
+            if (length > config->get_http2_max_frame_size()) {
+                connection_error(errors::FRAME_SIZE_ERROR, std::format("the frame size {} > {}", length, config->get_http2_max_frame_size()));
+            }
+
+            if (!fill(MANAPI_HTTP2_FRAME_HEADER_LEN + length)) {
+                break;
+            }
+
+            const auto payload = reinterpret_cast<const uint8_t *>(in_buffer.data() + in_offset + MANAPI_HTTP2_FRAME_HEADER_LEN);
+
+            frame_early = early_left > 0;
+
+            on_frame(type, frame_flags, id, payload, length);
+
+            in_offset += MANAPI_HTTP2_FRAME_HEADER_LEN + length;
+            early_left -= std::min(early_left, MANAPI_HTTP2_FRAME_HEADER_LEN + length);
+
+            std::lock_guard<std::mutex> lk (mutex);
+            if (goaway && streams.empty()) {
+                break;
+            }
+        }
+    }
+    catch (const manapi::net::utils::exception &e) {
+        MANAPI_LOG("http2 connection closed: {}", e.what());
+    }
+}
+
+// ======================[ streams ]==========================
+
+ssize_t manapi::net::http2::connection::stream_read(const uint32_t &id, char *buff, const size_t &size) {
+    std::unique_lock<std::mutex> lk (mutex);
+
+    const auto s = get_stream(id);
+
+    if (s == nullptr) {
+        return -1;
+    }
+
+    const bool ready = cv.wait_for(lk, std::chrono::seconds(config->get_recv_timeout()), [this, &s] () -> bool {
+        return closed || s->reset || s->remote_closed || s->recv_offset < s->recv_buffer.size();
+    });
+
+    if (!ready) {
+        MANAPI_LOG("http2 read timeout ({}s): stream_id: {}", config->get_recv_timeout(), id);
+        return -1;
+    }
+
+    if (closed || s->reset) {
+        return -1;
+    }
+
+    const size_t read = std::min(size, s->recv_buffer.size() - s->recv_offset);
+
+    if (read == 0) {
+        // END_STREAM
+        return 0;
+    }
+
+    memcpy(buff, s->recv_buffer.data() + s->recv_offset, read);
+    s->recv_offset += read;
+
+    if (s->recv_offset == s->recv_buffer.size()) {
+        s->recv_buffer.clear();
+        s->recv_offset = 0;
+    }
+
+    // give back the window when the half of it was consumed
+    s->recv_window += static_cast<int64_t>(read);
+    s->recv_unacked += read;
+
+    uint32_t increment = 0;
+
+    if (!s->remote_closed && s->recv_unacked >= std::max<size_t>(config->get_http2_initial_window_size() / 2, 1)) {
+        increment = s->recv_unacked;
+        s->recv_unacked = 0;
+    }
+
+    const uint32_t connection_increment = consume(read);
+
+    lk.unlock();
+
+    if (connection_increment != 0) {
+        send_window_update(0, connection_increment);
+    }
+
+    if (increment != 0) {
+        send_window_update(id, increment);
+    }
+
+    return static_cast<ssize_t>(read);
+}
+
+ssize_t manapi::net::http2::connection::stream_write(const uint32_t &id, const char *buff, const size_t &size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lk (mutex);
+
+    const auto s = get_stream(id);
+
+    if (s == nullptr || !s->headers_sent || s->local_closed) {
+        return -1;
+    }
+
+    const bool ready = cv.wait_for(lk, std::chrono::seconds(config->get_send_timeout()), [this, &s] () -> bool {
+        return closed || s->reset || (send_window > 0 && s->send_window > 0);
+    });
+
+    if (!ready) {
+        MANAPI_LOG("http2 write timeout ({}s): stream_id: {}, window: {}, stream window: {}", config->get_send_timeout(), id, send_window, s->send_window);
+        return -1;
+    }
+
+    if (closed || s->reset) {
+        return -1;
+    }
+
+    // the streams with the lower weight send the smaller frames, so the heavier
+    // streams get the bigger part of the connection window (RFC 9113 5.3.2)
+    uint16_t max_weight = 1;
+    for (const auto &it: streams) {
+        if (it.second->headers_sent && !it.second->local_closed) {
+            max_weight = std::max(max_weight, it.second->weight);
+        }
+    }
+
+    const size_t quantum = std::max<size_t>(peer_max_frame_size * s->weight / max_weight, MANAPI_HTTP2_MIN_DATA_QUANTUM);
+
+    const size_t written = std::min({size, quantum, peer_max_frame_size, static_cast<size_t>(send_window), static_cast<size_t>(s->send_window)});
+
+    send_window -= static_cast<int64_t>(written);
+    s->send_window -= static_cast<int64_t>(written);
+
+    lk.unlock();
+
+    write_frame(frame::DATA, 0, id, buff, written);
+
+    return static_cast<ssize_t>(written);
+}
+
+ssize_t manapi::net::http2::connection::stream_response(const uint32_t &id, http_response &res) {
+    std::string block;
+
+    hpack_encoder::encode_status(block, res.get_status_code());
+
+    for (const auto &header: res.get_headers()) {
+        std::string name = header.first;
+        std::transform(name.begin(), name.end(), name.begin(), [] (const unsigned char &c) -> char { return static_cast<char>(std::tolower(c)); });
+
+        if (is_connection_specific_header(name)) {
+            continue;
+        }
+
+        hpack_encoder::encode(block, name, header.second);
+    }
+
+    size_t frame_size;
+
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        const auto s = get_stream(id);
+
+        if (closed || s == nullptr || s->reset || s->headers_sent) {
+            return -1;
+        }
+
+        s->headers_sent = true;
+        frame_size = peer_max_frame_size;
+    }
+
+    // HEADERS + CONTINUATION must not be interleaved with the other frames
+    std::string frames;
+    size_t offset = 0;
+
+    do {
+        const size_t part = std::min(block.size() - offset, frame_size);
+        const bool last = offset + part == block.size();
+
+        append_frame_header(frames, part, offset == 0 ? frame::HEADERS : frame::CONTINUATION, last ? flags::END_HEADERS : 0, id);
+        frames.append(block, offset, part);
+
+        offset += part;
+    } while (offset < block.size());
+
+    write_raw(frames);
+
+    return static_cast<ssize_t>(block.size());
+}
+
+void manapi::net::http2::connection::stream_reset(const uint32_t &id, const uint32_t &code) {
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        const auto s = get_stream(id);
+
+        if (s == nullptr || closed || s->reset) {
+            return;
+        }
+
+        s->reset = true;
+        s->local_closed = true;
+
+        cv.notify_all();
+    }
+
+    try {
+        send_rst_stream(id, code);
+    }
+    catch (const manapi::net::utils::exception &e) {
+        MANAPI_LOG("http2 stream {} reset failed: {}", id, e.what());
+    }
+}
+
+void manapi::net::http2::connection::stream_finish(const uint32_t &id) {
+    bool headers_sent, local_closed, remote_closed, skip;
+
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        const auto s = get_stream(id);
+
+        if (s == nullptr) {
+            return;
+        }
+
+        headers_sent = s->headers_sent;
+        local_closed = s->local_closed;
+        remote_closed = s->remote_closed;
+        skip = closed || s->reset;
+
+        s->local_closed = true;
+    }
+
+    try {
+        if (!skip) {
+            if (!headers_sent) {
+                // the handler did not send the response
+                send_rst_stream(id, errors::INTERNAL_ERROR);
+            }
+            else {
+                if (!local_closed) {
+                    write_frame(frame::DATA, flags::END_STREAM, id, nullptr, 0);
+                }
+
+                // RFC 9113 8.1: the response is complete, the rest of the request is not needed
+                if (!remote_closed) {
+                    send_rst_stream(id, errors::NO_ERROR);
+                }
+            }
+        }
+    }
+    catch (const manapi::net::utils::exception &e) {
+        MANAPI_LOG("http2 stream {} finish failed: {}", id, e.what());
+    }
+
+    close_stream(id);
+}
+
+std::shared_ptr<manapi::net::http2::stream> manapi::net::http2::connection::get_stream(const uint32_t &id) {
+    const auto it = streams.find(id);
+
+    if (it == streams.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+void manapi::net::http2::connection::close_stream(const uint32_t &id) {
+    uint32_t increment = 0;
+
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        // the unread data of the stream is not consumed by the task
+        if (const auto s = get_stream(id); s != nullptr && !closed) {
+            increment = consume(s->recv_buffer.size() - s->recv_offset);
+        }
+
+        streams.erase(id);
+        cv.notify_all();
+    }
+
+    if (increment != 0) {
+        try {
+            send_window_update(0, increment);
+        }
+        catch (const manapi::net::utils::exception &e) {
+            MANAPI_LOG("http2 window update failed: {}", e.what());
+        }
+    }
+}
+
+uint32_t manapi::net::http2::connection::consume(const size_t &size) {
+    recv_window += static_cast<int64_t>(size);
+    recv_unacked += size;
+
+    // the half of the window
+    if (recv_unacked < std::max<size_t>(MANAPI_HTTP2_DEFAULT_WINDOW, config->get_http2_initial_window_size()) / 2) {
+        return 0;
+    }
+
+    const auto increment = static_cast<uint32_t>(recv_unacked);
+    recv_unacked = 0;
+
+    return increment;
+}
+
+// ======================[ frames ]==========================
+
+void manapi::net::http2::connection::on_frame(const uint8_t &type, const uint8_t &flags, const uint32_t &id, const uint8_t *payload, const size_t &size) {
+    // RFC 9113 6.10: the header block must be contiguous
+    if (header_block_stream != 0 && (type != frame::CONTINUATION || id != header_block_stream)) {
+        connection_error(errors::PROTOCOL_ERROR, "expected CONTINUATION frame");
+    }
+
+    switch (type) {
+        case frame::DATA:           on_data(flags, id, payload, size);      break;
+        case frame::HEADERS:        on_headers(flags, id, payload, size);   break;
+        case frame::PRIORITY: {
+            if (id == 0) {
+                connection_error(errors::PROTOCOL_ERROR, "PRIORITY frame with the stream id 0");
+            }
+
+            if (size != 5) {
+                send_rst_stream(id, errors::FRAME_SIZE_ERROR);
+                break;
+            }
+
+            on_priority(id, payload);
+            break;
+        }
+        case frame::RST_STREAM:     on_rst_stream(id, payload, size);       break;
+        case frame::SETTINGS:       on_settings(flags, id, payload, size);  break;
+        case frame::PUSH_PROMISE:   connection_error(errors::PROTOCOL_ERROR, "PUSH_PROMISE frame from the client"); break;
+        case frame::PING:           on_ping(flags, id, payload, size);      break;
+        case frame::GOAWAY:         on_goaway(id, payload, size);           break;
+        case frame::WINDOW_UPDATE:  on_window_update(id, payload, size);    break;
+        case frame::CONTINUATION: {
+            if (header_block_stream == 0) {
+                connection_error(errors::PROTOCOL_ERROR, "unexpected CONTINUATION frame");
+            }
+
+            if (header_block.size() + size > config->get_max_header_block_size()) {
+                connection_error(errors::ENHANCE_YOUR_CALM, std::format("the header block size > {}", config->get_max_header_block_size()));
+            }
+
+            header_block.append(reinterpret_cast<const char *>(payload), size);
+
+            if (flags & flags::END_HEADERS) {
+                on_header_block(id, header_block_end_stream);
+            }
+
+            break;
+        }
+        default:
+            // RFC 9113 5.5: the unknown frames are ignored
+            break;
+    }
+}
+
+void manapi::net::http2::connection::on_data(const uint8_t &flags, const uint32_t &id, const uint8_t *payload, size_t size) {
+    if (id == 0) {
+        connection_error(errors::PROTOCOL_ERROR, "DATA frame with the stream id 0");
+    }
+
+    const size_t frame_size = size;
+    size_t padding = 0;
+
+    if (flags & flags::PADDED) {
+        if (size == 0 || payload[0] >= size) {
+            connection_error(errors::PROTOCOL_ERROR, "invalid padding in DATA frame");
+        }
+
+        padding = payload[0] + 1;
+        payload++;
+        size -= padding;
+    }
+
+    uint32_t stream_error = errors::NO_ERROR;
+    uint32_t increment = 0;
+    bool accepted = false;
+
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        recv_window -= static_cast<int64_t>(frame_size);
+
+        if (recv_window < 0) {
+            connection_error(errors::FLOW_CONTROL_ERROR, "the connection window overflow");
+        }
+
+        const auto s = get_stream(id);
+
+        if (s == nullptr && id > last_stream_id) {
+            connection_error(errors::PROTOCOL_ERROR, std::format("DATA frame for the idle stream {}", id));
+        }
+
+        // the finished or the reset streams drop the data
+        if (s != nullptr && !s->reset) {
+            if (s->remote_closed) {
+                stream_error = errors::STREAM_CLOSED;
+            }
+            else {
+                s->recv_window -= static_cast<int64_t>(frame_size);
+                s->recv_total += size;
+                s->remote_closed = flags & flags::END_STREAM;
+
+                if (s->recv_window < 0) {
+                    stream_error = errors::FLOW_CONTROL_ERROR;
+                }
+                else if (s->content_length >= 0 && (s->recv_total > static_cast<size_t>(s->content_length) || (s->remote_closed && s->recv_total != static_cast<size_t>(s->content_length)))) {
+                    // RFC 9113 8.1.1: the body does not match the content-length
+                    stream_error = errors::PROTOCOL_ERROR;
+                }
+                else {
+                    s->recv_buffer.append(reinterpret_cast<const char *>(payload), size);
+                    // the padding is not consumed by the task
+                    s->recv_window += static_cast<int64_t>(padding);
+
+                    accepted = true;
+                }
+            }
+
+            if (stream_error != errors::NO_ERROR) {
+                s->reset = true;
+            }
+
+            cv.notify_all();
+        }
+
+        // the data in the buffer of the stream is given back by stream_read ()
+        increment = consume(accepted ? padding : frame_size);
+    }
+
+    if (increment != 0) {
+        send_window_update(0, increment);
+    }
+
+    if (stream_error != errors::NO_ERROR) {
+        send_rst_stream(id, stream_error);
+        return;
+    }
+
+    if (accepted && padding > 0) {
+        send_window_update(id, padding);
+    }
+}
+
+void manapi::net::http2::connection::on_headers(const uint8_t &flags, const uint32_t &id, const uint8_t *payload, size_t size) {
+    if (id == 0) {
+        connection_error(errors::PROTOCOL_ERROR, "HEADERS frame with the stream id 0");
+    }
+
+    size_t padding = 0;
+
+    if (flags & flags::PADDED) {
+        if (size == 0) {
+            connection_error(errors::PROTOCOL_ERROR, "invalid padding in HEADERS frame");
+        }
+
+        padding = payload[0];
+        payload++;
+        size--;
+    }
+
+    if (flags & flags::PRIORITY) {
+        if (size < 5) {
+            connection_error(errors::PROTOCOL_ERROR, "invalid priority in HEADERS frame");
+        }
+
+        // the priority is applied after the stream is opened
+        header_block_priority.assign(reinterpret_cast<const char *>(payload), 5);
+        payload += 5;
+        size -= 5;
+    }
+    else {
+        header_block_priority.clear();
+    }
+
+    if (padding > size) {
+        connection_error(errors::PROTOCOL_ERROR, "invalid padding in HEADERS frame");
+    }
+
+    size -= padding;
+
+    if (size > config->get_max_header_block_size()) {
+        connection_error(errors::ENHANCE_YOUR_CALM, std::format("the header block size > {}", config->get_max_header_block_size()));
+    }
+
+    header_block.assign(reinterpret_cast<const char *>(payload), size);
+    header_block_stream = id;
+    header_block_end_stream = flags & flags::END_STREAM;
+    header_block_early = frame_early;
+
+    if (flags & flags::END_HEADERS) {
+        on_header_block(id, header_block_end_stream);
+    }
+}
+
+void manapi::net::http2::connection::on_header_block(const uint32_t &id, const bool &end_stream) {
+    const std::string block = std::move(header_block);
+    header_block.clear();
+    header_block_stream = 0;
+
+    // trailers
+    {
+        std::unique_lock<std::mutex> lk (mutex);
+
+        const auto s = get_stream(id);
+
+        if (s != nullptr || id <= last_stream_id) {
+            lk.unlock();
+
+            // the decoder state must be kept in sync
+            decode_header_block(block, [] (std::string &&, std::string &&) -> void {});
+
+            if (s == nullptr) {
+                // the stream is already finished
+                return;
+            }
+
+            if (!end_stream || s->remote_closed) {
+                connection_error(errors::PROTOCOL_ERROR, std::format("invalid trailers of the stream {}", id));
+            }
+
+            lk.lock();
+            s->remote_closed = true;
+
+            // RFC 9113 8.1.1: the body is shorter than the content-length
+            const bool incomplete = !s->reset && s->content_length >= 0 && s->recv_total != static_cast<size_t>(s->content_length);
+
+            if (incomplete) {
+                s->reset = true;
+            }
+
+            cv.notify_all();
+            lk.unlock();
+
+            if (incomplete) {
+                send_rst_stream(id, errors::PROTOCOL_ERROR);
+            }
+
+            return;
+        }
+    }
+
+    // RFC 9113 5.1.1: the client streams are odd and increase
+    if (id % 2 == 0) {
+        connection_error(errors::PROTOCOL_ERROR, std::format("invalid stream id {}", id));
+    }
+
+    last_stream_id = id;
+
+    auto stream_task = std::make_unique<http_task>(fd, task->client, task->client_len, site, config, CONN_H2);
+    auto &request_data = stream_task->request_data;
+
+    std::string path, authority;
+    bool malformed = false;
+    bool regular = false;
+    size_t headers_size = 0;
+
+    decode_header_block(block, [&] (std::string &&name, std::string &&value) -> void {
+        headers_size += name.size() + value.size() + 32;
+
+        if (name.empty() || std::any_of(name.begin(), name.end(), [] (const unsigned char &c) -> bool { return std::isupper(c); })) {
+            malformed = true;
+            return;
+        }
+
+        // pseudo-header fields (RFC 9113 8.3)
+        if (name[0] == ':') {
+            if (regular) {
+                malformed = true;
+            }
+            else if (name == ":method") {
+                request_data.method = std::move(value);
+            }
+            else if (name == ":path") {
+                path = std::move(value);
+            }
+            else if (name == ":authority") {
+                authority = std::move(value);
+            }
+            else if (name != ":scheme") {
+                malformed = true;
+            }
+
+            return;
+        }
+
+        regular = true;
+
+        if (is_connection_specific_header(name) || (name == "te" && value != "trailers")) {
+            malformed = true;
+            return;
+        }
+
+        auto &header = request_data.headers[name];
+
+        if (!header.empty()) {
+            // RFC 9113 8.2.3: the cookie can be split
+            header += name == "cookie" ? "; " : ", ";
+        }
+
+        header += value;
+    });
+
+    ssize_t content_length = -1;
+
+    if (const auto it = request_data.headers.find(HTTP_HEADER.CONTENT_LENGTH); it != request_data.headers.end()) {
+        const auto &value = it->second;
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), content_length);
+
+        // RFC 9113 8.1.1: the request without the body can not declare it
+        if (ec != std::errc {} || ptr != value.data() + value.size() || content_length < 0 || (end_stream && content_length > 0)) {
+            malformed = true;
+        }
+    }
+
+    if (malformed || request_data.method.empty() || path.empty() || headers_size > config->get_max_header_block_size()) {
+        send_rst_stream(id, errors::PROTOCOL_ERROR);
+        return;
+    }
+
+    auto s = std::make_shared<stream>();
+    s->id = id;
+    s->content_length = content_length;
+    s->recv_window = static_cast<int64_t>(config->get_http2_initial_window_size());
+    s->remote_closed = end_stream;
+
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        if (goaway || streams.size() >= config->get_http2_max_concurrent_streams()) {
+            s = nullptr;
+        }
+        else {
+            s->send_window = static_cast<int64_t>(peer_initial_window);
+            streams.insert({id, s});
+        }
+    }
+
+    if (s == nullptr) {
+        send_rst_stream(id, errors::REFUSED_STREAM);
+        return;
+    }
+
+    if (!header_block_priority.empty()) {
+        on_priority(id, reinterpret_cast<const uint8_t *>(header_block_priority.data()));
+    }
+
+    if (!authority.empty() && !request_data.headers.contains(HTTP_HEADER.HOST)) {
+        request_data.headers[HTTP_HEADER.HOST] = std::move(authority);
+    }
+
+    size_t i = 0;
+    http_task::parse_uri_path_dynamic(request_data, path.data(), path.size(), i);
+
+    request_data.http = "HTTP/2";
+    request_data.has_body = !end_stream;
+
+    stream_task->h2_conn = shared_from_this();
+    stream_task->stream_id = id;
+    // the unsafe methods get 425 (RFC 8470)
+    stream_task->early_request = header_block_early;
+
+    site->append_task(std::move(stream_task), 2);
+}
+
+void manapi::net::http2::connection::decode_header_block(const std::string &block, const hpack_header_cb_t &callback) {
+    try {
+        decoder.decode(reinterpret_cast<const uint8_t *>(block.data()), block.size(), callback);
+    }
+    catch (const manapi::net::utils::exception &e) {
+        // RFC 9113 4.3: the state of the decoder is lost, the connection can not be used
+        connection_error(errors::COMPRESSION_ERROR, e.what());
+    }
+}
+
+void manapi::net::http2::connection::on_priority(const uint32_t &id, const uint8_t *payload) {
+    const uint32_t dependency = read_uint32(payload) & MANAPI_HTTP2_MAX_WINDOW;
+
+    if (dependency == id) {
+        send_rst_stream(id, errors::PROTOCOL_ERROR);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk (mutex);
+
+    const auto s = get_stream(id);
+
+    if (s == nullptr) {
+        return;
+    }
+
+    s->dependency = dependency;
+    s->exclusive = payload[0] & 0x80;
+    s->weight = static_cast<uint16_t>(payload[4]) + 1;
+}
+
+void manapi::net::http2::connection::on_rst_stream(const uint32_t &id, const uint8_t *payload, const size_t &size) {
+    if (size != 4) {
+        connection_error(errors::FRAME_SIZE_ERROR, "invalid RST_STREAM frame size");
+    }
+
+    if (id == 0 || id > last_stream_id) {
+        connection_error(errors::PROTOCOL_ERROR, std::format("RST_STREAM frame for the idle stream {}", id));
+    }
+
+    std::lock_guard<std::mutex> lk (mutex);
+
+    const auto s = get_stream(id);
+
+    if (s != nullptr) {
+        s->reset = true;
+        cv.notify_all();
+    }
+}
+
+void manapi::net::http2::connection::on_settings(const uint8_t &flags, const uint32_t &id, const uint8_t *payload, const size_t &size) {
+    if (id != 0) {
+        connection_error(errors::PROTOCOL_ERROR, "SETTINGS frame with the stream id");
+    }
+
+    if (flags & flags::ACK) {
+        if (size != 0) {
+            connection_error(errors::FRAME_SIZE_ERROR, "SETTINGS ACK with the payload");
+        }
+
+        return;
+    }
+
+    if (size % 6 != 0) {
+        connection_error(errors::FRAME_SIZE_ERROR, "invalid SETTINGS frame size");
+    }
+
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        for (size_t i = 0; i < size; i += 6) {
+            const uint16_t identifier = payload[i] << 8 | payload[i + 1];
+            const uint32_t value = read_uint32(payload + i + 2);
+
+            switch (identifier) {
+                case settings::ENABLE_PUSH:
+                    if (value > 1) {
+                        connection_error(errors::PROTOCOL_ERROR, "invalid SETTINGS_ENABLE_PUSH");
+                    }
+                    break;
+                case settings::INITIAL_WINDOW_SIZE: {
+                    if (value > MANAPI_HTTP2_MAX_WINDOW) {
+                        connection_error(errors::FLOW_CONTROL_ERROR, "invalid SETTINGS_INITIAL_WINDOW_SIZE");
+                    }
+
+                    // RFC 9113 6.9.2: the change is applied to all streams
+                    const int64_t delta = static_cast<int64_t>(value) - static_cast<int64_t>(peer_initial_window);
+
+                    for (const auto &it: streams) {
+                        it.second->send_window += delta;
+
+                        if (it.second->send_window > MANAPI_HTTP2_MAX_WINDOW) {
+                            connection_error(errors::FLOW_CONTROL_ERROR, "the stream window overflow");
+                        }
+                    }
+
+                    peer_initial_window = value;
+                    break;
+                }
+                case settings::MAX_FRAME_SIZE:
+                    if (value < MANAPI_HTTP2_MIN_FRAME_SIZE || value > MANAPI_HTTP2_MAX_FRAME_SIZE) {
+                        connection_error(errors::PROTOCOL_ERROR, "invalid SETTINGS_MAX_FRAME_SIZE");
+                    }
+
+                    peer_max_frame_size = value;
+                    break;
+                default:
+                    // SETTINGS_HEADER_TABLE_SIZE is not used, the encoder does not index the fields
+                    break;
+            }
+        }
+
+        cv.notify_all();
+    }
+
+    write_frame(frame::SETTINGS, flags::ACK, 0, nullptr, 0);
+}
+
+void manapi::net::http2::connection::on_ping(const uint8_t &flags, const uint32_t &id, const uint8_t *payload, const size_t &size) {
+    if (id != 0) {
+        connection_error(errors::PROTOCOL_ERROR, "PING frame with the stream id");
+    }
+
+    if (size != 8) {
+        connection_error(errors::FRAME_SIZE_ERROR, "invalid PING frame size");
+    }
+
+    if (flags & flags::ACK) {
+        return;
+    }
+
+    write_frame(frame::PING, flags::ACK, 0, reinterpret_cast<const char *>(payload), size);
+}
+
+void manapi::net::http2::connection::on_goaway(const uint32_t &id, const uint8_t *payload, const size_t &size) {
+    if (id != 0) {
+        connection_error(errors::PROTOCOL_ERROR, "GOAWAY frame with the stream id");
+    }
+
+    if (size < 8) {
+        connection_error(errors::FRAME_SIZE_ERROR, "invalid GOAWAY frame size");
+    }
+
+    const uint32_t code = read_uint32(payload + 4);
+
+    if (code != errors::NO_ERROR) {
+        MANAPI_LOG("http2 got GOAWAY: error code {}", code);
+    }
+
+    std::lock_guard<std::mutex> lk (mutex);
+
+    goaway = true;
+}
+
+void manapi::net::http2::connection::on_window_update(const uint32_t &id, const uint8_t *payload, const size_t &size) {
+    if (size != 4) {
+        connection_error(errors::FRAME_SIZE_ERROR, "invalid WINDOW_UPDATE frame size");
+    }
+
+    const uint32_t increment = read_uint32(payload) & MANAPI_HTTP2_MAX_WINDOW;
+
+    if (id == 0) {
+        if (increment == 0) {
+            connection_error(errors::PROTOCOL_ERROR, "WINDOW_UPDATE with zero increment");
+        }
+
+        std::lock_guard<std::mutex> lk (mutex);
+
+        send_window += increment;
+
+        if (send_window > MANAPI_HTTP2_MAX_WINDOW) {
+            connection_error(errors::FLOW_CONTROL_ERROR, "the connection window overflow");
+        }
+
+        cv.notify_all();
+        return;
+    }
+
+    uint32_t stream_error = errors::NO_ERROR;
+
+    {
+        std::lock_guard<std::mutex> lk (mutex);
+
+        const auto s = get_stream(id);
+
+        if (s == nullptr || s->reset) {
+            return;
+        }
+
+        if (increment == 0) {
+            stream_error = errors::PROTOCOL_ERROR;
+        }
+        else {
+            s->send_window += increment;
+
+            if (s->send_window > MANAPI_HTTP2_MAX_WINDOW) {
+                stream_error = errors::FLOW_CONTROL_ERROR;
+            }
+        }
+
+        if (stream_error != errors::NO_ERROR) {
+            s->reset = true;
+        }
+
+        cv.notify_all();
+    }
+
+    if (stream_error != errors::NO_ERROR) {
+        send_rst_stream(id, stream_error);
+    }
+}
+
+void manapi::net::http2::connection::send_settings() {
+    std::string payload;
+
+    const std::pair<uint16_t, size_t> values[] = {
+        {settings::HEADER_TABLE_SIZE,       config->get_http2_header_table_size()},
+        {settings::MAX_CONCURRENT_STREAMS,  config->get_http2_max_concurrent_streams()},
+        {settings::INITIAL_WINDOW_SIZE,     config->get_http2_initial_window_size()},
+        {settings::MAX_FRAME_SIZE,          config->get_http2_max_frame_size()},
+        {settings::MAX_HEADER_LIST_SIZE,    config->get_max_header_block_size()}
+    };
+
+    for (const auto &value: values) {
+        payload += static_cast<char>(value.first >> 8);
+        payload += static_cast<char>(value.first);
+        append_uint32(payload, value.second);
+    }
+
+    write_frame(frame::SETTINGS, 0, 0, payload.data(), payload.size());
+
+    // the connection window is not changed by SETTINGS
+    if (config->get_http2_initial_window_size() > MANAPI_HTTP2_DEFAULT_WINDOW) {
+        send_window_update(0, config->get_http2_initial_window_size() - MANAPI_HTTP2_DEFAULT_WINDOW);
+    }
+}
+
+void manapi::net::http2::connection::send_rst_stream(const uint32_t &id, const uint32_t &code) {
+    std::string payload;
+    append_uint32(payload, code);
+
+    write_frame(frame::RST_STREAM, 0, id, payload.data(), payload.size());
+}
+
+void manapi::net::http2::connection::send_window_update(const uint32_t &id, const uint32_t &increment) {
+    std::string payload;
+    append_uint32(payload, increment);
+
+    write_frame(frame::WINDOW_UPDATE, 0, id, payload.data(), payload.size());
+}
+
+void manapi::net::http2::connection::send_goaway(const uint32_t &code) {
+    std::string payload;
+    append_uint32(payload, last_stream_id);
+    append_uint32(payload, code);
+
+    write_frame(frame::GOAWAY, 0, 0, payload.data(), payload.size());
+}
+
+void manapi::net::http2::connection::connection_error(const uint32_t &code, const std::string &message) {
+    try {
+        send_goaway(code);
+    }
+    catch (const manapi::net::utils::exception &e) {
+        // the connection is already broken
+    }
+
+    THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "http2 error {}: {}", code, message);
+}
+
+// ======================[ transport ]==========================
+
+bool manapi::net::http2::connection::wait_fd(const short &events, const size_t &timeout) const {
+    pollfd pfd = {.fd = fd, .events = events, .revents = 0};
+
+    const int ready = poll(&pfd, 1, static_cast<int>(timeout));
+
+    if (ready < 0 && errno != EINTR) {
+        THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "unknow socket status (poll() < 0): {}", fd);
+    }
+
+    return ready > 0;
+}
+
+bool manapi::net::http2::connection::fill(const size_t &size) {
+    // the buffer of the tcp task (the pool), it is not used by the connection task otherwise
+    const size_t block_size = config->get_socket_block_size();
+    auto block = static_cast<char *>(task->buff);
+
+    while (in_buffer.size() - in_offset < size) {
+        if (in_offset > 0) {
+            in_buffer.erase(0, in_offset);
+            in_offset = 0;
+        }
+
+        if (ssl == nullptr || SSL_pending(ssl) <= 0) {
+            if (!wait_fd(POLLIN, config->get_keep_alive() * 1000)) {
+                std::unique_lock<std::mutex> lk (mutex);
+
+                if (streams.empty()) {
+                    lk.unlock();
+
+                    // the connection is idle
+                    send_goaway(errors::NO_ERROR);
+                    return false;
+                }
+
+                continue;
+            }
+        }
+
+        ssize_t read;
+
+        {
+            std::lock_guard<std::mutex> lk (io_mutex);
+
+            if (ssl != nullptr) {
+                read = SSL_read(ssl, block, static_cast<int>(block_size));
+
+                if (read <= 0) {
+                    const int err = SSL_get_error(ssl, static_cast<int>(read));
+
+                    if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+                        continue;
+                    }
+
+                    return false;
+                }
+            }
+            else {
+                read = ::read(fd, block, block_size);
+
+                if (read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                    continue;
+                }
+
+                if (read <= 0) {
+                    return false;
+                }
+            }
+        }
+
+        in_buffer.append(block, read);
+        site->get_metrics().bytes_in.add(read);
+    }
+
+    return true;
+}
+
+void manapi::net::http2::connection::write_raw(const std::string &data) {
+    std::lock_guard<std::mutex> lk (io_mutex);
+
+    size_t offset = 0;
+
+    while (offset < data.size()) {
+        const size_t left = data.size() - offset;
+        ssize_t written;
+        short events = POLLOUT;
+
+        if (ssl != nullptr) {
+            written = SSL_write(ssl, data.data() + offset, static_cast<int>(left));
+
+            if (written <= 0) {
+                const int err = SSL_get_error(ssl, static_cast<int>(written));
+
+                if (err != SSL_ERROR_WANT_WRITE && err != SSL_ERROR_WANT_READ) {
+                    THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "Could not write to the socket: SSL_get_error(...) = {}", err);
+                }
+
+                if (err == SSL_ERROR_WANT_READ) {
+                    events = POLLIN;
+                }
+            }
+        }
+        else {
+            written = send(fd, data.data() + offset, left, MSG_NOSIGNAL);
+
+            if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "Could not write to the socket: {}", fd);
+            }
+        }
+
+        if (written > 0) {
+            offset += written;
+            site->get_metrics().bytes_out.add(written);
+            continue;
+        }
+
+        if (!wait_fd(events, config->get_send_timeout() * 1000)) {
+            THROW_MANAPI_EXCEPTION(ERR_HTTP_PROTOCOL_ERROR, "The waiting time of {} seconds has been exceeded", config->get_send_timeout());
+        }
+    }
+}
+
+void manapi::net::http2::connection::write_frame(const uint8_t &type, const uint8_t &flags, const uint32_t &id, const char *payload, const size_t &size) {
+    std::string data;
+    data.reserve(MANAPI_HTTP2_FRAME_HEADER_LEN + size);
+
+    append_frame_header(data, size, type, flags, id);
+
+    if (size > 0) {
+        data.append(payload, size);
+    }
+
+    write_raw(data);
+}
+
+void manapi::net::http2::connection::append_frame_header(std::string &out, const size_t &size, const uint8_t &type, const uint8_t &flags, const uint32_t &id) {
+    out += static_cast<char>(size >> 16);
+    out += static_cast<char>(size >> 8);
+    out += static_cast<char>(size);
+    out += static_cast<char>(type);
+    out += static_cast<char>(flags);
+    append_uint32(out, id);
+}